@@ -0,0 +1,142 @@
+/*
+ * COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+ *
+ * Header only encoder for the LONET 2 binary wire format, for senders that do not link Unreal.
+ * The layout is documented in Source/LONET2LiveLink/Public/LONET2BinaryProtocol.h.
+ *
+ *   uint8_t packet[1500];
+ *   lonet2_writer w;
+ *   lonet2_begin(&w, packet, sizeof(packet));
+ *   size_t s = lonet2_section_begin(&w, LONET2_SECTION_CAMERA, "Camera A", 0, 0, 24.0f, 1, 10, 20, 30, 4);
+ *   ... lonet2_f32(&w, value) for every field of the section ...
+ *   lonet2_section_end(&w, s);
+ *   size_t size = lonet2_finish(&w);   (0 if the buffer was too small)
+ */
+
+#ifndef LONET2_BINARY_H
+#define LONET2_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LONET2_BINARY_MAGIC 0xB2
+#define LONET2_BINARY_VERSION 1
+
+#define LONET2_SECTION_ENCODER 0
+#define LONET2_SECTION_DISTORTION 1
+#define LONET2_SECTION_CAMERA 2
+#define LONET2_SECTION_CONTROLLER 3
+
+#define LONET2_FLAG_NAME_IS_ID 0x01
+#define LONET2_FLAG_HAS_TIMECODE 0x02
+
+typedef struct lonet2_writer
+{
+	uint8_t* data;
+	size_t capacity;
+	size_t size;
+	int overflow;
+} lonet2_writer;
+
+static inline void lonet2_bytes(lonet2_writer* w, const void* bytes, size_t count)
+{
+	if (w->overflow || w->size + count > w->capacity)
+	{
+		w->overflow = 1;
+		return;
+	}
+	memcpy(w->data + w->size, bytes, count);
+	w->size += count;
+}
+
+static inline void lonet2_u8(lonet2_writer* w, uint8_t v)
+{
+	lonet2_bytes(w, &v, 1);
+}
+
+static inline void lonet2_u16(lonet2_writer* w, uint16_t v)
+{
+	uint8_t le[2] = { (uint8_t)(v & 0xFF), (uint8_t)(v >> 8) };
+	lonet2_bytes(w, le, 2);
+}
+
+static inline void lonet2_u32(lonet2_writer* w, uint32_t v)
+{
+	uint8_t le[4] = { (uint8_t)(v & 0xFF), (uint8_t)((v >> 8) & 0xFF), (uint8_t)((v >> 16) & 0xFF), (uint8_t)(v >> 24) };
+	lonet2_bytes(w, le, 4);
+}
+
+static inline void lonet2_f32(lonet2_writer* w, float v)
+{
+	uint32_t bits;
+	memcpy(&bits, &v, 4);
+	lonet2_u32(w, bits);
+}
+
+static inline void lonet2_begin(lonet2_writer* w, uint8_t* buffer, size_t capacity)
+{
+	w->data = buffer;
+	w->capacity = capacity;
+	w->size = 0;
+	w->overflow = 0;
+	lonet2_u8(w, LONET2_BINARY_MAGIC);
+	lonet2_u8(w, LONET2_BINARY_VERSION);
+	lonet2_u8(w, 0);
+	lonet2_u8(w, 0);
+}
+
+/* Pass name for a named subject, or name = NULL and subject_id for a numeric one. Returns the offset lonet2_section_end needs. */
+static inline size_t lonet2_section_begin(lonet2_writer* w, uint8_t section, const char* name, uint32_t subject_id, int has_timecode,
+	float frame_rate, uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames)
+{
+	const size_t start = w->size;
+	uint8_t flags = (name == NULL ? LONET2_FLAG_NAME_IS_ID : 0) | (has_timecode ? LONET2_FLAG_HAS_TIMECODE : 0);
+
+	lonet2_u8(w, section);
+	lonet2_u8(w, flags);
+	lonet2_u16(w, 0);
+
+	if (name == NULL)
+	{
+		lonet2_u32(w, subject_id);
+	}
+	else
+	{
+		size_t length = strlen(name);
+		if (length > 255)
+		{
+			length = 255;
+		}
+		lonet2_u8(w, (uint8_t)length);
+		lonet2_bytes(w, name, length);
+	}
+
+	lonet2_f32(w, frame_rate);
+	lonet2_u8(w, hours);
+	lonet2_u8(w, minutes);
+	lonet2_u8(w, seconds);
+	lonet2_u8(w, frames);
+	return start;
+}
+
+static inline void lonet2_section_end(lonet2_writer* w, size_t start)
+{
+	const size_t body = w->size - start - 4;
+	if (w->overflow || body > 0xFFFF || w->data[2] == 0xFF)
+	{
+		w->overflow = 1;
+		return;
+	}
+	w->data[start + 2] = (uint8_t)(body & 0xFF);
+	w->data[start + 3] = (uint8_t)(body >> 8);
+	w->data[2]++;
+}
+
+/* Returns the datagram size, or 0 if the packet did not fit. */
+static inline size_t lonet2_finish(lonet2_writer* w)
+{
+	return w->overflow ? 0 : w->size;
+}
+
+#endif
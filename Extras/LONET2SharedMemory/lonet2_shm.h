@@ -0,0 +1,253 @@
+/*
+ * COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+ *
+ * Header only writer for the LONET 2 shared memory transport, for senders on the same Linux host that do not link Unreal.
+ * The ring layout is documented in Source/LONET2LiveLink/Private/LONET2SharedMemoryRing.h. Payloads are the usual JSON or
+ * binary datagrams (see Extras/LONET2Binary), a source reads them with the connection string shm://<name>.
+ *
+ *   lonet2_shm shm;
+ *   if (lonet2_shm_open(&shm, "tracker", LONET2_SHM_DEFAULT_CAPACITY) == 0)
+ *   {
+ *       lonet2_shm_write(&shm, packet, size);   (never blocks, 0 on success)
+ *       lonet2_shm_close(&shm);
+ *   }
+ *
+ * Link with -lrt on older glibc. Either side can start first, the ring stays in /dev/shm for a restarted writer to carry on.
+ * The ring is created with mode 0600, the writer and the Unreal process must run as the same user.
+ * Needs _GNU_SOURCE (for O_CLOEXEC, ftruncate and syscall under -std=c99), which this header defines. Include it before any
+ * system header, or define _GNU_SOURCE on the command line.
+ */
+
+#ifndef LONET2_SHM_H
+#define LONET2_SHM_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LONET2_SHM_MAGIC 0x32544E4Cu
+#define LONET2_SHM_VERSION 1u
+#define LONET2_SHM_HEADER_SIZE 256u
+#define LONET2_SHM_WRAP_MARKER 0xFFFFFFFFu
+#define LONET2_SHM_MIN_CAPACITY (64u * 1024u)
+#define LONET2_SHM_DEFAULT_CAPACITY (4u * 1024u * 1024u)
+
+/* Header field offsets */
+#define LONET2_SHM_MAGIC_AT 0
+#define LONET2_SHM_VERSION_AT 4
+#define LONET2_SHM_CAPACITY_AT 8
+#define LONET2_SHM_SEQUENCE_AT 12
+#define LONET2_SHM_RESERVED_AT 64
+#define LONET2_SHM_COMMITTED_AT 128
+#define LONET2_SHM_FUTEX_AT 192
+#define LONET2_SHM_WAITERS_AT 196
+
+typedef struct lonet2_shm
+{
+	uint8_t* header;
+	uint8_t* data;
+	uint32_t capacity;
+	int fd;
+} lonet2_shm;
+
+#define LONET2_SHM_U32(shm, at) ((uint32_t*)((shm)->header + (at)))
+#define LONET2_SHM_U64(shm, at) ((uint64_t*)((shm)->header + (at)))
+
+static inline uint32_t lonet2_shm_round_capacity(uint32_t capacity)
+{
+	uint32_t result = LONET2_SHM_MIN_CAPACITY;
+	while (result < capacity && result < 0x80000000u)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
+/* Opens the ring, creating it if needed. Returns 0, or -1 with errno set (EBUSY when another writer holds the ring). */
+static inline int lonet2_shm_open(lonet2_shm* shm, const char* name, uint32_t capacity)
+{
+	char path[256];
+	struct stat st;
+	int created = 0;
+	int attempt;
+	void* mapping;
+	const struct timespec retry_delay = { 0, 10 * 1000 * 1000 };
+
+	memset(shm, 0, sizeof(*shm));
+	shm->fd = -1;
+	if (snprintf(path, sizeof(path), "/%s", name) >= (int)sizeof(path))
+	{
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	capacity = lonet2_shm_round_capacity(capacity);
+	shm->fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+	if (shm->fd >= 0)
+	{
+		created = 1;
+		if (ftruncate(shm->fd, LONET2_SHM_HEADER_SIZE + capacity) != 0)
+		{
+			close(shm->fd);
+			shm_unlink(path);
+			return -1;
+		}
+	}
+	else if (errno == EEXIST)
+	{
+		shm->fd = shm_open(path, O_RDWR | O_CLOEXEC, 0);
+	}
+	if (shm->fd < 0)
+	{
+		return -1;
+	}
+
+	if (flock(shm->fd, LOCK_EX | LOCK_NB) != 0)
+	{
+		close(shm->fd);
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (!created)
+	{
+		/* The creator may still be sizing the ring and filling in its header, give it a second */
+		for (attempt = 0;; ++attempt)
+		{
+			if (fstat(shm->fd, &st) == 0 && st.st_size >= (off_t)LONET2_SHM_HEADER_SIZE)
+			{
+				mapping = mmap(NULL, LONET2_SHM_HEADER_SIZE, PROT_READ, MAP_SHARED, shm->fd, 0);
+				if (mapping != MAP_FAILED)
+				{
+					const uint8_t* existing = (const uint8_t*)mapping;
+					const uint32_t magic = __atomic_load_n((const uint32_t*)(existing + LONET2_SHM_MAGIC_AT), __ATOMIC_ACQUIRE);
+					const uint32_t version = *(const uint32_t*)(existing + LONET2_SHM_VERSION_AT);
+					capacity = *(const uint32_t*)(existing + LONET2_SHM_CAPACITY_AT);
+					munmap(mapping, LONET2_SHM_HEADER_SIZE);
+
+					if (magic == LONET2_SHM_MAGIC)
+					{
+						if (version != LONET2_SHM_VERSION || capacity == 0 || (capacity & (capacity - 1)) != 0
+							|| st.st_size < (off_t)(LONET2_SHM_HEADER_SIZE + capacity))
+						{
+							close(shm->fd);
+							errno = EPROTO;
+							return -1;
+						}
+						break;
+					}
+				}
+			}
+			if (attempt >= 100)
+			{
+				close(shm->fd);
+				errno = ETIMEDOUT;
+				return -1;
+			}
+			nanosleep(&retry_delay, NULL);
+		}
+	}
+
+	mapping = mmap(NULL, LONET2_SHM_HEADER_SIZE + capacity, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+	if (mapping == MAP_FAILED)
+	{
+		close(shm->fd);
+		return -1;
+	}
+	shm->header = (uint8_t*)mapping;
+	shm->data = shm->header + LONET2_SHM_HEADER_SIZE;
+	shm->capacity = capacity;
+
+	if (created)
+	{
+		*LONET2_SHM_U32(shm, LONET2_SHM_VERSION_AT) = LONET2_SHM_VERSION;
+		*LONET2_SHM_U32(shm, LONET2_SHM_CAPACITY_AT) = capacity;
+		__atomic_store_n(LONET2_SHM_U32(shm, LONET2_SHM_MAGIC_AT), LONET2_SHM_MAGIC, __ATOMIC_RELEASE);
+	}
+
+	/* A writer that died mid-record left Reserved ahead, the record was never committed */
+	__atomic_store_n(LONET2_SHM_U64(shm, LONET2_SHM_RESERVED_AT), __atomic_load_n(LONET2_SHM_U64(shm, LONET2_SHM_COMMITTED_AT), __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+	return 0;
+}
+
+/* Largest payload lonet2_shm_write accepts. */
+static inline uint32_t lonet2_shm_max_payload(const lonet2_shm* shm)
+{
+	return shm->capacity / 4;
+}
+
+/* Appends one datagram and wakes the readers. Returns 0, or -1 if the payload is too large. */
+static inline int lonet2_shm_write(lonet2_shm* shm, const void* payload, uint32_t size)
+{
+	uint64_t offset;
+	uint32_t position, record_size, wrap_size, sequence;
+	uint64_t end;
+
+	if (size > lonet2_shm_max_payload(shm))
+	{
+		return -1;
+	}
+
+	offset = __atomic_load_n(LONET2_SHM_U64(shm, LONET2_SHM_COMMITTED_AT), __ATOMIC_RELAXED);
+	position = (uint32_t)(offset & (shm->capacity - 1));
+	record_size = (8u + size + 7u) & ~7u;
+	wrap_size = shm->capacity - position < record_size ? shm->capacity - position : 0;
+	end = offset + wrap_size + record_size;
+
+	/* Readers copying anything up to end minus capacity see this and drop their copy */
+	__atomic_store_n(LONET2_SHM_U64(shm, LONET2_SHM_RESERVED_AT), end, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	if (wrap_size > 0)
+	{
+		const uint32_t marker = LONET2_SHM_WRAP_MARKER;
+		memcpy(shm->data + position, &marker, 4);
+		position = 0;
+	}
+
+	sequence = (*LONET2_SHM_U32(shm, LONET2_SHM_SEQUENCE_AT))++;
+	memcpy(shm->data + position, &size, 4);
+	memcpy(shm->data + position + 4, &sequence, 4);
+	memcpy(shm->data + position + 8, payload, size);
+
+	__atomic_store_n(LONET2_SHM_U64(shm, LONET2_SHM_COMMITTED_AT), end, __ATOMIC_RELEASE);
+	__atomic_fetch_add(LONET2_SHM_U32(shm, LONET2_SHM_FUTEX_AT), 1u, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(LONET2_SHM_U32(shm, LONET2_SHM_WAITERS_AT), __ATOMIC_SEQ_CST) != 0)
+	{
+		/* Not FUTEX_PRIVATE_FLAG, the word is shared between processes */
+		syscall(SYS_futex, LONET2_SHM_U32(shm, LONET2_SHM_FUTEX_AT), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+	}
+	return 0;
+}
+
+/* Unmaps the ring and releases the writer lock, the ring itself stays for the readers. */
+static inline void lonet2_shm_close(lonet2_shm* shm)
+{
+	if (shm->header != NULL)
+	{
+		munmap(shm->header, LONET2_SHM_HEADER_SIZE + shm->capacity);
+		shm->header = NULL;
+	}
+	if (shm->fd >= 0)
+	{
+		close(shm->fd);
+		shm->fd = -1;
+	}
+}
+
+#endif
@@ -0,0 +1,318 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2BenchmarkCases.h"
+
+#include "LONET2BinaryProtocol.h"
+#include "LONET2Capture.h"
+#include "LONET2StreamDecoder.h"
+#include "LONET2SyntheticTraffic.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformAtomics.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace LONET2Benchmark
+{
+	FCountingMalloc& FCountingMalloc::Get()
+	{
+		// Never destroyed, GMalloc points at it until the process exits
+		static FCountingMalloc* Instance = []()
+		{
+			FCountingMalloc* Wrapper = new FCountingMalloc(GMalloc);
+			FPlatformAtomics::InterlockedExchangePtr(reinterpret_cast<void**>(&GMalloc), Wrapper);
+			return Wrapper;
+		}();
+		return *Instance;
+	}
+
+	FCountingMalloc::FCountingMalloc(FMalloc* InInner)
+		: Inner(InInner)
+	{
+	}
+
+	void FCountingMalloc::Start(uint32 ThreadId)
+	{
+		CountedThreadId = ThreadId;
+		Allocations.Reset();
+		bCounting = true;
+	}
+
+	uint64 FCountingMalloc::Stop()
+	{
+		bCounting = false;
+		return Allocations.GetValue();
+	}
+
+	void* FCountingMalloc::Malloc(SIZE_T Count, uint32 Alignment)
+	{
+		Track();
+		return Inner->Malloc(Count, Alignment);
+	}
+
+	void* FCountingMalloc::TryMalloc(SIZE_T Count, uint32 Alignment)
+	{
+		Track();
+		return Inner->TryMalloc(Count, Alignment);
+	}
+
+	void* FCountingMalloc::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+	{
+		if (Count > 0)
+		{
+			Track();
+		}
+		return Inner->Realloc(Original, Count, Alignment);
+	}
+
+	void FCountingMalloc::Free(void* Original)
+	{
+		Inner->Free(Original);
+	}
+
+	SIZE_T FCountingMalloc::QuantizeSize(SIZE_T Count, uint32 Alignment)
+	{
+		return Inner->QuantizeSize(Count, Alignment);
+	}
+
+	bool FCountingMalloc::GetAllocationSize(void* Original, SIZE_T& SizeOut)
+	{
+		return Inner->GetAllocationSize(Original, SizeOut);
+	}
+
+	void FCountingMalloc::Trim(bool bTrimThreadCaches)
+	{
+		Inner->Trim(bTrimThreadCaches);
+	}
+
+	void FCountingMalloc::SetupTLSCachesOnCurrentThread()
+	{
+		Inner->SetupTLSCachesOnCurrentThread();
+	}
+
+	void FCountingMalloc::ClearAndDisableTLSCachesOnCurrentThread()
+	{
+		Inner->ClearAndDisableTLSCachesOnCurrentThread();
+	}
+
+	void FCountingMalloc::UpdateStats()
+	{
+		Inner->UpdateStats();
+	}
+
+	void FCountingMalloc::GetAllocatorStats(FGenericMemoryStats& OutStats)
+	{
+		Inner->GetAllocatorStats(OutStats);
+	}
+
+	void FCountingMalloc::DumpAllocatorStats(FOutputDevice& Ar)
+	{
+		Inner->DumpAllocatorStats(Ar);
+	}
+
+	bool FCountingMalloc::ValidateHeap()
+	{
+		return Inner->ValidateHeap();
+	}
+
+	bool FCountingMalloc::IsInternallyThreadSafe() const
+	{
+		return Inner->IsInternallyThreadSafe();
+	}
+
+	const TCHAR* FCountingMalloc::GetDescriptiveName()
+	{
+		return TEXT("LONET2BenchmarkCountingMalloc");
+	}
+
+	void FCountingMalloc::Track()
+	{
+		if (bCounting && (CountedThreadId == 0 || CountedThreadId == FPlatformTLS::GetCurrentThreadId()))
+		{
+			Allocations.Increment();
+		}
+	}
+
+	const TPair<ESectionMask, ELONET2Section> MaskSections[4] =
+	{
+		{ Encoder, ELONET2Section::Encoder },
+		{ Distortion, ELONET2Section::Lens },
+		{ Camera, ELONET2Section::Camera },
+		{ Controller, ELONET2Section::Controller },
+	};
+
+	const TCHAR* SubjectFor(ELONET2Section Section)
+	{
+		return Section == ELONET2Section::Controller ? TEXT("Wand") : TEXT("CamA");
+	}
+
+	static FPacketData MakePacket(const TArray<uint8>& Bytes)
+	{
+		FPacketData Packet = MakeShared<FArrayReader, ESPMode::ThreadSafe>();
+		Packet->Append(Bytes);
+		return Packet;
+	}
+
+	FPacketData MakeJsonPacket(uint32 Sections, int32 Frame)
+	{
+		TArray<FString> Parts;
+		for (const TPair<ESectionMask, ELONET2Section>& MaskSection : MaskSections)
+		{
+			if (Sections & MaskSection.Key)
+			{
+				Parts.Add(FString::Printf(TEXT("\"%s\":%s"), LONET2SyntheticTraffic::GetJsonKey(MaskSection.Value),
+					*LONET2SyntheticTraffic::MakeJsonSection(MaskSection.Value, SubjectFor(MaskSection.Value), Frame)));
+			}
+		}
+
+		const FString Json = TEXT("{") + FString::Join(Parts, TEXT(",")) + TEXT("}");
+		const FTCHARToUTF8 Utf8(*Json);
+		return MakePacket(TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length()));
+	}
+
+	FPacketData MakeBinaryPacket(uint32 Sections, int32 Frame)
+	{
+		TArray<uint8> Bytes;
+		FLONET2BinaryWriter Writer(Bytes);
+		Writer.Reset();
+
+		for (const TPair<ESectionMask, ELONET2Section>& MaskSection : MaskSections)
+		{
+			if (Sections & MaskSection.Key)
+			{
+				LONET2SyntheticTraffic::AddBinarySection(Writer, MaskSection.Value, SubjectFor(MaskSection.Value), Frame);
+			}
+		}
+
+		return MakePacket(Bytes);
+	}
+
+	void AddSyntheticCases(TArray<FCase>& Cases)
+	{
+		const TPair<const TCHAR*, uint32> SectionCases[] =
+		{
+			{ TEXT("Encoder"), Encoder },
+			{ TEXT("Distortion"), Distortion },
+			{ TEXT("Camera"), Camera },
+			{ TEXT("Controller"), Controller },
+			{ TEXT("Mixed"), Mixed },
+		};
+
+		for (const TPair<const TCHAR*, uint32>& SectionCase : SectionCases)
+		{
+			for (const bool bBinary : { false, true })
+			{
+				FCase& Case = Cases.AddDefaulted_GetRef();
+				Case.Name = FString::Printf(TEXT("%s.%s"), bBinary ? TEXT("Binary") : TEXT("Json"), SectionCase.Key);
+				Case.Sections = SectionCase.Value;
+				Case.SectionsPerPacket = FMath::CountBits(SectionCase.Value);
+				for (int32 Frame = 0; Frame < PacketsPerCase; ++Frame)
+				{
+					Case.Packets.Add(bBinary ? MakeBinaryPacket(SectionCase.Value, Frame) : MakeJsonPacket(SectionCase.Value, Frame));
+				}
+			}
+		}
+	}
+
+	void AddRecordedCase(const FString& PacketDir, TArray<FCase>& Cases)
+	{
+		TArray<FString> Files;
+		IFileManager::Get().FindFiles(Files, *PacketDir, nullptr);
+		Files.Sort();
+
+		FCase Case;
+		Case.Name = TEXT("Recorded");
+		Case.SectionsPerPacket = 0;
+		for (const FString& File : Files)
+		{
+			TArray<uint8> Bytes;
+			if (FFileHelper::LoadFileToArray(Bytes, *FPaths::Combine(PacketDir, File)) && Bytes.Num() > 0)
+			{
+				Case.Packets.Add(MakePacket(Bytes));
+			}
+		}
+
+		if (Case.Packets.Num() == 0)
+		{
+			UE_LOG(ModuleLog, Warning, TEXT("No recorded packets found in %s"), *PacketDir);
+			return;
+		}
+		Cases.Add(MoveTemp(Case));
+	}
+
+	void AddCaptureCase(const FString& CaptureFile, TArray<FCase>& Cases)
+	{
+		TUniquePtr<FLONET2CaptureReader> Reader = FLONET2CaptureReader::Open(CaptureFile);
+		if (!Reader.IsValid())
+		{
+			return;
+		}
+
+		FCase Case;
+		Case.Name = TEXT("Capture");
+		Case.SectionsPerPacket = 0;
+
+		int64 Offset = Reader->GetFirstRecordOffset();
+		FLONET2CaptureReader::FRecord Record;
+		while (Reader->Next(Offset, Record))
+		{
+			Case.Packets.Add(MakePacket(TArray<uint8>(Record.Data, Record.Num)));
+		}
+
+		if (Case.Packets.Num() == 0)
+		{
+			UE_LOG(ModuleLog, Warning, TEXT("No datagrams found in capture %s"), *CaptureFile);
+			return;
+		}
+		Cases.Add(MoveTemp(Case));
+	}
+
+	static double CyclesToMicroseconds(uint64 Cycles)
+	{
+		return Cycles * FPlatformTime::GetSecondsPerCycle64() * 1000000.0;
+	}
+
+	FCaseResult RunDirect(const FCase& Case, const FLONET2LiveLinkSourceOptions& Options, const FIPv4Endpoint& Endpoint, int32 NumPackets, int32 NumWarmup)
+	{
+		FCaseResult Result;
+		Result.Name = Case.Name;
+		Result.Packets = NumPackets;
+
+		// Decoding on the calling thread makes every HandleReceivedData call one complete decode and push
+		FLONET2LiveLinkSourceOptions DirectOptions = Options;
+		DirectOptions.DecodeThread = ELONET2DecodeThread::ReceiverThread;
+
+		TSharedRef<FCountingSource> Source = MakeShared<FCountingSource>(Endpoint, DirectOptions);
+		Source->ReceiveClient(nullptr, FGuid::NewGuid());
+
+		for (int32 Index = 0; Index < NumWarmup; ++Index)
+		{
+			Source->HandleReceivedData(Case.Packets[Index % Case.Packets.Num()], Endpoint);
+		}
+
+		TArray<uint64> Latencies;
+		Latencies.SetNumUninitialized(NumPackets);
+
+		FCountingMalloc& CountingMalloc = FCountingMalloc::Get();
+		CountingMalloc.Start(FPlatformTLS::GetCurrentThreadId());
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Index = 0; Index < NumPackets; ++Index)
+		{
+			const uint64 PacketStart = FPlatformTime::Cycles64();
+			Source->HandleReceivedData(Case.Packets[(NumWarmup + Index) % Case.Packets.Num()], Endpoint);
+			Latencies[Index] = FPlatformTime::Cycles64() - PacketStart;
+		}
+		const uint64 TotalCycles = FPlatformTime::Cycles64() - StartCycles;
+		const uint64 Allocations = CountingMalloc.Stop();
+
+		Latencies.Sort();
+		Result.PacketsPerSecond = NumPackets / FMath::Max(TotalCycles * FPlatformTime::GetSecondsPerCycle64(), SMALL_NUMBER);
+		Result.P50Microseconds = CyclesToMicroseconds(Latencies[NumPackets / 2]);
+		Result.P99Microseconds = CyclesToMicroseconds(Latencies[FMath::Min(NumPackets - 1, NumPackets * 99 / 100)]);
+		Result.AllocationsPerPacket = double(Allocations) / NumPackets;
+
+		Source->RequestSourceShutdown();
+		return Result;
+	}
+}
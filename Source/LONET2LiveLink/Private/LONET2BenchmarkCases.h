@@ -0,0 +1,182 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "LONET2LiveLinkSource.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/ArrayReader.h"
+
+enum class ELONET2Section : uint8;
+
+/**
+ * Benchmark cases of the LONET 2 pipeline, shared by the benchmark commandlet and the automation tests.
+ */
+namespace LONET2Benchmark
+{
+	typedef TSharedPtr<FArrayReader, ESPMode::ThreadSafe> FPacketData;
+
+	/** Distinct packets generated per case, replayed in a loop. Timecodes advance one frame per packet like a live feed. */
+	static constexpr int32 PacketsPerCase = 1024;
+
+	/** Source whose LiveLink pushes are counted instead of sent to a client, optionally keeping the last frame of every subject. */
+	class FCountingSource : public FLONET2LiveLinkSource
+	{
+	public:
+
+		FCountingSource(FIPv4Endpoint Endpoint, const FLONET2LiveLinkSourceOptions& Options, bool bInKeepFrames = false)
+			: FLONET2LiveLinkSource(Endpoint, Options)
+			, bKeepFrames(bInKeepFrames)
+		{
+		}
+
+		/** Copies the last frame pushed for the subject, false if none was. */
+		bool GetLastFrame(FName SubjectName, FLiveLinkFrameDataStruct& OutFrameData) const
+		{
+			FScopeLock Lock(&FramesLock);
+			const FLiveLinkFrameDataStruct* FrameData = LastFrames.Find(SubjectName);
+			if (FrameData == nullptr)
+			{
+				return false;
+			}
+			OutFrameData.InitializeWith(*FrameData);
+			return true;
+		}
+
+		FThreadSafeCounter64 FramesPushed;
+		FThreadSafeCounter64 StaticDataPushed;
+
+	protected:
+
+		virtual bool HasClient() const override { return true; }
+
+		virtual void PushSubjectStaticData(const FLiveLinkSubjectKey& SubjectKey, TSubclassOf<ULiveLinkRole> Role, FLiveLinkStaticDataStruct&& StaticData) override
+		{
+			StaticDataPushed.Increment();
+		}
+
+		virtual void PushSubjectFrameData(const FLiveLinkSubjectKey& SubjectKey, FLiveLinkFrameDataStruct&& FrameData) override
+		{
+			FramesPushed.Increment();
+			if (bKeepFrames)
+			{
+				FScopeLock Lock(&FramesLock);
+				LastFrames.FindOrAdd(SubjectKey.SubjectName.Name) = MoveTemp(FrameData);
+			}
+		}
+
+		virtual void RemoveSubject(const FLiveLinkSubjectKey& SubjectKey) override
+		{
+		}
+
+		virtual bool IsSubjectEnabled(const FLiveLinkSubjectKey& SubjectKey) const override { return true; }
+
+	private:
+
+		const bool bKeepFrames;
+
+		mutable FCriticalSection FramesLock;
+
+		TMap<FName, FLiveLinkFrameDataStruct> LastFrames;
+	};
+
+	/**
+	 * Forwards to the engine allocator, counting allocations made while enabled.
+	 * Get() wraps GMalloc once and the wrapper stays installed for the rest of the process, so a thread that picked it up
+	 * can never call into one that is gone. While not counting it costs one branch per allocation.
+	 */
+	class FCountingMalloc : public FMalloc
+	{
+	public:
+
+		static FCountingMalloc& Get();
+
+		/** Counts allocations from one thread only, or from every thread when ThreadId is 0. */
+		void Start(uint32 ThreadId);
+
+		uint64 Stop();
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override;
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override;
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override;
+		virtual void Free(void* Original) override;
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override;
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override;
+		virtual void Trim(bool bTrimThreadCaches) override;
+		virtual void SetupTLSCachesOnCurrentThread() override;
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override;
+		virtual void UpdateStats() override;
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override;
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override;
+		virtual bool ValidateHeap() override;
+		virtual bool IsInternallyThreadSafe() const override;
+		virtual const TCHAR* GetDescriptiveName() override;
+
+	private:
+
+		explicit FCountingMalloc(FMalloc* InInner);
+
+		void Track();
+
+		FMalloc* Inner;
+		FThreadSafeCounter64 Allocations;
+		volatile bool bCounting = false;
+		uint32 CountedThreadId = 0;
+	};
+
+	struct FCase
+	{
+		FString Name;
+		/** Sections of every packet, 0 when unknown. */
+		uint32 Sections = 0;
+		int32 SectionsPerPacket = 1;
+		TArray<FPacketData> Packets;
+	};
+
+	struct FCaseResult
+	{
+		FString Name;
+		int32 Packets = 0;
+		double PacketsPerSecond = 0.0;
+		double P50Microseconds = 0.0;
+		double P99Microseconds = 0.0;
+		double AllocationsPerPacket = 0.0;
+		uint64 Lost = 0;
+		bool bPassed = true;
+	};
+
+	enum ESectionMask : uint32
+	{
+		Encoder = 1 << 0,
+		Distortion = 1 << 1,
+		Camera = 1 << 2,
+		Controller = 1 << 3,
+		Mixed = Encoder | Distortion | Camera | Controller,
+	};
+
+	/** Sections of the mask in packet order. */
+	extern const TPair<ESectionMask, ELONET2Section> MaskSections[4];
+
+	/** Raw subject name of the synthetic sections, the controller is its own subject. */
+	const TCHAR* SubjectFor(ELONET2Section Section);
+
+	FPacketData MakeJsonPacket(uint32 Sections, int32 Frame);
+	FPacketData MakeBinaryPacket(uint32 Sections, int32 Frame);
+
+	/** JSON and binary cases of every section alone and of all of them in one packet, PacketsPerCase packets each. */
+	void AddSyntheticCases(TArray<FCase>& Cases);
+
+	/** One datagram per file, as written by a capture tool. Sections per packet are unknown, so loss is not reported for this case. */
+	void AddRecordedCase(const FString& PacketDir, TArray<FCase>& Cases);
+
+	/** Every datagram of a capture file, in recorded order. */
+	void AddCaptureCase(const FString& CaptureFile, TArray<FCase>& Cases);
+
+	/**
+	 * Decodes NumPackets of the case through HandleReceivedData on the calling thread, after NumWarmup unmeasured ones.
+	 * Allocations are counted on the calling thread only, other threads allocating meanwhile do not skew them.
+	 */
+	FCaseResult RunDirect(const FCase& Case, const FLONET2LiveLinkSourceOptions& Options, const FIPv4Endpoint& Endpoint, int32 NumPackets, int32 NumWarmup);
+}
@@ -0,0 +1,203 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2BenchmarkCommandlet.h"
+
+#include "LONET2BenchmarkCases.h"
+#include "LONET2LiveLinkSource.h"
+#include "Common/UdpSocketBuilder.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace LONET2Benchmark
+{
+	static FCaseResult RunLoopback(const FCase& Case, const FLONET2LiveLinkSourceOptions& Options, const FIPv4Endpoint& Endpoint, int32 NumPackets, int32 NumWarmup)
+	{
+		FCaseResult Result;
+		Result.Name = Case.Name;
+		Result.Packets = NumPackets;
+
+		TSharedRef<FCountingSource> Source = MakeShared<FCountingSource>(Endpoint, Options);
+		Source->ReceiveClient(nullptr, FGuid::NewGuid());
+
+		ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+		FSocket* Sender = FUdpSocketBuilder(TEXT("LONET2BenchmarkSender")).WithSendBufferSize(4 * 1024 * 1024);
+		if (Sender == nullptr)
+		{
+			UE_LOG(ModuleLog, Error, TEXT("Failed to create the loopback sender socket"));
+			Result.bPassed = false;
+			Source->RequestSourceShutdown();
+			return Result;
+		}
+		TSharedRef<FInternetAddr> Destination = Endpoint.ToInternetAddr();
+
+		auto Send = [&](int32 Index)
+		{
+			const FPacketData& Packet = Case.Packets[Index % Case.Packets.Num()];
+			int32 BytesSent = 0;
+			Sender->SendTo(Packet->GetData(), Packet->Num(), BytesSent, *Destination);
+		};
+
+		auto ProcessedPackets = [&]()
+		{
+			const uint64 Frames = Source->FramesPushed.GetValue() + Source->GetSupersededFrameCount();
+			return Case.SectionsPerPacket > 0 ? Frames / Case.SectionsPerPacket : Frames;
+		};
+
+		auto WaitForIdle = [&](uint64 Expected)
+		{
+			// Stop once the pipeline has caught up, or has stopped making progress because datagrams were lost
+			uint64 LastProcessed = MAX_uint64;
+			while (ProcessedPackets() < Expected && ProcessedPackets() != LastProcessed)
+			{
+				LastProcessed = ProcessedPackets();
+				FPlatformProcess::Sleep(0.05f);
+				if (Options.DecodeThread == ELONET2DecodeThread::GameThread)
+				{
+					Source->Update();
+				}
+			}
+		};
+
+		for (int32 Index = 0; Index < NumWarmup; ++Index)
+		{
+			Send(Index);
+		}
+		WaitForIdle(NumWarmup);
+		const uint64 ProcessedBefore = ProcessedPackets();
+
+		// Loopback decoding happens on the plugin threads, so allocations are counted process wide, engine threads included
+		FCountingMalloc& CountingMalloc = FCountingMalloc::Get();
+		CountingMalloc.Start(0);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Index = 0; Index < NumPackets; ++Index)
+		{
+			Send(NumWarmup + Index);
+			if (Options.DecodeThread == ELONET2DecodeThread::GameThread && (Index % Options.ReceiveBatchSize) == 0)
+			{
+				Source->Update();
+			}
+		}
+		WaitForIdle(ProcessedBefore + NumPackets);
+		const uint64 TotalCycles = FPlatformTime::Cycles64() - StartCycles;
+		const uint64 Allocations = CountingMalloc.Stop();
+
+		const uint64 Processed = ProcessedPackets() - ProcessedBefore;
+		Result.PacketsPerSecond = Processed / FMath::Max(TotalCycles * FPlatformTime::GetSecondsPerCycle64(), SMALL_NUMBER);
+		Result.AllocationsPerPacket = Processed > 0 ? double(Allocations) / Processed : 0.0;
+		Result.Lost = Case.SectionsPerPacket > 0 && Processed < uint64(NumPackets) ? NumPackets - Processed : 0;
+
+		Source->RequestSourceShutdown();
+		Sender->Close();
+		SocketSubsystem->DestroySocket(Sender);
+		return Result;
+	}
+}
+
+ULONET2BenchmarkCommandlet::ULONET2BenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 ULONET2BenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace LONET2Benchmark;
+
+	const TCHAR* CmdLine = *Params;
+
+	int32 NumPackets = 100000;
+	int32 NumWarmup = 2000;
+	int32 Port = 60609;
+	FParse::Value(CmdLine, TEXT("Packets="), NumPackets);
+	FParse::Value(CmdLine, TEXT("Warmup="), NumWarmup);
+	FParse::Value(CmdLine, TEXT("Port="), Port);
+	NumPackets = FMath::Max(NumPackets, 1);
+	NumWarmup = FMath::Max(NumWarmup, 0);
+
+	FString Mode = TEXT("Direct");
+	FParse::Value(CmdLine, TEXT("Mode="), Mode);
+	const bool bLoopback = Mode.Equals(TEXT("Loopback"), ESearchCase::IgnoreCase);
+
+	FLONET2LiveLinkSourceOptions Options;
+	FString DecodeThread;
+	if (FParse::Value(CmdLine, TEXT("DecodeThread="), DecodeThread))
+	{
+		Options.DecodeThread = DecodeThread.Equals(TEXT("Game"), ESearchCase::IgnoreCase) ? ELONET2DecodeThread::GameThread
+			: DecodeThread.Equals(TEXT("Decode"), ESearchCase::IgnoreCase) ? ELONET2DecodeThread::DecodeThread
+			: ELONET2DecodeThread::ReceiverThread;
+	}
+
+	float MinRate = MinPacketsPerSecond;
+	float MaxP99 = MaxP99Microseconds;
+	float MaxAllocations = MaxAllocationsPerPacket;
+	FParse::Value(CmdLine, TEXT("MinPacketsPerSecond="), MinRate);
+	FParse::Value(CmdLine, TEXT("MaxP99Microseconds="), MaxP99);
+	FParse::Value(CmdLine, TEXT("MaxAllocationsPerPacket="), MaxAllocations);
+
+	TArray<FCase> Cases;
+	AddSyntheticCases(Cases);
+
+	FString PacketDir;
+	if (FParse::Value(CmdLine, TEXT("PacketDir="), PacketDir))
+	{
+		AddRecordedCase(PacketDir, Cases);
+	}
+
+	FString CaptureFile;
+	if (FParse::Value(CmdLine, TEXT("Capture="), CaptureFile))
+	{
+		AddCaptureCase(CaptureFile, Cases);
+	}
+
+	const FIPv4Endpoint Endpoint(FIPv4Address(127, 0, 0, 1), Port);
+
+	TArray<FCaseResult> Results;
+	for (const FCase& Case : Cases)
+	{
+		FCaseResult Result = bLoopback
+			? RunLoopback(Case, Options, Endpoint, NumPackets, NumWarmup)
+			: RunDirect(Case, Options, Endpoint, NumPackets, NumWarmup);
+
+		if ((MinRate > 0.0f && Result.PacketsPerSecond < MinRate)
+			|| (MaxP99 > 0.0f && !bLoopback && Result.P99Microseconds > MaxP99)
+			|| (MaxAllocations > 0.0f && Result.AllocationsPerPacket > MaxAllocations))
+		{
+			Result.bPassed = false;
+		}
+		Results.Add(MoveTemp(Result));
+	}
+
+	int32 NumFailed = 0;
+	FString Csv = TEXT("Case,Packets,PacketsPerSecond,P50Microseconds,P99Microseconds,AllocationsPerPacket,Lost,Passed\n");
+
+	UE_LOG(ModuleLog, Display, TEXT("LONET 2 benchmark, %s mode, %d packets per case"), bLoopback ? TEXT("loopback") : TEXT("direct"), NumPackets);
+	UE_LOG(ModuleLog, Display, TEXT("%-20s %14s %10s %10s %12s %8s"), TEXT("Case"), TEXT("Packets/s"), TEXT("p50 us"), TEXT("p99 us"), TEXT("Allocs/pkt"), TEXT("Lost"));
+	for (const FCaseResult& Result : Results)
+	{
+		UE_LOG(ModuleLog, Display, TEXT("%-20s %14.0f %10.2f %10.2f %12.2f %8llu%s"), *Result.Name, Result.PacketsPerSecond,
+			Result.P50Microseconds, Result.P99Microseconds, Result.AllocationsPerPacket, Result.Lost, Result.bPassed ? TEXT("") : TEXT("  FAILED"));
+
+		Csv += FString::Printf(TEXT("%s,%d,%.0f,%.3f,%.3f,%.3f,%llu,%d\n"), *Result.Name, Result.Packets, Result.PacketsPerSecond,
+			Result.P50Microseconds, Result.P99Microseconds, Result.AllocationsPerPacket, Result.Lost, Result.bPassed ? 1 : 0);
+
+		NumFailed += Result.bPassed ? 0 : 1;
+	}
+
+	FString CsvPath;
+	if (FParse::Value(CmdLine, TEXT("Csv="), CsvPath))
+	{
+		FFileHelper::SaveStringToFile(Csv, *CsvPath);
+	}
+
+	if (NumFailed > 0)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("%d benchmark case(s) missed their thresholds"), NumFailed);
+		return 1;
+	}
+	return 0;
+}
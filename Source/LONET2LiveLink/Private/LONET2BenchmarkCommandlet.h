@@ -0,0 +1,42 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "LONET2BenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of the LONET 2 receive and decode pipeline.
+ * Feeds synthetic (and optionally recorded or captured) datagrams through a source whose LiveLink pushes are counted instead of sent to a client,
+ * and reports packets per second, p50/p99 decode latency and allocations per packet for every case.
+ *
+ * UnrealEditor-Cmd <Project> -run=LONET2Benchmark [-Mode=Direct|Loopback] [-Packets=N] [-Warmup=N] [-Port=N]
+ *     [-DecodeThread=Game|Receiver|Decode] [-PacketDir=<dir>] [-Capture=<file>] [-Csv=<file>]
+ *     [-MinPacketsPerSecond=N] [-MaxP99Microseconds=N] [-MaxAllocationsPerPacket=N]
+ *
+ * Direct mode calls HandleReceivedData on the commandlet thread and counts the allocations of that thread only. Loopback mode sends
+ * every packet over UDP to 127.0.0.1 and counts allocations process wide, so whatever engine threads allocate meanwhile is included.
+ * The cases also run as the LONET2LiveLink.Pipeline automation tests, which check the pushed values and these thresholds.
+ * Returns a non zero exit code when any case misses a threshold, so CI can fail the run.
+ */
+UCLASS(config = Engine)
+class ULONET2BenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	ULONET2BenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/** Thresholds used when the command line does not override them, 0 disables a check. */
+	UPROPERTY(config)
+	float MinPacketsPerSecond = 0.0f;
+
+	UPROPERTY(config)
+	float MaxP99Microseconds = 0.0f;
+
+	UPROPERTY(config)
+	float MaxAllocationsPerPacket = 0.0f;
+};
@@ -0,0 +1,381 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2BinaryProtocol.h"
+
+#include "LONET2StreamDecoder.h"
+#include "Roles/LiveLinkCameraTypes.h"
+#include "LiveLinkLensTypes.h"
+
+static_assert(PLATFORM_LITTLE_ENDIAN, "The LONET 2 binary format is read and written with native little endian copies");
+
+namespace LONET2BinaryProtocol
+{
+	static constexpr int32 PacketHeaderSize = 4;
+	static constexpr int32 SectionHeaderSize = 4;
+
+	struct FReader
+	{
+		const uint8* Pos;
+		const uint8* End;
+		bool bOverflow = false;
+
+		template <typename T>
+		T Read()
+		{
+			T Value = T();
+			if (End - Pos < static_cast<int64>(sizeof(T)))
+			{
+				bOverflow = true;
+				Pos = End;
+				return Value;
+			}
+			FMemory::Memcpy(&Value, Pos, sizeof(T));
+			Pos += sizeof(T);
+			return Value;
+		}
+
+		void ReadFloats(float* OutValues, int32 Count)
+		{
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				OutValues[Index] = Read<float>();
+			}
+		}
+	};
+}
+
+FLONET2BinaryWriter::FLONET2BinaryWriter(TArray<uint8>& InBuffer)
+	: Buffer(InBuffer)
+{
+	Reset();
+}
+
+void FLONET2BinaryWriter::Reset()
+{
+	Buffer.Reset();
+	WriteUInt8(LONET2_BINARY_MAGIC);
+	WriteUInt8(LONET2_BINARY_VERSION);
+	WriteUInt8(0);
+	WriteUInt8(0);
+}
+
+int32 FLONET2BinaryWriter::GetSectionCount() const
+{
+	return Buffer.Num() >= LONET2BinaryProtocol::PacketHeaderSize ? Buffer[2] : 0;
+}
+
+void FLONET2BinaryWriter::WriteUInt8(uint8 Value)
+{
+	Buffer.Add(Value);
+}
+
+void FLONET2BinaryWriter::WriteUInt16(uint16 Value)
+{
+	Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+}
+
+void FLONET2BinaryWriter::WriteUInt32(uint32 Value)
+{
+	Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+}
+
+void FLONET2BinaryWriter::WriteFloat(float Value)
+{
+	Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+}
+
+int32 FLONET2BinaryWriter::BeginSection(ELONET2BinarySection Section, const FLONET2BinarySectionHeader& Header)
+{
+	check(GetSectionCount() < MAX_uint8);
+
+	ELONET2BinarySectionFlags Flags = ELONET2BinarySectionFlags::None;
+	if (Header.bUseSubjectId)
+	{
+		Flags |= ELONET2BinarySectionFlags::NameIsId;
+	}
+	if (Header.bHasTimecode)
+	{
+		Flags |= ELONET2BinarySectionFlags::HasTimecode;
+	}
+
+	const int32 SectionStart = Buffer.Num();
+	WriteUInt8(static_cast<uint8>(Section));
+	WriteUInt8(static_cast<uint8>(Flags));
+	WriteUInt16(0);
+
+	if (Header.bUseSubjectId)
+	{
+		WriteUInt32(Header.SubjectId);
+	}
+	else
+	{
+		FTCHARToUTF8 Name(*Header.SubjectName);
+		const int32 NameLength = FMath::Min(Name.Length(), static_cast<int32>(MAX_uint8));
+		WriteUInt8(static_cast<uint8>(NameLength));
+		Buffer.Append(reinterpret_cast<const uint8*>(Name.Get()), NameLength);
+	}
+
+	WriteFloat(Header.FrameRate);
+	WriteUInt8(static_cast<uint8>(Header.Timecode.Hours));
+	WriteUInt8(static_cast<uint8>(Header.Timecode.Minutes));
+	WriteUInt8(static_cast<uint8>(Header.Timecode.Seconds));
+	WriteUInt8(static_cast<uint8>(Header.Timecode.Frames));
+
+	return SectionStart;
+}
+
+void FLONET2BinaryWriter::EndSection(int32 SectionStart)
+{
+	const int32 BodySize = Buffer.Num() - SectionStart - LONET2BinaryProtocol::SectionHeaderSize;
+	check(BodySize <= MAX_uint16);
+
+	const uint16 BodySize16 = static_cast<uint16>(BodySize);
+	FMemory::Memcpy(&Buffer[SectionStart + 2], &BodySize16, sizeof(BodySize16));
+	++Buffer[2];
+}
+
+void FLONET2BinaryWriter::AddEncoder(const FLONET2BinarySectionHeader& Header, const FLONET2BinaryEncoderData& Data)
+{
+	const int32 SectionStart = BeginSection(ELONET2BinarySection::Encoder, Header);
+	WriteFloat(Data.FocalLength);
+	WriteFloat(Data.Iris);
+	WriteFloat(Data.Focus);
+	EndSection(SectionStart);
+}
+
+void FLONET2BinaryWriter::AddDistortion(const FLONET2BinarySectionHeader& Header, const FLONET2BinaryDistortionData& Data)
+{
+	const int32 SectionStart = BeginSection(ELONET2BinarySection::Distortion, Header);
+	WriteFloat(Data.FocalLength);
+	WriteFloat(Data.Iris);
+	WriteFloat(Data.Focus);
+	WriteFloat(Data.FxFy[0]);
+	WriteFloat(Data.FxFy[1]);
+	WriteFloat(Data.PrincipalPoint[0]);
+	WriteFloat(Data.PrincipalPoint[1]);
+
+	const int32 NumParameters = FMath::Min(Data.DistortionParameters.Num(), static_cast<int32>(MAX_uint8));
+	WriteUInt8(static_cast<uint8>(NumParameters));
+	for (int32 Index = 0; Index < NumParameters; ++Index)
+	{
+		WriteFloat(Data.DistortionParameters[Index]);
+	}
+	EndSection(SectionStart);
+}
+
+void FLONET2BinaryWriter::AddCamera(const FLONET2BinarySectionHeader& Header, const FLONET2BinaryCameraData& Data)
+{
+	const int32 SectionStart = BeginSection(ELONET2BinarySection::Camera, Header);
+	for (float Value : Data.Position)
+	{
+		WriteFloat(Value);
+	}
+	for (float Value : Data.Orientation)
+	{
+		WriteFloat(Value);
+	}
+	WriteFloat(Data.FocalLength);
+	WriteFloat(Data.Iris);
+	WriteFloat(Data.Focus);
+	WriteFloat(Data.WhiteBalance);
+	WriteFloat(Data.Tint);
+	WriteFloat(Data.ISO);
+	WriteFloat(Data.Shutter);
+	WriteFloat(Data.SensorSize[0]);
+	WriteFloat(Data.SensorSize[1]);
+	EndSection(SectionStart);
+}
+
+void FLONET2BinaryWriter::AddController(const FLONET2BinarySectionHeader& Header, const FLONET2BinaryControllerData& Data)
+{
+	const int32 SectionStart = BeginSection(ELONET2BinarySection::Controller, Header);
+	WriteFloat(Data.Button1);
+	WriteFloat(Data.Button2);
+	WriteFloat(Data.Button3);
+	WriteFloat(Data.Trigger);
+	WriteFloat(Data.TouchpadPressed);
+	WriteFloat(Data.TouchpadX);
+	WriteFloat(Data.TouchpadY);
+	EndSection(SectionStart);
+}
+
+bool FLONET2StreamDecoder::IsBinaryPacket(const uint8* Data, int32 Num)
+{
+	return Num >= LONET2BinaryProtocol::PacketHeaderSize && Data[0] == LONET2_BINARY_MAGIC;
+}
+
+FLONET2StreamDecoder::EResult FLONET2StreamDecoder::DecodeBinary(const uint8* Data, int32 Num)
+{
+	using namespace LONET2BinaryProtocol;
+
+	Sections.Reset();
+
+	if (!IsBinaryPacket(Data, Num) || Data[1] != LONET2_BINARY_VERSION)
+	{
+		return EResult::Malformed;
+	}
+
+	const FIsSubjectEnabled* SubjectFilter = GetSubjectFilter();
+
+	const int32 SectionCount = Data[2];
+	FReader Packet{ Data + PacketHeaderSize, Data + Num };
+
+	for (int32 SectionIndex = 0; SectionIndex < SectionCount; ++SectionIndex)
+	{
+		const ELONET2BinarySection Type = static_cast<ELONET2BinarySection>(Packet.Read<uint8>());
+		const ELONET2BinarySectionFlags Flags = static_cast<ELONET2BinarySectionFlags>(Packet.Read<uint8>());
+		const uint16 BodySize = Packet.Read<uint16>();
+		if (Packet.bOverflow || Packet.End - Packet.Pos < BodySize)
+		{
+			return EResult::Malformed;
+		}
+
+		FReader Body{ Packet.Pos, Packet.Pos + BodySize };
+		Packet.Pos += BodySize;
+
+		ELONET2Section Section;
+		switch (Type)
+		{
+		case ELONET2BinarySection::Encoder:
+			Section = ELONET2Section::Encoder;
+			break;
+		case ELONET2BinarySection::Distortion:
+			Section = ELONET2Section::Lens;
+			break;
+		case ELONET2BinarySection::Camera:
+			Section = ELONET2Section::Camera;
+			break;
+		case ELONET2BinarySection::Controller:
+			Section = ELONET2Section::Controller;
+			break;
+		default:
+			// Section types from a newer sender
+			continue;
+		}
+
+		FLONET2DecodedSection& Out = Sections.AddDefaulted_GetRef();
+		Out.Section = Section;
+
+		if (EnumHasAnyFlags(Flags, ELONET2BinarySectionFlags::NameIsId))
+		{
+			// Formatted into the section's own buffer once the array stops growing
+			Out.SubjectId = Body.Read<uint32>();
+			Out.bSubjectIsId = true;
+		}
+		else
+		{
+			const uint8 NameLength = Body.Read<uint8>();
+			if (Body.End - Body.Pos < NameLength)
+			{
+				return EResult::Malformed;
+			}
+			Out.SubjectName = FAnsiStringView(reinterpret_cast<const ANSICHAR*>(Body.Pos), NameLength);
+			Body.Pos += NameLength;
+		}
+
+		// The packet reader is already past the body, a disabled subject's body is never read
+		if (SubjectFilter != nullptr)
+		{
+			ANSICHAR IdBuffer[UE_ARRAY_COUNT(Out.SubjectIdBuffer)];
+			FAnsiStringView SubjectName = Out.SubjectName;
+			if (Out.bSubjectIsId)
+			{
+				SubjectName = FAnsiStringView(IdBuffer, FCStringAnsi::Snprintf(IdBuffer, UE_ARRAY_COUNT(IdBuffer), "%u", Out.SubjectId));
+			}
+			if (Body.bOverflow)
+			{
+				return EResult::Malformed;
+			}
+			if (!SubjectFilter->Execute(Section, SubjectName))
+			{
+				Sections.Pop(false);
+				continue;
+			}
+		}
+
+		Out.FrameRate = Body.Read<float>();
+		Out.ParsedTimecode.Hours = Body.Read<uint8>();
+		Out.ParsedTimecode.Minutes = Body.Read<uint8>();
+		Out.ParsedTimecode.Seconds = Body.Read<uint8>();
+		Out.ParsedTimecode.Frames = Body.Read<uint8>();
+		Out.bHasTimecode = EnumHasAnyFlags(Flags, ELONET2BinarySectionFlags::HasTimecode);
+		Out.bTimecodeParsed = true;
+
+		switch (Section)
+		{
+		case ELONET2Section::Encoder:
+		{
+			Out.FrameData = FLiveLinkFrameDataStruct(FLiveLinkCameraFrameData::StaticStruct());
+			FLiveLinkCameraFrameData& Frame = *Out.FrameData.Cast<FLiveLinkCameraFrameData>();
+			Frame.FocalLength = Body.Read<float>();
+			Frame.Aperture = Body.Read<float>();
+			Frame.FocusDistance = Body.Read<float>();
+			break;
+		}
+		case ELONET2Section::Lens:
+		{
+			Out.FrameData = FLiveLinkFrameDataStruct(FLiveLinkLensFrameData::StaticStruct());
+			FLiveLinkLensFrameData& Frame = *Out.FrameData.Cast<FLiveLinkLensFrameData>();
+			Frame.FocalLength = Body.Read<float>();
+			Frame.Aperture = Body.Read<float>();
+			Frame.FocusDistance = Body.Read<float>();
+			Frame.FxFy[0] = Body.Read<float>();
+			Frame.FxFy[1] = Body.Read<float>();
+			Frame.PrincipalPoint[0] = Body.Read<float>();
+			Frame.PrincipalPoint[1] = Body.Read<float>();
+			Frame.ProjectionMode = ELiveLinkCameraProjectionMode::Perspective;
+
+			const uint8 NumParameters = Body.Read<uint8>();
+			Frame.DistortionParameters.SetNumUninitialized(NumParameters);
+			Body.ReadFloats(Frame.DistortionParameters.GetData(), NumParameters);
+			break;
+		}
+		case ELONET2Section::Camera:
+		{
+			Out.FrameData = FLiveLinkFrameDataStruct(FLiveLinkCameraFrameData::StaticStruct());
+			FLiveLinkCameraFrameData& Frame = *Out.FrameData.Cast<FLiveLinkCameraFrameData>();
+
+			float Position[3];
+			float Orientation[4];
+			Body.ReadFloats(Position, 3);
+			Body.ReadFloats(Orientation, 4);
+			Frame.Transform.SetLocation(FVector(Position[0], Position[1], Position[2]));
+			Frame.Transform.SetRotation(FQuat(Orientation[0], Orientation[1], Orientation[2], Orientation[3]));
+			Frame.FocalLength = Body.Read<float>();
+			Frame.Aperture = Body.Read<float>();
+			Frame.FocusDistance = Body.Read<float>();
+
+			// whiteBalance, tint, ISO, shutter, sensorX, sensorY
+			Frame.PropertyValues.SetNumUninitialized(6);
+			Body.ReadFloats(Frame.PropertyValues.GetData(), 6);
+			break;
+		}
+		case ELONET2Section::Controller:
+		{
+			Out.FrameData = FLiveLinkFrameDataStruct(FLiveLinkBaseFrameData::StaticStruct());
+			FLiveLinkBaseFrameData& Frame = *Out.FrameData.GetBaseData();
+
+			// button1, button2, button3, trigger, touchpadPressed, touchpadX, touchpadY
+			Frame.PropertyValues.SetNumUninitialized(7);
+			Body.ReadFloats(Frame.PropertyValues.GetData(), 7);
+			break;
+		}
+		}
+
+		if (Body.bOverflow)
+		{
+			return EResult::Malformed;
+		}
+	}
+
+	for (FLONET2DecodedSection& Section : Sections)
+	{
+		if (Section.bSubjectIsId)
+		{
+			const int32 NameLength = FCStringAnsi::Snprintf(Section.SubjectIdBuffer, UE_ARRAY_COUNT(Section.SubjectIdBuffer), "%u", Section.SubjectId);
+			Section.SubjectName = FAnsiStringView(Section.SubjectIdBuffer, NameLength);
+		}
+	}
+
+	return EResult::Decoded;
+}
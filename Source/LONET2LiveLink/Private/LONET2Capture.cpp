@@ -0,0 +1,266 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2Capture.h"
+
+#include "LONET2LiveLinkSource.h"
+#include "LONET2PacketPool.h"
+#include "LONET2Runnable.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/ScopeLock.h"
+
+namespace LONET2Capture
+{
+	static const uint8 Magic[4] = { 'L', 'N', '2', 'C' };
+
+	static constexpr int32 FileHeaderSize = 16;
+	static constexpr int32 RecordHeaderSize = 16;
+
+	static constexpr int32 FlushThreshold = 256 * 1024;
+	static constexpr int32 BufferSize = FlushThreshold + 64 * 1024;
+
+	/** 16 MB waiting for a slow disk, later buffers are dropped rather than stall the receive thread or grow without bound. */
+	static constexpr int32 MaxQueuedBuffers = 64;
+
+	template<typename T>
+	static void Append(TArray<uint8>& Buffer, T Value)
+	{
+		Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	template<typename T>
+	static T Read(const uint8* Data)
+	{
+		T Value;
+		FMemory::Memcpy(&Value, Data, sizeof(T));
+		return Value;
+	}
+}
+
+/** Writes the buffers a capture writer filled, and owns the file. */
+class FLONET2CaptureFileThread : public FLONET2Runnable
+{
+public:
+
+	explicit FLONET2CaptureFileThread(TUniquePtr<FArchive> InArchive)
+		: Archive(MoveTemp(InArchive))
+	{
+		WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+		StartThread(TEXT("LONET2_CaptureWriter"), TPri_BelowNormal, 0);
+	}
+
+	/** Writes whatever is still queued before closing the file. */
+	virtual ~FLONET2CaptureFileThread()
+	{
+		StopThread();
+		WriteQueued();
+		Archive->Close();
+
+		FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+		WorkEvent = nullptr;
+	}
+
+	/** Queues Buffer for writing and swaps in an empty one. Returns false, leaving Buffer empty, if the queue was full and the records were dropped. */
+	bool Submit(TArray<uint8>& Buffer)
+	{
+		bool bQueued = false;
+		{
+			FScopeLock Lock(&CriticalSection);
+			if (FullBuffers.Num() < LONET2Capture::MaxQueuedBuffers)
+			{
+				FullBuffers.Add(MoveTemp(Buffer));
+				Buffer = FreeBuffers.Num() > 0 ? FreeBuffers.Pop(false) : TArray<uint8>();
+				bQueued = true;
+			}
+		}
+
+		Buffer.Reset(LONET2Capture::BufferSize);
+		if (bQueued)
+		{
+			WorkEvent->Trigger();
+		}
+		return bQueued;
+	}
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override
+	{
+		while (!bStopping)
+		{
+			WorkEvent->Wait(FTimespan::FromMilliseconds(100));
+			ApplyThreadAffinity();
+			WriteQueued();
+		}
+		return 0;
+	}
+
+	virtual void Stop() override
+	{
+		bStopping = true;
+		WorkEvent->Trigger();
+	}
+	// End FRunnable Interface
+
+private:
+
+	void WriteQueued()
+	{
+		TArray<TArray<uint8>> Writing;
+		{
+			FScopeLock Lock(&CriticalSection);
+			Swap(Writing, FullBuffers);
+		}
+
+		for (TArray<uint8>& Written : Writing)
+		{
+			Archive->Serialize(Written.GetData(), Written.Num());
+			Written.Reset();
+		}
+
+		// Written buffers keep their allocation for the next Submit
+		FScopeLock Lock(&CriticalSection);
+		FreeBuffers.Append(MoveTemp(Writing));
+	}
+
+	TUniquePtr<FArchive> Archive;
+
+	FCriticalSection CriticalSection;
+
+	TArray<TArray<uint8>> FullBuffers;
+	TArray<TArray<uint8>> FreeBuffers;
+
+	FEvent* WorkEvent = nullptr;
+
+	FThreadSafeBool bStopping;
+};
+
+TUniquePtr<FLONET2CaptureWriter> FLONET2CaptureWriter::Create(const FString& Filename)
+{
+	FArchive* Archive = IFileManager::Get().CreateFileWriter(*Filename);
+	if (Archive == nullptr)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Failed to create LONET 2 capture file %s"), *Filename);
+		return nullptr;
+	}
+
+	TUniquePtr<FLONET2CaptureWriter> Writer(new FLONET2CaptureWriter());
+	Writer->FileThread = MakeUnique<FLONET2CaptureFileThread>(TUniquePtr<FArchive>(Archive));
+	Writer->Buffer.Reserve(LONET2Capture::BufferSize);
+	Writer->StartTime = FPlatformTime::Seconds();
+
+	Writer->Buffer.Append(LONET2Capture::Magic, UE_ARRAY_COUNT(LONET2Capture::Magic));
+	LONET2Capture::Append<uint16>(Writer->Buffer, LONET2_CAPTURE_VERSION);
+	LONET2Capture::Append<uint16>(Writer->Buffer, 0);
+	LONET2Capture::Append<int64>(Writer->Buffer, FDateTime::UtcNow().GetTicks());
+
+	UE_LOG(ModuleLog, Log, TEXT("Capturing LONET 2 datagrams to %s"), *Filename);
+	return Writer;
+}
+
+FLONET2CaptureWriter::~FLONET2CaptureWriter()
+{
+	if (Buffer.Num() > 0 && !FileThread->Submit(Buffer))
+	{
+		++DroppedBufferCount;
+	}
+	FileThread.Reset();
+
+	if (DroppedBufferCount > 0)
+	{
+		UE_LOG(ModuleLog, Warning, TEXT("LONET 2 capture closed after %llu datagrams, %d buffers were dropped because the disk could not keep up"), PacketCount, DroppedBufferCount);
+		return;
+	}
+	UE_LOG(ModuleLog, Log, TEXT("LONET 2 capture closed after %llu datagrams"), PacketCount);
+}
+
+void FLONET2CaptureWriter::Write(TArrayView<FLONET2Packet* const> Packets)
+{
+	for (const FLONET2Packet* Packet : Packets)
+	{
+		const uint64 TimeNs = static_cast<uint64>(FMath::Max(Packet->ReceiveTime - StartTime, 0.0) * 1000000000.0);
+
+		LONET2Capture::Append<uint64>(Buffer, TimeNs);
+		LONET2Capture::Append<uint32>(Buffer, Packet->Sender.Address.Value);
+		LONET2Capture::Append<uint16>(Buffer, Packet->Sender.Port);
+		LONET2Capture::Append<uint16>(Buffer, static_cast<uint16>(FMath::Min(Packet->Data.Num(), int32(MAX_uint16))));
+		Buffer.Append(Packet->Data.GetData(), FMath::Min(Packet->Data.Num(), int32(MAX_uint16)));
+		++PacketCount;
+	}
+
+	if (Buffer.Num() >= LONET2Capture::FlushThreshold && !FileThread->Submit(Buffer))
+	{
+		++DroppedBufferCount;
+	}
+}
+
+TUniquePtr<FLONET2CaptureReader> FLONET2CaptureReader::Open(const FString& Filename)
+{
+	IMappedFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename);
+	if (Handle == nullptr || Handle->GetFileSize() < LONET2Capture::FileHeaderSize)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Failed to open LONET 2 capture file %s"), *Filename);
+		delete Handle;
+		return nullptr;
+	}
+
+	TUniquePtr<FLONET2CaptureReader> Reader(new FLONET2CaptureReader());
+	Reader->MappedHandle.Reset(Handle);
+	Reader->MappedRegion.Reset(Handle->MapRegion(0, Handle->GetFileSize()));
+	if (!Reader->MappedRegion.IsValid())
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Failed to map LONET 2 capture file %s"), *Filename);
+		return nullptr;
+	}
+
+	Reader->Data = Reader->MappedRegion->GetMappedPtr();
+	Reader->Size = Reader->MappedRegion->GetMappedSize();
+
+	if (FMemory::Memcmp(Reader->Data, LONET2Capture::Magic, UE_ARRAY_COUNT(LONET2Capture::Magic)) != 0
+		|| LONET2Capture::Read<uint16>(Reader->Data + 4) > LONET2_CAPTURE_VERSION)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("%s is not a LONET 2 capture file this version can read"), *Filename);
+		return nullptr;
+	}
+
+	return Reader;
+}
+
+FLONET2CaptureReader::~FLONET2CaptureReader()
+{
+	// The region has to go before the handle it was mapped from
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+}
+
+int64 FLONET2CaptureReader::GetFirstRecordOffset() const
+{
+	return LONET2Capture::FileHeaderSize;
+}
+
+bool FLONET2CaptureReader::Next(int64& Offset, FRecord& OutRecord) const
+{
+	if (Offset + LONET2Capture::RecordHeaderSize > Size)
+	{
+		return false;
+	}
+
+	const uint8* Record = Data + Offset;
+	const int32 Num = LONET2Capture::Read<uint16>(Record + 14);
+	if (Offset + LONET2Capture::RecordHeaderSize + Num > Size)
+	{
+		return false;
+	}
+
+	OutRecord.TimeNs = LONET2Capture::Read<uint64>(Record);
+	OutRecord.Sender = FIPv4Endpoint(FIPv4Address(LONET2Capture::Read<uint32>(Record + 8)), LONET2Capture::Read<uint16>(Record + 12));
+	OutRecord.Data = Record + LONET2Capture::RecordHeaderSize;
+	OutRecord.Num = Num;
+
+	Offset += LONET2Capture::RecordHeaderSize + Num;
+	return true;
+}
@@ -0,0 +1,98 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+
+class FLONET2CaptureFileThread;
+class IMappedFileHandle;
+class IMappedFileRegion;
+struct FLONET2Packet;
+
+/**
+ * LONET 2 capture files hold raw datagrams as they arrived, for replay and profiling.
+ * All values are little endian.
+ *
+ * File header (16 bytes)
+ *   char    Magic[4]       "LN2C"
+ *   uint16  Version        LONET2_CAPTURE_VERSION
+ *   uint16  Reserved       0
+ *   int64   StartTicks     FDateTime UTC ticks when the capture started
+ *
+ * Record header (16 bytes), followed by Size bytes of datagram
+ *   uint64  TimeNs         arrival time in nanoseconds since the capture started
+ *   uint32  SenderAddress  a.b.c.d stored as (a << 24) | (b << 16) | (c << 8) | d
+ *   uint16  SenderPort
+ *   uint16  Size
+ */
+
+#define LONET2_CAPTURE_VERSION 1
+
+/**
+ * Appends received datagrams to a capture file. Not thread safe, the owner serializes calls.
+ * Records are staged in memory and full buffers are written by a thread of their own, so the caller never waits on the disk.
+ */
+class FLONET2CaptureWriter
+{
+public:
+
+	/** Returns nullptr if the file cannot be created. */
+	static TUniquePtr<FLONET2CaptureWriter> Create(const FString& Filename);
+
+	~FLONET2CaptureWriter();
+
+	void Write(TArrayView<FLONET2Packet* const> Packets);
+
+	uint64 GetPacketCount() const { return PacketCount; }
+
+private:
+
+	FLONET2CaptureWriter() = default;
+
+	TUniquePtr<FLONET2CaptureFileThread> FileThread;
+
+	/** Records are staged here and handed to the file thread every few hundred kilobytes. */
+	TArray<uint8> Buffer;
+
+	double StartTime = 0.0;
+
+	uint64 PacketCount = 0;
+
+	int32 DroppedBufferCount = 0;
+};
+
+/** Read only view of a capture file, memory mapped so replay never copies the file into memory. */
+class FLONET2CaptureReader
+{
+public:
+
+	struct FRecord
+	{
+		uint64 TimeNs = 0;
+		FIPv4Endpoint Sender;
+		const uint8* Data = nullptr;
+		int32 Num = 0;
+	};
+
+	/** Returns nullptr if the file is missing or is not a capture. */
+	static TUniquePtr<FLONET2CaptureReader> Open(const FString& Filename);
+
+	~FLONET2CaptureReader();
+
+	/** Offset of the first record, pass it to Next to start reading. */
+	int64 GetFirstRecordOffset() const;
+
+	/** Reads the record at Offset and moves Offset past it. False at the end of the file or on a truncated record. */
+	bool Next(int64& Offset, FRecord& OutRecord) const;
+
+private:
+
+	FLONET2CaptureReader() = default;
+
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+};
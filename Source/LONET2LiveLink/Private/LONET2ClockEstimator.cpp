@@ -0,0 +1,104 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2ClockEstimator.h"
+
+void FLONET2ClockEstimator::AddSample(double SenderSeconds, double LocalSeconds)
+{
+	const double Offset = LocalSeconds - SenderSeconds;
+
+	// Delay only ever raises the offset, a late packet is no reason to drop the fit. Only a timecode jumping ahead lowers it below
+	// the envelope, and a jump back is caught by the timecode itself.
+	if (NumBuckets > 0 && (SenderSeconds < LastSenderSeconds - ResyncSeconds || Offset < ToLocalSeconds(SenderSeconds) - SenderSeconds - ResyncSeconds))
+	{
+		Reset();
+	}
+	LastSenderSeconds = FMath::Max(LastSenderSeconds, SenderSeconds);
+
+	FBucket* Newest = NumBuckets > 0 ? &Buckets[(FirstBucket + NumBuckets - 1) % MaxBuckets] : nullptr;
+	if (Newest != nullptr && SenderSeconds < Newest->SenderSeconds + BucketSeconds)
+	{
+		if (Offset < Newest->MinOffset)
+		{
+			Newest->SenderSeconds = SenderSeconds;
+			Newest->MinOffset = Offset;
+			Fit();
+		}
+		return;
+	}
+
+	if (NumBuckets == MaxBuckets)
+	{
+		FirstBucket = (FirstBucket + 1) % MaxBuckets;
+		--NumBuckets;
+	}
+
+	FBucket& Bucket = Buckets[(FirstBucket + NumBuckets) % MaxBuckets];
+	Bucket.SenderSeconds = SenderSeconds;
+	Bucket.MinOffset = Offset;
+	++NumBuckets;
+	Fit();
+}
+
+void FLONET2ClockEstimator::Fit()
+{
+	// Least squares line through the bucket minima, relative to the oldest one to keep the sums well conditioned
+	const FBucket& Oldest = Buckets[FirstBucket];
+	BaseSenderSeconds = Oldest.SenderSeconds;
+
+	if (NumBuckets < 3)
+	{
+		// Too little history for a slope, use the lowest offset seen so far
+		BaseOffset = Oldest.MinOffset;
+		for (int32 Index = 1; Index < NumBuckets; ++Index)
+		{
+			BaseOffset = FMath::Min(BaseOffset, Buckets[(FirstBucket + Index) % MaxBuckets].MinOffset);
+		}
+		Drift = 0.0;
+		return;
+	}
+
+	double SumX = 0.0, SumY = 0.0, SumXX = 0.0, SumXY = 0.0;
+	for (int32 Index = 0; Index < NumBuckets; ++Index)
+	{
+		const FBucket& Bucket = Buckets[(FirstBucket + Index) % MaxBuckets];
+		const double X = Bucket.SenderSeconds - BaseSenderSeconds;
+		const double Y = Bucket.MinOffset;
+		SumX += X;
+		SumY += Y;
+		SumXX += X * X;
+		SumXY += X * Y;
+	}
+
+	const double Denominator = NumBuckets * SumXX - SumX * SumX;
+	Drift = Denominator > SMALL_NUMBER ? (NumBuckets * SumXY - SumX * SumY) / Denominator : 0.0;
+	BaseOffset = (SumY - Drift * SumX) / NumBuckets;
+
+	// The fit runs through the middle of the minima, shift it down onto the lowest of them so it stays an envelope
+	double Lowest = 0.0;
+	for (int32 Index = 0; Index < NumBuckets; ++Index)
+	{
+		const FBucket& Bucket = Buckets[(FirstBucket + Index) % MaxBuckets];
+		Lowest = FMath::Min(Lowest, Bucket.MinOffset - (BaseOffset + Drift * (Bucket.SenderSeconds - BaseSenderSeconds)));
+	}
+	BaseOffset += Lowest;
+}
+
+double FLONET2ClockEstimator::ToLocalSeconds(double SenderSeconds) const
+{
+	return SenderSeconds + BaseOffset + Drift * (SenderSeconds - BaseSenderSeconds);
+}
+
+double FLONET2ClockEstimator::GetOffset() const
+{
+	return ToLocalSeconds(LastSenderSeconds) - LastSenderSeconds;
+}
+
+void FLONET2ClockEstimator::Reset()
+{
+	FirstBucket = 0;
+	NumBuckets = 0;
+	BaseSenderSeconds = 0.0;
+	BaseOffset = 0.0;
+	Drift = 0.0;
+	LastSenderSeconds = 0.0;
+}
@@ -0,0 +1,60 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Estimates the offset and drift between a sender's timecode clock and the local FPlatformTime clock.
+ * Network and scheduling delay only ever make a packet later, so the estimate follows the lower envelope of
+ * (arrival - timecode): the smallest offset of every bucket is kept and a line is fitted through the recent minima.
+ * Not thread safe, only the decoding thread uses it.
+ */
+class FLONET2ClockEstimator
+{
+public:
+
+	/** Adds a sample, SenderSeconds is the frame's timecode in seconds and LocalSeconds its arrival time. */
+	void AddSample(double SenderSeconds, double LocalSeconds);
+
+	/** Maps a sender time onto the local clock. Only valid once HasEstimate(). */
+	double ToLocalSeconds(double SenderSeconds) const;
+
+	bool HasEstimate() const { return NumBuckets > 0; }
+
+	/** Local minus sender seconds at the newest sample. */
+	double GetOffset() const;
+
+	/** Seconds the local clock gains per sender second, usually a few parts per million. */
+	double GetDrift() const { return Drift; }
+
+	void Reset();
+
+private:
+
+	struct FBucket
+	{
+		double SenderSeconds = 0.0;
+		double MinOffset = 0.0;
+	};
+
+	void Fit();
+
+	/** Sender seconds covered by one bucket. */
+	static constexpr double BucketSeconds = 0.5;
+
+	/** Minima kept for the fit, 8 seconds of history. */
+	static constexpr int32 MaxBuckets = 16;
+
+	/** A timecode this far behind the newest, or an offset this far below the estimate, means the timecode jumped (sender restart, midnight wrap) and history is dropped. */
+	static constexpr double ResyncSeconds = 1.0;
+
+	FBucket Buckets[MaxBuckets];
+	int32 FirstBucket = 0;
+	int32 NumBuckets = 0;
+
+	double BaseSenderSeconds = 0.0;
+	double BaseOffset = 0.0;
+	double Drift = 0.0;
+	double LastSenderSeconds = 0.0;
+};
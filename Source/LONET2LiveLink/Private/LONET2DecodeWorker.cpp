@@ -0,0 +1,48 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2DecodeWorker.h"
+
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+
+FLONET2DecodeWorker::FLONET2DecodeWorker(FOnDrain InOnDrain, const TCHAR* ThreadName, EThreadPriority Priority, uint64 AffinityMask)
+	: OnDrain(InOnDrain)
+{
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	StartThread(ThreadName, Priority, AffinityMask);
+}
+
+FLONET2DecodeWorker::~FLONET2DecodeWorker()
+{
+	StopThread();
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+void FLONET2DecodeWorker::Wake()
+{
+	WorkEvent->Trigger();
+}
+
+uint32 FLONET2DecodeWorker::Run()
+{
+	while (!bStopping)
+	{
+		WorkEvent->Wait(FTimespan::FromMilliseconds(100));
+		ApplyThreadAffinity();
+
+		if (!bStopping)
+		{
+			OnDrain.ExecuteIfBound();
+		}
+	}
+
+	return 0;
+}
+
+void FLONET2DecodeWorker::Stop()
+{
+	bStopping = true;
+	WorkEvent->Trigger();
+}
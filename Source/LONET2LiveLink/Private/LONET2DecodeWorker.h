@@ -0,0 +1,39 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "LONET2Runnable.h"
+
+class FEvent;
+
+/**
+ * Dedicated thread that drains the datagrams queued by the UDP receiver thread,
+ * so neither the receiver nor the game thread pays for parsing.
+ */
+class FLONET2DecodeWorker : public FLONET2Runnable
+{
+public:
+
+	DECLARE_DELEGATE(FOnDrain);
+
+	FLONET2DecodeWorker(FOnDrain InOnDrain, const TCHAR* ThreadName, EThreadPriority Priority = TPri_AboveNormal, uint64 AffinityMask = 0);
+	virtual ~FLONET2DecodeWorker();
+
+	/** Wakes the worker to drain pending packets. */
+	void Wake();
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable Interface
+
+private:
+
+	FOnDrain OnDrain;
+
+	FEvent* WorkEvent = nullptr;
+
+	FThreadSafeBool bStopping;
+};
@@ -0,0 +1,84 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2DeltaState.h"
+
+#include "LONET2LiveLinkSource.h"
+#include "LONET2Schema.h"
+
+FLONET2DeltaState::EResult FLONET2DeltaState::Apply(FName SubjectName, const LONET2Schema::FSection& Schema, uint32 Sequence, bool bKeyframe, uint32 FieldMask,
+	double& InOutFrameRate, FLiveLinkFrameDataStruct& InOutFrame)
+{
+	FSubjectState& State = Subjects.FindOrAdd(SubjectName);
+
+	// Distance from the last section, wrapping with the sequence number
+	const uint32 Behind = State.Sequence - Sequence;
+	const bool bNewer = static_cast<int32>(Sequence - State.Sequence) > 0;
+
+	if (bKeyframe)
+	{
+		if (State.Frame.IsValid() && !bNewer && Behind < RestartDistance)
+		{
+			++StaleCount;
+			return EResult::Stale;
+		}
+
+		State.Frame.InitializeWith(InOutFrame);
+		State.FrameRate = InOutFrameRate;
+		State.Sequence = Sequence;
+		State.bValid = true;
+		return EResult::Applied;
+	}
+
+	if (State.Frame.IsValid() && !bNewer)
+	{
+		++StaleCount;
+		return EResult::Stale;
+	}
+
+	if (!State.bValid || Sequence != State.Sequence + 1)
+	{
+		if (State.bValid)
+		{
+			UE_LOG(ModuleLog, Verbose, TEXT("LONET 2 subject %s lost sections %u to %u, waiting for a keyframe"), *SubjectName.ToString(), State.Sequence + 1, Sequence - 1);
+		}
+
+		// Later deltas build on the lost section too, only a keyframe recovers
+		State.Sequence = Sequence;
+		State.bValid = false;
+		++GapCount;
+		return EResult::Gap;
+	}
+
+	const FLiveLinkBaseFrameData& Last = *State.Frame.GetBaseData();
+	FLiveLinkBaseFrameData& Frame = *InOutFrame.GetBaseData();
+	for (const LONET2Schema::FField& Field : Schema.Fields)
+	{
+		if (FieldMask & LONET2Schema::GetFieldBit(Schema, Field))
+		{
+			continue;
+		}
+		if (Field.Target == LONET2Schema::EFieldTarget::FrameRate)
+		{
+			InOutFrameRate = State.FrameRate;
+		}
+		else
+		{
+			LONET2Schema::CopyField(Field, Last, Frame);
+		}
+	}
+
+	State.Frame.InitializeWith(InOutFrame);
+	State.FrameRate = InOutFrameRate;
+	State.Sequence = Sequence;
+	return EResult::Applied;
+}
+
+void FLONET2DeltaState::Remove(FName SubjectName)
+{
+	Subjects.Remove(SubjectName);
+}
+
+void FLONET2DeltaState::Empty()
+{
+	Subjects.Empty();
+}
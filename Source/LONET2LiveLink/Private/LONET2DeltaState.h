@@ -0,0 +1,73 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LiveLinkTypes.h"
+
+namespace LONET2Schema
+{
+	struct FSection;
+}
+
+/**
+ * Rebuilds complete frames from the LONET 2 keyframe and delta mode.
+ *
+ * A section with a "sequence" number is a keyframe when it has "keyframe": true and a delta otherwise. Keyframes carry every field,
+ * deltas only the fields that changed, typically the timecode and transform, and every field a delta leaves out keeps the value of the
+ * subject's last frame. Each subject counts its own sequence up by one per section. A delta that does not follow the last section of
+ * its subject means a section was lost, so the subject's deltas are dropped until its next keyframe.
+ *
+ * Sections without a sequence number are complete frames and never reach this class. Only the decoding thread uses it.
+ */
+class FLONET2DeltaState
+{
+public:
+
+	enum class EResult : uint8
+	{
+		/** The frame is complete, a keyframe or a delta filled in from the last frame. */
+		Applied,
+		/** Not newer than the subject's last section, a reordered or duplicated datagram. */
+		Stale,
+		/** A delta after a lost section or before the first keyframe, dropped. */
+		Gap,
+	};
+
+	/**
+	 * Applies one sequenced section of Schema to the subject's state.
+	 * FieldMask has a bit per schema field the section carried, see LONET2Schema::GetFieldBit. When the result is Applied,
+	 * InOutFrame and InOutFrameRate hold the complete frame.
+	 */
+	EResult Apply(FName SubjectName, const LONET2Schema::FSection& Schema, uint32 Sequence, bool bKeyframe, uint32 FieldMask,
+		double& InOutFrameRate, FLiveLinkFrameDataStruct& InOutFrame);
+
+	void Remove(FName SubjectName);
+
+	void Empty();
+
+	/** Deltas dropped because a section of their subject was lost. */
+	uint64 GetGapCount() const { return GapCount; }
+
+	/** Sections dropped because their subject already had a newer one. */
+	uint64 GetStaleCount() const { return StaleCount; }
+
+private:
+
+	struct FSubjectState
+	{
+		FLiveLinkFrameDataStruct Frame;
+		double FrameRate = 24.0;
+		uint32 Sequence = 0;
+		/** False until the first keyframe, and again after a lost section. */
+		bool bValid = false;
+	};
+
+	/** A keyframe this far behind the last section comes from a restarted sender rather than from reordering. */
+	static constexpr uint32 RestartDistance = 1024;
+
+	TMap<FName, FSubjectState> Subjects;
+
+	uint64 GapCount = 0;
+	uint64 StaleCount = 0;
+};
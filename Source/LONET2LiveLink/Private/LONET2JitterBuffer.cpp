@@ -0,0 +1,125 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2JitterBuffer.h"
+
+#include "Misc/ScopeLock.h"
+
+FLONET2JitterBuffer::FLONET2JitterBuffer(int32 InDelayFrames, double InDelaySeconds, int32 InMaxFramesPerSubject)
+	: DelayFrames(FMath::Max(InDelayFrames, 0))
+	, DelaySeconds(FMath::Max(InDelaySeconds, 0.0))
+	, MaxFramesPerSubject(FMath::Max(InMaxFramesPerSubject, 1))
+{
+}
+
+double FLONET2JitterBuffer::GetDelaySeconds(const FLiveLinkBaseFrameData& FrameData) const
+{
+	return DelayFrames > 0 ? DelayFrames * FrameData.MetaData.SceneTime.Rate.AsInterval() : DelaySeconds;
+}
+
+void FLONET2JitterBuffer::Insert(FName SubjectName, FLiveLinkFrameDataStruct&& FrameData)
+{
+	const FLiveLinkBaseFrameData& BaseData = *FrameData.GetBaseData();
+	const double SceneSeconds = BaseData.MetaData.SceneTime.AsSeconds();
+
+	FScopeLock Lock(&CriticalSection);
+
+	const double Delay = GetDelaySeconds(BaseData);
+	const double ReleaseTime = BaseData.WorldTime.GetOffsettedTime() + Delay;
+
+	FSubject& Subject = Subjects.FindOrAdd(SubjectName);
+
+	// A jump back is a new timeline rather than a late frame, whatever is held belongs to the old one
+	double NewestSeconds = Subject.Frames.Num() > 0 ? Subject.Frames.Last().SceneSeconds : -DBL_MAX;
+	if (Subject.bHasReleased)
+	{
+		NewestSeconds = FMath::Max(NewestSeconds, Subject.LastReleasedSeconds);
+	}
+	if (NewestSeconds - SceneSeconds > FMath::Max(ResyncSeconds, 4.0 * Delay))
+	{
+		Subject.Frames.Reset();
+		Subject.bHasReleased = false;
+		++ResyncCount;
+	}
+
+	if (Subject.bHasReleased && SceneSeconds <= Subject.LastReleasedSeconds)
+	{
+		++LateCount;
+		return;
+	}
+
+	// Frames nearly always arrive in order, so search for the insertion point from the back
+	int32 Index = Subject.Frames.Num();
+	while (Index > 0 && Subject.Frames[Index - 1].SceneSeconds >= SceneSeconds)
+	{
+		if (Subject.Frames[Index - 1].SceneSeconds == SceneSeconds)
+		{
+			++LateCount;
+			return;
+		}
+		--Index;
+	}
+
+	if (Index < Subject.Frames.Num())
+	{
+		++ReorderedCount;
+	}
+
+	FEntry& Entry = Subject.Frames.InsertDefaulted_GetRef(Index);
+	Entry.SceneSeconds = SceneSeconds;
+	Entry.ReleaseTime = ReleaseTime;
+	Entry.FrameData = MoveTemp(FrameData);
+
+	// A subject that outruns the delay must not grow without bound, its oldest frames become due immediately
+	for (int32 Excess = Subject.Frames.Num() - MaxFramesPerSubject; Excess > 0; --Excess)
+	{
+		Subject.Frames[Excess - 1].ReleaseTime = 0.0;
+	}
+}
+
+void FLONET2JitterBuffer::Release(double Now, TFunctionRef<void(FName, FLiveLinkFrameDataStruct&&)> Push)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	for (TPair<FName, FSubject>& Pair : Subjects)
+	{
+		FSubject& Subject = Pair.Value;
+
+		int32 NumDue = 0;
+		while (NumDue < Subject.Frames.Num() && Subject.Frames[NumDue].ReleaseTime <= Now)
+		{
+			++NumDue;
+		}
+
+		for (int32 Index = 0; Index < NumDue; ++Index)
+		{
+			FEntry& Entry = Subject.Frames[Index];
+			Subject.LastReleasedSeconds = Entry.SceneSeconds;
+			Subject.bHasReleased = true;
+			Push(Pair.Key, MoveTemp(Entry.FrameData));
+		}
+
+		if (NumDue > 0)
+		{
+			Subject.Frames.RemoveAt(0, NumDue, false);
+		}
+	}
+}
+
+void FLONET2JitterBuffer::SetDelay(int32 InDelayFrames, double InDelaySeconds)
+{
+	FScopeLock Lock(&CriticalSection);
+	DelayFrames = FMath::Max(InDelayFrames, 0);
+	DelaySeconds = FMath::Max(InDelaySeconds, 0.0);
+}
+
+void FLONET2JitterBuffer::Remove(FName SubjectName)
+{
+	FScopeLock Lock(&CriticalSection);
+	Subjects.Remove(SubjectName);
+}
+
+void FLONET2JitterBuffer::Empty()
+{
+	FScopeLock Lock(&CriticalSection);
+	Subjects.Empty();
+}
@@ -0,0 +1,78 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "LiveLinkTypes.h"
+
+/**
+ * Per subject jitter buffer that orders frames by scene time and releases each one a fixed delay after its world time.
+ * With world time stamped from the sender clock estimate, frames come out evenly spaced however the network bunched them.
+ * Frames older than the last one released, and duplicates of a buffered frame, are dropped as late.
+ * Scene time going back by more than ResyncSeconds (timecode wrap, sender restart, looped replay) starts the subject over instead.
+ */
+class FLONET2JitterBuffer
+{
+public:
+
+	/** Delay is DelayFrames at the frame's own rate when DelayFrames > 0, DelaySeconds otherwise. */
+	FLONET2JitterBuffer(int32 InDelayFrames, double InDelaySeconds, int32 InMaxFramesPerSubject = 64);
+
+	/** Scene time jumps back further than this, or a few delays when those are longer, resync the subject. Matches FLONET2ClockEstimator. */
+	static constexpr double ResyncSeconds = 1.0;
+
+	void Insert(FName SubjectName, FLiveLinkFrameDataStruct&& FrameData);
+
+	/** Pushes every frame due at Now (FPlatformTime::Seconds()), in scene time order per subject. */
+	void Release(double Now, TFunctionRef<void(FName, FLiveLinkFrameDataStruct&&)> Push);
+
+	/** Changes the delay of frames inserted from now on, held frames keep their release time. */
+	void SetDelay(int32 InDelayFrames, double InDelaySeconds);
+
+	void Remove(FName SubjectName);
+
+	void Empty();
+
+	/** Frames that arrived after a frame with a later scene time. */
+	uint64 GetReorderedCount() const { return ReorderedCount; }
+
+	/** Frames dropped because a later frame was already released or the same scene time is buffered. */
+	uint64 GetLateCount() const { return LateCount; }
+
+	/** Times a subject started over because its scene time jumped back. */
+	uint64 GetResyncCount() const { return ResyncCount; }
+
+private:
+
+	struct FEntry
+	{
+		double SceneSeconds = 0.0;
+		double ReleaseTime = 0.0;
+		FLiveLinkFrameDataStruct FrameData;
+	};
+
+	struct FSubject
+	{
+		/** Sorted by SceneSeconds. */
+		TArray<FEntry> Frames;
+
+		double LastReleasedSeconds = 0.0;
+		bool bHasReleased = false;
+	};
+
+	double GetDelaySeconds(const FLiveLinkBaseFrameData& FrameData) const;
+
+	/** Held across Release including the pushes, so frames of a subject never reach LiveLink out of order from two threads. */
+	FCriticalSection CriticalSection;
+
+	TMap<FName, FSubject> Subjects;
+
+	int32 DelayFrames;
+	double DelaySeconds;
+	int32 MaxFramesPerSubject;
+
+	TAtomic<uint64> ReorderedCount { 0 };
+	TAtomic<uint64> LateCount { 0 };
+	TAtomic<uint64> ResyncCount { 0 };
+};
@@ -0,0 +1,123 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2LensTable.h"
+
+#include "Hash/CityHash.h"
+#include "LiveLinkLensTypes.h"
+
+FLONET2LensTable::FLONET2LensTable(TArray<FLONET2LensSample>&& Samples)
+{
+	Samples.Sort([](const FLONET2LensSample& A, const FLONET2LensSample& B)
+		{
+			return A.Focus < B.Focus || (A.Focus == B.Focus && A.Zoom < B.Zoom);
+		});
+
+	for (FLONET2LensSample& Sample : Samples)
+	{
+		NumParameters = FMath::Max(NumParameters, Sample.DistortionParameters.Num());
+
+		if (Curves.Num() == 0 || Curves.Last().Focus != Sample.Focus)
+		{
+			Curves.AddDefaulted_GetRef().Focus = Sample.Focus;
+		}
+		Curves.Last().Samples.Add(MoveTemp(Sample));
+	}
+}
+
+void FLONET2LensTable::AccumulateSample(const FLONET2LensSample& Sample, float Weight, FLiveLinkLensFrameData& OutFrame)
+{
+	OutFrame.FxFy[0] += Weight * Sample.FxFy[0];
+	OutFrame.FxFy[1] += Weight * Sample.FxFy[1];
+	OutFrame.PrincipalPoint[0] += Weight * Sample.PrincipalPoint[0];
+	OutFrame.PrincipalPoint[1] += Weight * Sample.PrincipalPoint[1];
+
+	// Samples with fewer parameters than the longest one count as zero for the rest
+	for (int32 Index = 0; Index < Sample.DistortionParameters.Num(); ++Index)
+	{
+		OutFrame.DistortionParameters[Index] += Weight * Sample.DistortionParameters[Index];
+	}
+}
+
+void FLONET2LensTable::Accumulate(const FCurve& Curve, float Zoom, float Weight, FLiveLinkLensFrameData& OutFrame) const
+{
+	const TArray<FLONET2LensSample>& Samples = Curve.Samples;
+
+	// Index of the first sample above Zoom, the curve is short so a linear scan is fine
+	int32 Upper = 0;
+	while (Upper < Samples.Num() && Samples[Upper].Zoom <= Zoom)
+	{
+		++Upper;
+	}
+
+	if (Upper == 0 || Upper == Samples.Num())
+	{
+		AccumulateSample(Samples[FMath::Min(Upper, Samples.Num() - 1)], Weight, OutFrame);
+		return;
+	}
+
+	const FLONET2LensSample& Below = Samples[Upper - 1];
+	const FLONET2LensSample& Above = Samples[Upper];
+	const float Alpha = (Zoom - Below.Zoom) / (Above.Zoom - Below.Zoom);
+	AccumulateSample(Below, Weight * (1.0f - Alpha), OutFrame);
+	AccumulateSample(Above, Weight * Alpha, OutFrame);
+}
+
+void FLONET2LensTable::Evaluate(float Focus, float Zoom, FLiveLinkLensFrameData& OutFrame) const
+{
+	OutFrame.FxFy = FVector2D::ZeroVector;
+	OutFrame.PrincipalPoint = FVector2D::ZeroVector;
+	OutFrame.DistortionParameters.Reset(NumParameters);
+	OutFrame.DistortionParameters.SetNumZeroed(NumParameters);
+
+	if (Curves.Num() == 0)
+	{
+		return;
+	}
+
+	int32 Upper = 0;
+	while (Upper < Curves.Num() && Curves[Upper].Focus <= Focus)
+	{
+		++Upper;
+	}
+
+	if (Upper == 0 || Upper == Curves.Num())
+	{
+		Accumulate(Curves[FMath::Min(Upper, Curves.Num() - 1)], Zoom, 1.0f, OutFrame);
+		return;
+	}
+
+	const FCurve& Below = Curves[Upper - 1];
+	const FCurve& Above = Curves[Upper];
+	const float Alpha = (Focus - Below.Focus) / (Above.Focus - Below.Focus);
+	Accumulate(Below, Zoom, 1.0f - Alpha, OutFrame);
+	Accumulate(Above, Zoom, Alpha, OutFrame);
+}
+
+uint64 FLONET2LensTableCache::HashName(FAnsiStringView RawName, const FIPv4Address& Sender)
+{
+	return CityHash64WithSeed(RawName.GetData(), RawName.Len(), Sender.Value);
+}
+
+void FLONET2LensTableCache::Set(FAnsiStringView RawCameraName, const FIPv4Address& Sender, TArray<FLONET2LensSample>&& Samples)
+{
+	FEntry& Entry = Tables.FindOrAdd(HashName(RawCameraName, Sender));
+	Entry.RawName.Reset();
+	Entry.RawName.Append(RawCameraName.GetData(), RawCameraName.Len());
+	Entry.Sender = Sender;
+	Entry.Table = MakeUnique<FLONET2LensTable>(MoveTemp(Samples));
+}
+
+const FLONET2LensTable* FLONET2LensTableCache::Find(FAnsiStringView RawCameraName, const FIPv4Address& Sender) const
+{
+	const FEntry* Entry = Tables.Find(HashName(RawCameraName, Sender));
+	if (Entry == nullptr || Entry->Sender != Sender || !FAnsiStringView(Entry->RawName.GetData(), Entry->RawName.Num()).Equals(RawCameraName))
+	{
+		return nullptr;
+	}
+	return Entry->Table.Get();
+}
+
+void FLONET2LensTableCache::Empty()
+{
+	Tables.Empty();
+}
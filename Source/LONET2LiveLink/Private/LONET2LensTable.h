@@ -0,0 +1,84 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+
+struct FLiveLinkLensFrameData;
+
+/** One calibrated lens point, Focus and Zoom in the same units as the encoder_data mapped values. */
+struct FLONET2LensSample
+{
+	float Focus = 0.0f;
+	float Zoom = 0.0f;
+	float FxFy[2] = { 0.0f, 0.0f };
+	float PrincipalPoint[2] = { 0.0f, 0.0f };
+	TArray<float> DistortionParameters;
+};
+
+/**
+ * Lens calibration table of one camera, distortion versus focus and zoom.
+ * Samples are grouped into curves of equal focus, each sorted by zoom, so the table does not have to be a full grid:
+ * evaluation interpolates along zoom on the two curves around the focus value, then between those curves.
+ */
+class FLONET2LensTable
+{
+public:
+
+	explicit FLONET2LensTable(TArray<FLONET2LensSample>&& Samples);
+
+	/** Writes FxFy, PrincipalPoint and DistortionParameters for the given encoder values, clamped to the calibrated range. */
+	void Evaluate(float Focus, float Zoom, FLiveLinkLensFrameData& OutFrame) const;
+
+	bool IsEmpty() const { return Curves.Num() == 0; }
+
+private:
+
+	struct FCurve
+	{
+		float Focus = 0.0f;
+		TArray<FLONET2LensSample> Samples;
+	};
+
+	/** Adds Weight times the curve, interpolated at Zoom, to OutFrame. */
+	void Accumulate(const FCurve& Curve, float Zoom, float Weight, FLiveLinkLensFrameData& OutFrame) const;
+
+	static void AccumulateSample(const FLONET2LensSample& Sample, float Weight, FLiveLinkLensFrameData& OutFrame);
+
+	/** Sorted by focus. */
+	TArray<FCurve> Curves;
+
+	int32 NumParameters = 0;
+};
+
+/**
+ * Calibration tables by raw camera name and sender, as received in lens_calibration_data sections. The sender is FIPv4Address::Any
+ * unless subjects are namespaced by sender.
+ * A table is replaced whenever the sender sends it again. Only the decoding thread uses it.
+ */
+class FLONET2LensTableCache
+{
+public:
+
+	void Set(FAnsiStringView RawCameraName, const FIPv4Address& Sender, TArray<FLONET2LensSample>&& Samples);
+
+	const FLONET2LensTable* Find(FAnsiStringView RawCameraName, const FIPv4Address& Sender) const;
+
+	bool IsEmpty() const { return Tables.Num() == 0; }
+
+	void Empty();
+
+private:
+
+	struct FEntry
+	{
+		TArray<ANSICHAR> RawName;
+		FIPv4Address Sender;
+		TUniquePtr<FLONET2LensTable> Table;
+	};
+
+	static uint64 HashName(FAnsiStringView RawName, const FIPv4Address& Sender);
+
+	TMap<uint64, FEntry> Tables;
+};
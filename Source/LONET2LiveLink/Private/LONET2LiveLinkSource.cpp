@@ -7,11 +7,7 @@
 #include "Roles/LiveLinkAnimationRole.h"
 #include "Roles/LiveLinkAnimationTypes.h"
 
-#include "Async/Async.h"
-#include "Common/UdpSocketBuilder.h"
 #include "Json.h"
-#include "Sockets.h"
-#include "SocketSubsystem.h"
 #include "Misc/CoreDelegates.h"
 #include "Roles/LiveLinkCameraTypes.h"
 #include "Roles/LiveLinkCameraRole.h"
@@ -22,6 +18,31 @@
 #include "LiveLinkLensRole.h"
 #include "LiveLinkLensTypes.h"
 #include "LiveLinkLensController.h"
+#include "LONET2StreamDecoder.h"
+#include "LONET2DecodeWorker.h"
+#include "LONET2PacketPool.h"
+#include "LONET2PacketQueue.h"
+#include "LONET2Socket.h"
+#include "LONET2UdpReceiver.h"
+#include "LONET2SharedMemoryReceiver.h"
+#include "LONET2SharedMemoryRing.h"
+#include "LONET2SubjectCache.h"
+#include "LONET2SenderFilter.h"
+#include "LONET2SubjectMailbox.h"
+#include "LONET2Capture.h"
+#include "LONET2ReplayPlayer.h"
+#include "LONET2ClockEstimator.h"
+#include "LONET2JitterBuffer.h"
+#include "LONET2Stats.h"
+#include "LONET2LensTable.h"
+#include "LONET2Schema.h"
+#include "LONET2DeltaState.h"
+#include "LONET2PosePredictor.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/ScopeLock.h"
 
 
 //enable logging step 2
@@ -29,26 +50,167 @@ DEFINE_LOG_CATEGORY(ModuleLog)
 
 #define LOCTEXT_NAMESPACE "LONET2LiveLinkSource"
 
-#define RECV_BUFFER_SIZE 1024 * 1024
 
-FLONET2LiveLinkSource::FLONET2LiveLinkSource(FIPv4Endpoint InEndpoint)
-	: DeviceEndpoint(InEndpoint)
+namespace LONET2LiveLinkSource
 {
+	/** A section given as one object, or as an array of objects with one per subject. */
+	static TArray<const TSharedPtr<FJsonObject>*, TInlineAllocator<4>> GetSectionObjects(const FJsonObject& JsonObject, const TCHAR* Key)
+	{
+		TArray<const TSharedPtr<FJsonObject>*, TInlineAllocator<4>> Objects;
+		const TSharedPtr<FJsonObject>* Object;
+		const TArray<TSharedPtr<FJsonValue>>* Values;
+		if (JsonObject.TryGetObjectField(Key, Object))
+		{
+			Objects.Add(Object);
+		}
+		else if (JsonObject.TryGetArrayField(Key, Values))
+		{
+			for (const TSharedPtr<FJsonValue>& Value : *Values)
+			{
+				if (Value->TryGetObject(Object))
+				{
+					Objects.Add(Object);
+				}
+			}
+		}
+		return Objects;
+	}
+
+	/** Reads a number or number array field of the section schema from an FJsonObject section. */
+	static void ReadJsonField(const FJsonObject& Object, const LONET2Schema::FField& Field, FLiveLinkBaseFrameData& FrameData)
+	{
+		const FString Key(Field.Key);
+		const TArray<TSharedPtr<FJsonValue>>* Array;
+
+		if (Field.Target == LONET2Schema::EFieldTarget::FloatArray)
+		{
+			if (Object.TryGetArrayField(Key, Array))
+			{
+				TArray<float>& Values = LONET2Schema::GetFloatArray(Field, FrameData);
+				for (const TSharedPtr<FJsonValue>& Value : *Array)
+				{
+					Values.Push(Value->AsNumber());
+				}
+			}
+			return;
+		}
+
+		double Values[4];
+		int32 Count = 0;
+		if (Field.Count == 1)
+		{
+			Count = Object.TryGetNumberField(Key, Values[0]) ? 1 : 0;
+		}
+		else if (Object.TryGetArrayField(Key, Array))
+		{
+			Count = FMath::Min<int32>(Array->Num(), UE_ARRAY_COUNT(Values));
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				Values[Index] = (*Array)[Index]->AsNumber();
+			}
+		}
+		LONET2Schema::WriteNumbers(Field, Values, Count, FrameData);
+	}
+
+	static EThreadPriority ToThreadPriority(ELONET2ThreadPriority Priority)
+	{
+		switch (Priority)
+		{
+		case ELONET2ThreadPriority::Normal:
+			return TPri_Normal;
+		case ELONET2ThreadPriority::Highest:
+			return TPri_Highest;
+		case ELONET2ThreadPriority::TimeCritical:
+			return TPri_TimeCritical;
+		case ELONET2ThreadPriority::AboveNormal:
+		default:
+			return TPri_AboveNormal;
+		}
+	}
+}
+
+FLONET2LiveLinkSource::FLONET2LiveLinkSource(FIPv4Endpoint InEndpoint, const FLONET2LiveLinkSourceOptions& InOptions)
+	: FLONET2LiveLinkSource(TArray<FIPv4Endpoint>({ InEndpoint }), InOptions)
+{
+}
+
+FLONET2LiveLinkSource::FLONET2LiveLinkSource(TArray<FIPv4Endpoint> InEndpoints, const FLONET2LiveLinkSourceOptions& InOptions)
+	: DeviceEndpoints(MoveTemp(InEndpoints))
+	, Options(InOptions)
+	, PacketPool(MakeUnique<FLONET2PacketPool>(InOptions.MaxDatagramSize, InOptions.ReceiveBatchSize, InOptions.ReceiveBatchSize + InOptions.MaxPendingPackets + 1))
+	, StreamDecoder(MakeUnique<FLONET2StreamDecoder>())
+	, PendingPackets(MakeUnique<FLONET2PacketQueue>(*PacketPool, InOptions.MaxPendingPackets))
+	, Mailbox(MakeUnique<FLONET2SubjectMailbox>())
+	, Stats(MakeUnique<FLONET2SourceStats>())
+	, SubjectCache(MakeUnique<FLONET2SubjectCache>())
+	, LensTables(MakeUnique<FLONET2LensTableCache>())
+	, DeltaState(MakeUnique<FLONET2DeltaState>())
+	, PosePredictor(MakeUnique<FLONET2PosePredictor>())
+	, SenderFilter(MakeUnique<FLONET2SenderFilter>())
+{
+	SenderFilter->Set(Options.AllowedSenders, Options.DeniedSenders);
+	StreamDecoder->SetSubjectFilter(FLONET2StreamDecoder::FIsSubjectEnabled::CreateRaw(this, &FLONET2LiveLinkSource::IsSectionEnabled),
+		FLONET2StreamDecoder::FHasDisabledSubjects::CreateRaw(SubjectCache.Get(), &FLONET2SubjectCache::HasDisabledSubjects));
+
+	Mailbox->SetDefaultDepth(Options.FramesPerSubject);
+	for (const TPair<FName, int32>& Override : Options.FramesPerSubjectOverrides)
+	{
+		Mailbox->SetSubjectDepth(Override.Key, Override.Value);
+	}
+	ApplyPredictionOptions();
+
+	ApplyJitterBufferOptions();
+
 	SourceStatus = LOCTEXT("SourceStatus_DeviceNotFound", "Device Not Found");
 	SourceType = LOCTEXT("LONET2LiveLinkSourceType", "LONET 2 LiveLink");
-	SourceMachineName = FText::FromString(DeviceEndpoint.ToString());
+	if (!Options.ReplayFile.IsEmpty())
+	{
+		SourceMachineName = FText::FromString(FPaths::GetCleanFilename(Options.ReplayFile));
+	}
+	else if (!Options.SharedMemoryName.IsEmpty())
+	{
+		SourceMachineName = FText::FromString(TEXT("shm://") + Options.SharedMemoryName);
+	}
+	else
+	{
+		SourceMachineName = FText::FromString(EndpointsToString(DeviceEndpoints));
+	}
 
 	FCoreDelegates::OnEnginePreExit.AddRaw(this, &FLONET2LiveLinkSource::OnEnginePreExit);
 
-	if (OpenSocket())
+	if (!Options.CaptureFile.IsEmpty())
+	{
+		StartCapture(Options.CaptureFile);
+	}
+
+	if (!Options.ReplayFile.IsEmpty())
 	{
-		SourceStatus = LOCTEXT("SourceStatus_Receiving", "Receiving");
+		if (OpenReplay())
+		{
+			ConnectionStatus = LOCTEXT("SourceStatus_Replaying", "Replaying");
+			SourceStatus = ConnectionStatus;
+		}
+	}
+	else if (!Options.SharedMemoryName.IsEmpty())
+	{
+		if (OpenSharedMemory())
+		{
+			ConnectionStatus = LOCTEXT("SourceStatus_Receiving", "Receiving");
+			SourceStatus = ConnectionStatus;
+		}
+	}
+	else if (OpenSocket())
+	{
+		ConnectionStatus = LOCTEXT("SourceStatus_Receiving", "Receiving");
+		SourceStatus = ConnectionStatus;
 	}
 }
 
 FLONET2LiveLinkSource::~FLONET2LiveLinkSource()
 {
+	bShutdownRequested = true;
 	CloseSockets();
+	WaitForActiveHandlers();
 	FCoreDelegates::OnEnginePreExit.RemoveAll(this);
 }
 
@@ -62,58 +224,172 @@ bool FLONET2LiveLinkSource::OpenSocket()
 {
 	UE_LOG(ModuleLog, Warning, TEXT("Setup socket"));
 
-	if (DeviceEndpoint.Address.IsMulticastAddress())
+	// Multicast groups on the same port are joined on one socket, everything else gets a socket of its own
+	TMap<uint16, FLONET2Socket*> MulticastSockets;
+	for (const FIPv4Endpoint& Endpoint : DeviceEndpoints)
 	{
-		Socket = FUdpSocketBuilder(TEXT("LONET2SOCKET"))
-			.AsNonBlocking()
-			.AsReusable()
-			.BoundToPort(DeviceEndpoint.Port)
-			.WithReceiveBufferSize(RECV_BUFFER_SIZE)
-			.BoundToAddress(FIPv4Address::Any)
-			.JoinedToGroup(DeviceEndpoint.Address)
-			.WithMulticastLoopback()
-			.WithMulticastTtl(2);
+		const bool bMulticast = Endpoint.Address.IsMulticastAddress();
+		if (FLONET2Socket** SharedSocket = bMulticast ? MulticastSockets.Find(Endpoint.Port) : nullptr)
+		{
+			(*SharedSocket)->JoinGroup(Endpoint.Address, Options.AllowedSenders, Options.DeniedSenders);
+			continue;
+		}
+
+		TUniquePtr<FLONET2Socket> Socket = FLONET2Socket::Create(Endpoint, Options.ReceiveBufferSize, Options.AllowedSenders, Options.DeniedSenders);
+		if (!Socket.IsValid())
+		{
+			UE_LOG(ModuleLog, Error, TEXT("Failed to create UDP socket on %s"), *Endpoint.ToString());
+			continue;
+		}
+
+		if (bMulticast)
+		{
+			MulticastSockets.Add(Endpoint.Port, Socket.Get());
+		}
+		Sockets.Add(MoveTemp(Socket));
 	}
-	else
+
+	if (Sockets.Num() == 0)
 	{
-		Socket = FUdpSocketBuilder(TEXT("LONET2SOCKET"))
-			.AsNonBlocking()
-			.AsReusable()
-			.BoundToAddress(DeviceEndpoint.Address)
-			.BoundToPort(DeviceEndpoint.Port)
-			.WithReceiveBufferSize(RECV_BUFFER_SIZE);
+		return false;
 	}
 
-	if (Socket == nullptr || Socket->GetSocketType() != SOCKTYPE_Datagram)
+	StartThreads();
+	return true;
+}
+
+bool FLONET2LiveLinkSource::OpenReplay()
+{
+	ReplayReader = FLONET2CaptureReader::Open(Options.ReplayFile);
+	if (!ReplayReader.IsValid())
 	{
-		UE_LOG(ModuleLog, Error, TEXT("Failed to create UDP socket on %s"), *DeviceEndpoint.ToString());
 		return false;
 	}
 
-	const FTimespan ThreadWaitTime = FTimespan::FromMilliseconds(100);
+	StartThreads();
+	return true;
+}
 
-	UdpReceiver = MakeUnique<FUdpSocketReceiver>(Socket, ThreadWaitTime, TEXT("LONET2_UdpReceiver"));
-	UdpReceiver->OnDataReceived().BindRaw(this, &FLONET2LiveLinkSource::HandleReceivedData);
-	UdpReceiver->SetMaxReadBufferSize(RECV_BUFFER_SIZE);
-	UdpReceiver->Start();
+bool FLONET2LiveLinkSource::OpenSharedMemory()
+{
+	SharedMemoryRing = FLONET2SharedMemoryRing::Open(Options.SharedMemoryName, FLONET2SharedMemoryRing::DefaultCapacity, false);
+	if (!SharedMemoryRing.IsValid())
+	{
+		return false;
+	}
 
+	StartThreads();
 	return true;
 }
 
+bool FLONET2LiveLinkSource::UsesSockets() const
+{
+	return Options.ReplayFile.IsEmpty() && Options.SharedMemoryName.IsEmpty();
+}
+
+void FLONET2LiveLinkSource::StartThreads()
+{
+	if (bShutdownRequested || (Sockets.Num() == 0 && !ReplayReader.IsValid() && !SharedMemoryRing.IsValid()))
+	{
+		return;
+	}
+
+	if (Options.DecodeThread == ELONET2DecodeThread::DecodeThread)
+	{
+		DecodeWorker = MakeUnique<FLONET2DecodeWorker>(FLONET2DecodeWorker::FOnDrain::CreateRaw(this, &FLONET2LiveLinkSource::DrainPendingPackets), TEXT("LONET2_DecodeWorker"),
+			Options.ThreadPriority, Options.ThreadAffinityMask);
+	}
+
+	if (ReplayReader.IsValid())
+	{
+		ReplayPlayer = MakeUnique<FLONET2ReplayPlayer>(*ReplayReader, *PacketPool, Options.ReceiveBatchSize, Options.bReplayRealTime, Options.bReplayLoop,
+			FLONET2ReplayPlayer::FOnPacketsReceived::CreateRaw(this, &FLONET2LiveLinkSource::HandlePacketBatch), TEXT("LONET2_ReplayPlayer"),
+			Options.ThreadPriority, Options.ThreadAffinityMask);
+		return;
+	}
+
+	if (SharedMemoryRing.IsValid())
+	{
+		SharedMemoryReceiver = MakeUnique<FLONET2SharedMemoryReceiver>(*SharedMemoryRing, *PacketPool, FTimespan::FromMilliseconds(Options.ReceiverWaitMilliseconds),
+			Options.ReceiveBatchSize, FLONET2SharedMemoryReceiver::FOnPacketsReceived::CreateRaw(this, &FLONET2LiveLinkSource::HandlePacketBatch),
+			TEXT("LONET2_SharedMemoryReceiver"), Options.ThreadPriority, Options.ThreadAffinityMask);
+		return;
+	}
+
+	TArray<FLONET2Socket*> ReceiverSockets;
+	for (const TUniquePtr<FLONET2Socket>& Socket : Sockets)
+	{
+		ReceiverSockets.Add(Socket.Get());
+	}
+
+	UdpReceiver = MakeUnique<FLONET2UdpReceiver>(MoveTemp(ReceiverSockets), *PacketPool, FTimespan::FromMilliseconds(Options.ReceiverWaitMilliseconds), Options.ReceiveBatchSize,
+		FLONET2UdpReceiver::FOnPacketsReceived::CreateRaw(this, &FLONET2LiveLinkSource::HandlePacketBatch), TEXT("LONET2_UdpReceiver"),
+		Options.ThreadPriority, Options.ThreadAffinityMask);
+}
+
+void FLONET2LiveLinkSource::StopThreads()
+{
+	// Producers first, so nothing is queued for a decode worker that is gone
+	UdpReceiver.Reset();
+	SharedMemoryReceiver.Reset();
+	ReplayPlayer.Reset();
+	DecodeWorker.Reset();
+}
+
 void FLONET2LiveLinkSource::CloseSockets()
 {
 	// Stop receiver thread first (blocks until thread exits),
 	// then destroy socket  same order as Epic's CloseSockets().
-	UdpReceiver.Reset();
+	StopThreads();
+	PendingPackets->Empty();
+
+	Sockets.Reset();
+	SharedMemoryRing.Reset();
+	ReplayReader.Reset();
+	StopCapture();
+}
 
-	if (Socket != nullptr)
+void FLONET2LiveLinkSource::WaitForActiveHandlers()
+{
+	// Receive and decode threads are joined by now, only direct callers can still be inside, each for at most one decode
+	while (ActiveHandlers.GetValue() > 0)
 	{
-		Socket->Close();
-		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
-		Socket = nullptr;
+		FPlatformProcess::YieldThread();
 	}
 }
 
+bool FLONET2LiveLinkSource::SetEndpoints(TArray<FIPv4Endpoint> Endpoints)
+{
+	if (bShutdownRequested || !UsesSockets())
+	{
+		return false;
+	}
+
+	StopThreads();
+
+	// What the old sockets delivered is still pushed, the subjects carry on from it
+	if (HasClient())
+	{
+		DrainPendingPackets();
+	}
+	PendingPackets->Empty();
+	Sockets.Reset();
+
+	DeviceEndpoints = MoveTemp(Endpoints);
+	SourceMachineName = FText::FromString(EndpointsToString(DeviceEndpoints));
+
+	if (!OpenSocket())
+	{
+		ConnectionStatus = FText::GetEmpty();
+		SourceStatus = LOCTEXT("SourceStatus_DeviceNotFound", "Device Not Found");
+		return false;
+	}
+
+	ConnectionStatus = LOCTEXT("SourceStatus_Receiving", "Receiving");
+	SourceStatus = ConnectionStatus;
+	return true;
+}
+
 void FLONET2LiveLinkSource::OnSettingsChanged(ULiveLinkSourceSettings* Settings, const FPropertyChangedEvent& PropertyChangedEvent)
 {
 	ILiveLinkSource::OnSettingsChanged(Settings, PropertyChangedEvent);
@@ -122,13 +398,165 @@ void FLONET2LiveLinkSource::OnSettingsChanged(ULiveLinkSourceSettings* Settings,
 	FProperty* Property = PropertyChangedEvent.Property;
 	if (Property && MemberProperty && (PropertyChangedEvent.ChangeType != EPropertyChangeType::Interactive))
 	{
+		if (const ULONET2LiveLinkSourceSettings* LONET2Settings = Cast<ULONET2LiveLinkSourceSettings>(Settings))
+		{
+			ApplySettings(*LONET2Settings);
 
+			// Presets recreate the source from the connection string
+			if (MemberProperty->GetFName() == GET_MEMBER_NAME_CHECKED(ULONET2LiveLinkSourceSettings, Endpoints) && UsesSockets())
+			{
+				Settings->ConnectionString = EndpointsToString(DeviceEndpoints);
+			}
+		}
 	}
 }
 
 void FLONET2LiveLinkSource::InitializeSettings(ULiveLinkSourceSettings* Settings)
 {
-	
+	// New sources get default settings, sources loaded from a preset get the saved ones
+	if (ULONET2LiveLinkSourceSettings* LONET2Settings = Cast<ULONET2LiveLinkSourceSettings>(Settings))
+	{
+		if (LONET2Settings->Endpoints.IsEmpty() && UsesSockets())
+		{
+			LONET2Settings->Endpoints = EndpointsToString(DeviceEndpoints);
+		}
+		if (LONET2Settings->CaptureFile.IsEmpty())
+		{
+			LONET2Settings->CaptureFile = Options.CaptureFile;
+		}
+		ApplySettings(*LONET2Settings);
+	}
+}
+
+void FLONET2LiveLinkSource::ApplySettings(const ULONET2LiveLinkSourceSettings& Settings)
+{
+	// Multicast groups are joined with the sender lists, so a change rejoins them
+	bool bRejoin = false;
+	TArray<FIPv4Address> AllowedSenders, DeniedSenders;
+	if (!FLONET2SenderFilter::ParseAddresses(Settings.AllowedSenders, AllowedSenders) || !FLONET2SenderFilter::ParseAddresses(Settings.DeniedSenders, DeniedSenders))
+	{
+		UE_LOG(ModuleLog, Warning, TEXT("Ignoring invalid LONET 2 sender lists \"%s\" and \"%s\""), *Settings.AllowedSenders, *Settings.DeniedSenders);
+	}
+	else if (AllowedSenders != Options.AllowedSenders || DeniedSenders != Options.DeniedSenders)
+	{
+		Options.AllowedSenders = MoveTemp(AllowedSenders);
+		Options.DeniedSenders = MoveTemp(DeniedSenders);
+		SenderFilter->Set(Options.AllowedSenders, Options.DeniedSenders);
+		bRejoin = DeviceEndpoints.ContainsByPredicate([](const FIPv4Endpoint& Endpoint) { return Endpoint.Address.IsMulticastAddress(); });
+	}
+
+	TArray<FIPv4Endpoint> Endpoints = DeviceEndpoints;
+	if (UsesSockets() && !Settings.Endpoints.IsEmpty())
+	{
+		if (!ParseEndpoints(Settings.Endpoints, Endpoints) || Endpoints.Num() == 0)
+		{
+			UE_LOG(ModuleLog, Warning, TEXT("Ignoring invalid LONET 2 endpoints \"%s\""), *Settings.Endpoints);
+			Endpoints = DeviceEndpoints;
+		}
+	}
+	if (UsesSockets() && (bRejoin || Endpoints != DeviceEndpoints))
+	{
+		SetEndpoints(MoveTemp(Endpoints));
+	}
+
+	// Only a change starts a recording, so other setting changes do not replace the file being written
+	const FString CaptureFile = Settings.CaptureFile.TrimStartAndEnd().TrimQuotes();
+	if (CaptureFile != Options.CaptureFile)
+	{
+		Options.CaptureFile = CaptureFile;
+		if (Options.CaptureFile.IsEmpty())
+		{
+			StopCapture();
+		}
+		else if (!bShutdownRequested)
+		{
+			StartCapture(Options.CaptureFile);
+		}
+	}
+
+	if (Settings.bSubjectsPerSender != Options.bSubjectsPerSender)
+	{
+		SetSubjectsPerSender(Settings.bSubjectsPerSender);
+	}
+
+	Options.FramesPerSubject = Settings.FramesPerSubject;
+	Options.FramesPerSubjectOverrides = Settings.FramesPerSubjectOverrides;
+	Mailbox->SetDefaultDepth(Options.FramesPerSubject);
+	Mailbox->ResetSubjectDepths();
+	for (const TPair<FName, int32>& Override : Options.FramesPerSubjectOverrides)
+	{
+		Mailbox->SetSubjectDepth(Override.Key, Override.Value);
+	}
+
+	if (Settings.JitterBufferFrames != Options.JitterBufferFrames || Settings.JitterBufferMilliseconds != Options.JitterBufferMilliseconds)
+	{
+		Options.JitterBufferFrames = Settings.JitterBufferFrames;
+		Options.JitterBufferMilliseconds = Settings.JitterBufferMilliseconds;
+		ApplyJitterBufferOptions();
+	}
+
+	Options.SubjectIdleTimeout = Settings.SubjectIdleTimeout;
+
+	Options.PredictionMilliseconds = Settings.PredictionMilliseconds;
+	Options.PredictionMillisecondsOverrides = Settings.PredictionMillisecondsOverrides;
+	ApplyPredictionOptions();
+
+	if (Settings.ReceiveBufferSize != Options.ReceiveBufferSize)
+	{
+		Options.ReceiveBufferSize = Settings.ReceiveBufferSize;
+		for (const TUniquePtr<FLONET2Socket>& Socket : Sockets)
+		{
+			Socket->SetReceiveBufferSize(Options.ReceiveBufferSize);
+		}
+	}
+
+	Options.ReceiverWaitMilliseconds = Settings.ReceiverWaitMilliseconds;
+	Options.ThreadPriority = LONET2LiveLinkSource::ToThreadPriority(Settings.ThreadPriority);
+	Options.ThreadAffinityMask = static_cast<uint64>(Settings.ThreadAffinityMask);
+
+	if (Settings.DecodeThread != Options.DecodeThread)
+	{
+		StopThreads();
+		Options.DecodeThread = Settings.DecodeThread;
+
+		// Nothing else runs until the threads restart, so what the old decode stage left queued is decoded here
+		if (HasClient())
+		{
+			DrainPendingPackets();
+		}
+		PendingPackets->Empty();
+
+		StartThreads();
+		return;
+	}
+
+	FLONET2Runnable* const Threads[] = { UdpReceiver.Get(), SharedMemoryReceiver.Get(), ReplayPlayer.Get(), DecodeWorker.Get() };
+	for (FLONET2Runnable* Thread : Threads)
+	{
+		if (Thread != nullptr)
+		{
+			Thread->SetThreadPriority(Options.ThreadPriority);
+			Thread->SetThreadAffinityMask(Options.ThreadAffinityMask);
+		}
+	}
+	if (UdpReceiver.IsValid())
+	{
+		UdpReceiver->SetWaitTime(FTimespan::FromMilliseconds(Options.ReceiverWaitMilliseconds));
+	}
+	if (SharedMemoryReceiver.IsValid())
+	{
+		SharedMemoryReceiver->SetWaitTime(FTimespan::FromMilliseconds(Options.ReceiverWaitMilliseconds));
+	}
+}
+
+void FLONET2LiveLinkSource::ApplyPredictionOptions()
+{
+	PosePredictor->SetDefaultLookAhead(Options.PredictionMilliseconds / 1000.0);
+	PosePredictor->ResetSubjectLookAheads();
+	for (const TPair<FName, float>& Override : Options.PredictionMillisecondsOverrides)
+	{
+		PosePredictor->SetSubjectLookAhead(Override.Key, Override.Value / 1000.0);
+	}
 }
 
 void FLONET2LiveLinkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
@@ -139,7 +567,7 @@ void FLONET2LiveLinkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSou
 
 bool FLONET2LiveLinkSource::IsSourceStillValid() const
 {
-	return !bShutdownRequested && Socket != nullptr;
+	return !bShutdownRequested && (Sockets.Num() > 0 || SharedMemoryRing.IsValid() || ReplayReader.IsValid());
 }
 
 bool FLONET2LiveLinkSource::RequestSourceShutdown()
@@ -147,16 +575,52 @@ bool FLONET2LiveLinkSource::RequestSourceShutdown()
 
 	bShutdownRequested = true;
 
-	if (Client != nullptr)
+	// Join the receive threads first so nothing registers a subject while they are removed
+	CloseSockets();
+	WaitForActiveHandlers();
+
+	RemoveAllSubjects();
+	return true;
+}
+
+void FLONET2LiveLinkSource::RemoveAllSubjects()
+{
+	TArray<FLiveLinkSubjectKey> SubjectKeys;
+	SubjectCache->Empty(SubjectKeys);
+	if (HasClient())
 	{
-		for (const FName& SubjectName : EncounteredSubjects)
+		for (const FLiveLinkSubjectKey& SubjectKey : SubjectKeys)
 		{
-			Client->RemoveSubject_AnyThread({ SourceGuid, SubjectName });
+			RemoveSubject(SubjectKey);
 		}
-		EncounteredSubjects.Empty();
 	}
-	CloseSockets();
-	return true;
+	Mailbox->Empty();
+	Stats->Empty();
+	if (JitterBuffer.IsValid())
+	{
+		JitterBuffer->Empty();
+	}
+	SenderClocks.Empty();
+	LensTables->Empty();
+	DeltaState->Empty();
+	PosePredictor->Empty();
+}
+
+void FLONET2LiveLinkSource::SetSubjectsPerSender(bool bSubjectsPerSender)
+{
+	StopThreads();
+
+	// What is queued was received under the old names
+	if (HasClient())
+	{
+		DrainPendingPackets();
+	}
+	PendingPackets->Empty();
+
+	RemoveAllSubjects();
+	Options.bSubjectsPerSender = bSubjectsPerSender;
+
+	StartThreads();
 }
 
 void FLONET2LiveLinkSource::Update()
@@ -165,285 +629,785 @@ void FLONET2LiveLinkSource::Update()
 	{
 		CloseSockets();
 		SourceStatus = LOCTEXT("SourceStatus_ShutDown", "Shut Down");
+		return;
+	}
+
+	if (Options.DecodeThread == ELONET2DecodeThread::GameThread && HasClient())
+	{
+		DrainPendingPackets();
+	}
+
+	// Frames fall due between packets too, so the game tick releases them as well as every decode pass
+	if (JitterBuffer.IsValid() && HasClient())
+	{
+		ReleaseJitterBuffer();
+	}
+
+	if (ReplayPlayer.IsValid() && ReplayPlayer->IsFinished())
+	{
+		ConnectionStatus = LOCTEXT("SourceStatus_ReplayFinished", "Replay Finished");
 	}
+
+	RemoveIdleSubjects();
+	RefreshEnabledSubjects();
+	UpdateSourceStatus();
 }
 
-void FLONET2LiveLinkSource::HandleReceivedData(const TSharedPtr<FArrayReader, ESPMode::ThreadSafe>& Data, const FIPv4Endpoint& Sender)
+void FLONET2LiveLinkSource::RefreshEnabledSubjects()
 {
-	if (bShutdownRequested || !Data.IsValid() || Client == nullptr)
+	const double Now = FPlatformTime::Seconds();
+	if (!HasClient() || Now - LastEnabledCheckTime < 0.25)
 	{
 		return;
 	}
+	LastEnabledCheckTime = Now;
 
-	TSharedPtr<FArrayReader, ESPMode::ThreadSafe> DataCopy = Data;
-	AsyncTask(ENamedThreads::GameThread, [this, DataCopy]()
+	SubjectCache->RefreshEnabled([this](const FLiveLinkSubjectKey& SubjectKey)
 		{
-			if (bShutdownRequested || Client == nullptr) { return; }
-			ProcessJsonData(*DataCopy);
+			return IsSubjectEnabled(SubjectKey);
 		});
 }
 
-void FLONET2LiveLinkSource::ProcessJsonData(const TArray<uint8>& RawData)
+bool FLONET2LiveLinkSource::IsSectionEnabled(ELONET2Section Section, FAnsiStringView RawName)
 {
+	return SubjectCache->IsEnabled(Section, RawName, PacketSubjectSender, PacketReceiveTime);
+}
 
-	FString JsonString;
-	FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(RawData.GetData()), RawData.Num());
-	JsonString = FString(Converter.Length(), Converter.Get());
+void FLONET2LiveLinkSource::RemoveIdleSubjects()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Options.SubjectIdleTimeout <= 0.0f || Now - LastIdleCheckTime < 1.0)
+	{
+		return;
+	}
+	LastIdleCheckTime = Now;
 
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+	TArray<FLiveLinkSubjectKey> SubjectKeys;
+	SubjectCache->RemoveIdle(Now, Options.SubjectIdleTimeout, SubjectKeys);
+	if (SubjectKeys.Num() == 0)
+	{
+		return;
+	}
 
-	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	for (const FLiveLinkSubjectKey& SubjectKey : SubjectKeys)
+	{
+		UE_LOG(ModuleLog, Log, TEXT("LONET 2 subject %s idle for %.0f seconds, removed"), *SubjectKey.SubjectName.ToString(), Options.SubjectIdleTimeout);
+
+		if (HasClient())
+		{
+			RemoveSubject(SubjectKey);
+		}
+		Mailbox->Remove(SubjectKey.SubjectName);
+		if (JitterBuffer.IsValid())
+		{
+			JitterBuffer->Remove(SubjectKey.SubjectName);
+		}
+		Stats->RemoveSubject(SubjectKey.SubjectName);
+		PosePredictor->Remove(SubjectKey.SubjectName);
+	}
+
+	// A subject that sent again since it was found idle was registered anew, before LiveLink removed it
+	SubjectCache->ResendStaticData(SubjectKeys);
+
+	FScopeLock Lock(&IdleSubjectsLock);
+	for (const FLiveLinkSubjectKey& SubjectKey : SubjectKeys)
+	{
+		IdleSubjects.Add(SubjectKey.SubjectName);
+	}
+	bHasIdleSubjects = true;
+}
+
+void FLONET2LiveLinkSource::ForgetIdleSubjects()
+{
+	if (!bHasIdleSubjects)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&IdleSubjectsLock);
+	for (const FName SubjectName : IdleSubjects)
+	{
+		DeltaState->Remove(SubjectName);
+	}
+	IdleSubjects.Reset();
+	bHasIdleSubjects = false;
+
+	// A sender gone this long took its subjects with it, so this pass runs whenever one of its clocks could be stale
+	const double Now = FPlatformTime::Seconds();
+	for (auto It = SenderClocks.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().LastSeen >= Options.SubjectIdleTimeout)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FLONET2LiveLinkSource::UpdateSourceStatus()
+{
+	if (ConnectionStatus.IsEmpty() || !Stats->Tick(FPlatformTime::Seconds()))
 	{
 		return;
 	}
 
-	//Encoders
-	const TSharedPtr<FJsonObject>* EncoderObject;
-	bool bHasEncoderData = JsonObject->TryGetObjectField("encoder_data", EncoderObject);
-	if (bHasEncoderData) {
-		FString tmpName = EncoderObject->Get()->GetStringField("cameraName") + " Encoders";
-		FName SubjectName(tmpName);
+	const FLONET2SourceStats::FRates Rates = Stats->GetTotalRates();
+
+	FNumberFormattingOptions OneDecimal;
+	OneDecimal.SetMaximumFractionalDigits(1);
+	FNumberFormattingOptions NoDecimals;
+	NoDecimals.SetMaximumFractionalDigits(0);
+
+	FFormatOrderedArguments Arguments;
+	Arguments.Add(ConnectionStatus);
+	Arguments.Add(FText::AsNumber(Rates.PacketsPerSecond, &NoDecimals));
+	Arguments.Add(FText::AsNumber(Rates.BytesPerSecond / 1024.0, &OneDecimal));
+	Arguments.Add(FText::AsNumber(Rates.DecodeMicrosecondsPerPacket, &OneDecimal));
+	Arguments.Add(FText::AsNumber(GetDroppedPacketCount() + GetLateFrameCount() + GetDroppedDeltaCount()));
+	Arguments.Add(FText::AsNumber(Rates.MalformedPerSecond, &NoDecimals));
+	Arguments.Add(FText::AsNumber(Rates.TimecodeGapsPerSecond, &NoDecimals));
+	SourceStatus = FText::Format(LOCTEXT("SourceStatus_Rates", "{0}: {1} pkt/s, {2} KB/s, {3} us/pkt, {4} dropped, {5} malformed/s, {6} gaps/s"), Arguments);
+
+	if (SenderFilter->IsEnabled())
+	{
+		SourceStatus = FText::Format(LOCTEXT("SourceStatus_Rejected", "{0}, {1} from other senders"), SourceStatus, FText::AsNumber(GetRejectedSenderCount()));
+	}
+
+	if (PosePredictor->IsEnabled())
+	{
+		SourceStatus = FText::Format(LOCTEXT("SourceStatus_Prediction", "{0}, {1} cm / {2} deg prediction error"),
+			SourceStatus, FText::AsNumber(Rates.PredictionErrorCentimeters, &OneDecimal), FText::AsNumber(Rates.PredictionErrorDegrees, &OneDecimal));
+	}
+}
+
+void FLONET2LiveLinkSource::PushSubjectStaticData(const FLiveLinkSubjectKey& SubjectKey, TSubclassOf<ULiveLinkRole> Role, FLiveLinkStaticDataStruct&& StaticData)
+{
+	Client->PushSubjectStaticData_AnyThread(SubjectKey, Role, MoveTemp(StaticData));
+}
 
-		if (!EncounteredSubjects.Contains(SubjectName)) {
-			FLiveLinkStaticDataStruct StaticDataStruct = FLiveLinkStaticDataStruct(FLiveLinkCameraStaticData::StaticStruct());
-			FLiveLinkCameraStaticData& CameraData = *StaticDataStruct.Cast<FLiveLinkCameraStaticData>();
-			CameraData.bIsAspectRatioSupported = false;
-			CameraData.bIsFieldOfViewSupported = false;
-			CameraData.bIsFocalLengthSupported = true;
-			CameraData.bIsApertureSupported = true;
-			CameraData.bIsFocusDistanceSupported = true;
-			CameraData.bIsLocationSupported = false;
-			CameraData.bIsScaleSupported = false;
-			CameraData.bIsRotationSupported = false;
+void FLONET2LiveLinkSource::PushSubjectFrameData(const FLiveLinkSubjectKey& SubjectKey, FLiveLinkFrameDataStruct&& FrameData)
+{
+	Client->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameData));
+}
 
-			Client->PushSubjectStaticData_AnyThread({ SourceGuid, SubjectName }, ULiveLinkCameraRole::StaticClass(), MoveTemp(StaticDataStruct));
-			EncounteredSubjects.Add(SubjectName);
+void FLONET2LiveLinkSource::RemoveSubject(const FLiveLinkSubjectKey& SubjectKey)
+{
+	Client->RemoveSubject_AnyThread(SubjectKey);
+}
+
+bool FLONET2LiveLinkSource::IsSubjectEnabled(const FLiveLinkSubjectKey& SubjectKey) const
+{
+	return Client->IsSubjectEnabled(SubjectKey, false);
+}
+
+bool FLONET2LiveLinkSource::ParseEndpoints(const FString& String, TArray<FIPv4Endpoint>& OutEndpoints)
+{
+	TArray<FString> Entries;
+	String.Replace(TEXT(";"), TEXT(",")).ParseIntoArray(Entries, TEXT(","));
+
+	OutEndpoints.Reset(Entries.Num());
+	for (const FString& Entry : Entries)
+	{
+		FIPv4Endpoint Endpoint;
+		if (!FIPv4Endpoint::Parse(Entry.TrimStartAndEnd(), Endpoint))
+		{
+			return false;
 		}
+		OutEndpoints.AddUnique(Endpoint);
+	}
+	return OutEndpoints.Num() > 0;
+}
 
-		FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkCameraFrameData::StaticStruct());
-		FLiveLinkCameraFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkCameraFrameData>();
+FString FLONET2LiveLinkSource::EndpointsToString(TConstArrayView<FIPv4Endpoint> Endpoints)
+{
+	FString Result;
+	for (const FIPv4Endpoint& Endpoint : Endpoints)
+	{
+		if (!Result.IsEmpty())
+		{
+			Result += TEXT(", ");
+		}
+		Result += Endpoint.ToString();
+	}
+	return Result;
+}
 
-		double focalLengthMapped = 0.0, irisMapped = 0.0, focusMapped = 0.0, frameRate = 24.0;
-		EncoderObject->Get()->TryGetNumberField(TEXT("focalLengthMapped"), focalLengthMapped);
-		EncoderObject->Get()->TryGetNumberField(TEXT("irisMapped"), irisMapped);
-		EncoderObject->Get()->TryGetNumberField(TEXT("focusMapped"), focusMapped);
-		EncoderObject->Get()->TryGetNumberField(TEXT("frameRate"), frameRate);
+bool FLONET2LiveLinkSource::ParseSharedMemoryName(const FString& String, FString& OutName)
+{
+	const FString Trimmed = String.TrimStartAndEnd();
+	if (!Trimmed.StartsWith(TEXT("shm://")))
+	{
+		return false;
+	}
 
-		FString timecodeToSplit;
-		if (EncoderObject->Get()->TryGetStringField(TEXT("timecode"), timecodeToSplit)) {
-			FrameData.MetaData.SceneTime = LoledUtilities::timeFromTimecodeString(timecodeToSplit, frameRate);
+	// Becomes /Name under /dev/shm, so no separators and nothing the shell would trip over
+	OutName = Trimmed.RightChop(6);
+	for (const TCHAR Character : OutName)
+	{
+		if (!FChar::IsAlnum(Character) && Character != TEXT('_') && Character != TEXT('-') && Character != TEXT('.'))
+		{
+			return false;
 		}
+	}
+	return !OutName.IsEmpty() && OutName.Len() < 200 && OutName[0] != TEXT('.');
+}
 
-		FrameData.Aperture = irisMapped;
-		FrameData.FocalLength = focalLengthMapped;
-		FrameData.FocusDistance = focusMapped;
+uint64 FLONET2LiveLinkSource::GetSupersededFrameCount() const
+{
+	return Mailbox->GetSupersededCount();
+}
 
-		Client->PushSubjectFrameData_AnyThread({ SourceGuid, SubjectName }, MoveTemp(FrameDataStruct));
+uint64 FLONET2LiveLinkSource::GetDroppedPacketCount() const
+{
+	return PendingPackets->GetDroppedCount() + (SharedMemoryRing.IsValid() ? SharedMemoryRing->GetLostCount() : 0);
+}
+
+uint64 FLONET2LiveLinkSource::GetReorderedFrameCount() const
+{
+	return JitterBuffer.IsValid() ? JitterBuffer->GetReorderedCount() : 0;
+}
+
+uint64 FLONET2LiveLinkSource::GetLateFrameCount() const
+{
+	return JitterBuffer.IsValid() ? JitterBuffer->GetLateCount() : 0;
+}
+
+uint64 FLONET2LiveLinkSource::GetDroppedDeltaCount() const
+{
+	return DeltaState->GetGapCount() + DeltaState->GetStaleCount();
+}
+
+uint64 FLONET2LiveLinkSource::GetRejectedSenderCount() const
+{
+	return SenderFilter->GetRejectedCount();
+}
+
+bool FLONET2LiveLinkSource::StartCapture(const FString& Filename)
+{
+	TUniquePtr<FLONET2CaptureWriter> Writer = FLONET2CaptureWriter::Create(Filename);
+	const bool bStarted = Writer.IsValid();
+
+	// The previous capture is closed outside the lock, its last write must not hold up the receive path
+	{
+		FScopeLock Lock(&CaptureLock);
+		Swap(CaptureWriter, Writer);
+		bCapturing = bStarted;
 	}
+	Writer.Reset();
+	return bStarted;
+}
 
-	////distortion
-	const TSharedPtr<FJsonObject>* DistortionObject;
-	bool bHasDistortionData = JsonObject->TryGetObjectField("distortion_data", DistortionObject);
-	if (bHasDistortionData) {
-		FString tmpName = DistortionObject->Get()->GetStringField("cameraName") + " Lens";
-		FName SubjectName(tmpName);
+void FLONET2LiveLinkSource::StopCapture()
+{
+	TUniquePtr<FLONET2CaptureWriter> Writer;
+	{
+		FScopeLock Lock(&CaptureLock);
+		bCapturing = false;
+		Swap(CaptureWriter, Writer);
+	}
+	Writer.Reset();
+}
 
-		if (!EncounteredSubjects.Contains(SubjectName)) {
-			FLiveLinkStaticDataStruct DistortionDataStaticStruct = FLiveLinkStaticDataStruct(FLiveLinkLensStaticData::StaticStruct());
-			FLiveLinkLensStaticData& DistortionData = *DistortionDataStaticStruct.Cast<FLiveLinkLensStaticData>();
+void FLONET2LiveLinkSource::HandleReceivedData(const TSharedPtr<FArrayReader, ESPMode::ThreadSafe>& Data, const FIPv4Endpoint& Sender)
+{
+	ActiveHandlers.Increment();
+	ON_SCOPE_EXIT
+	{
+		ActiveHandlers.Decrement();
+	};
 
-			DistortionData.bIsAspectRatioSupported = false;
-			DistortionData.bIsFieldOfViewSupported = false;
-			DistortionData.bIsFocalLengthSupported = true;
-			DistortionData.bIsApertureSupported = true;
-			DistortionData.bIsFocusDistanceSupported = true;
-			DistortionData.bIsLocationSupported = false;
-			DistortionData.bIsScaleSupported = false;
-			DistortionData.bIsRotationSupported = false;
-			DistortionData.LensModel = "spherical";
+	if (bShutdownRequested || !Data.IsValid() || !HasClient())
+	{
+		return;
+	}
 
-			Client->PushSubjectStaticData_AnyThread({ SourceGuid, SubjectName }, ULiveLinkLensRole::StaticClass(), MoveTemp(DistortionDataStaticStruct));
-			EncounteredSubjects.Add(SubjectName);
-		}
+	FLONET2Packet* Packet = PacketPool->Acquire();
+	if (Packet == nullptr)
+	{
+		return;
+	}
+
+	Packet->Data.SetNumUninitialized(Data->Num(), false);
+	FMemory::Memcpy(Packet->Data.GetData(), Data->GetData(), Data->Num());
+	Packet->Sender = Sender;
+	Packet->ReceiveTime = FPlatformTime::Seconds();
 
-		FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkLensFrameData::StaticStruct());
-		FLiveLinkLensFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkLensFrameData>();
+	HandlePacketBatch(MakeArrayView(&Packet, 1));
+}
 
-		double focalLengthMapped = 0.0, irisMapped = 0.0, focusMapped = 0.0, frameRate = 24.0;
-		const TArray<TSharedPtr<FJsonValue>>* fXfY;
-		const TArray<TSharedPtr<FJsonValue>>* principalPoint;
-		const TArray<TSharedPtr<FJsonValue>>* distortionParameters;
+void FLONET2LiveLinkSource::HandlePacketBatch(TArrayView<FLONET2Packet*> Packets)
+{
+	// Counted before the shutdown check, so a shutdown either sees this call or this call sees the shutdown
+	ActiveHandlers.Increment();
+	ON_SCOPE_EXIT
+	{
+		ActiveHandlers.Decrement();
+	};
 
-		if (DistortionObject->Get()->TryGetArrayField("fXfY", fXfY) && fXfY->Num() >= 2) {
-			FrameData.FxFy[0] = (*fXfY)[0]->AsNumber();
-			FrameData.FxFy[1] = (*fXfY)[1]->AsNumber();
+	if (bShutdownRequested || !HasClient())
+	{
+		for (FLONET2Packet* Packet : Packets)
+		{
+			PacketPool->Release(Packet);
 		}
+		return;
+	}
 
-		if (DistortionObject->Get()->TryGetArrayField("principalPoint", principalPoint) && principalPoint->Num() >= 2) {
-			FrameData.PrincipalPoint[0] = (*principalPoint)[0]->AsNumber();
-			FrameData.PrincipalPoint[1] = (*principalPoint)[1]->AsNumber();
+	// Unwanted senders cost this check only, they are never captured, queued or decoded. Shared memory has no network senders to filter.
+	if (!SharedMemoryRing.IsValid())
+	{
+		Packets = MakeArrayView(Packets.GetData(), SenderFilter->Filter(Packets, *PacketPool));
+		if (Packets.Num() == 0)
+		{
+			return;
 		}
+	}
 
-		if (DistortionObject->Get()->TryGetArrayField("distortionParameters", distortionParameters)) {
-			for (const auto& val : *distortionParameters) {
-				FrameData.DistortionParameters.Push(val->AsNumber());
-			}
+	if (bCapturing)
+	{
+		FScopeLock Lock(&CaptureLock);
+		if (CaptureWriter.IsValid())
+		{
+			CaptureWriter->Write(Packets);
 		}
+	}
 
-		DistortionObject->Get()->TryGetNumberField(TEXT("focalLengthMapped"), focalLengthMapped);
-		DistortionObject->Get()->TryGetNumberField(TEXT("irisMapped"), irisMapped);
-		DistortionObject->Get()->TryGetNumberField(TEXT("focusMapped"), focusMapped);
-		DistortionObject->Get()->TryGetNumberField(TEXT("frameRate"), frameRate);
+	if (Options.DecodeThread == ELONET2DecodeThread::ReceiverThread)
+	{
+		// Decode the whole batch before pushing, so a subject that appears several times in it is pushed once
+		FScopeLock Lock(&DecodeLock);
+		for (FLONET2Packet* Packet : Packets)
+		{
+			ProcessPacket(*Packet);
+			PacketPool->Release(Packet);
+		}
+		FlushMailbox();
+		return;
+	}
 
-		FString timecodeToSplit;
-		DistortionObject->Get()->TryGetStringField(TEXT("timecode"), timecodeToSplit);
+	// The game thread picks the queue up in Update(), the decode worker as soon as it is woken
+	for (FLONET2Packet* Packet : Packets)
+	{
+		PendingPackets->Push(Packet);
+	}
+	if (DecodeWorker.IsValid())
+	{
+		DecodeWorker->Wake();
+	}
+}
 
-		FrameData.Aperture = irisMapped;
-		FrameData.FocalLength = focalLengthMapped;
-		FrameData.FocusDistance = focusMapped;
-		FrameData.ProjectionMode = ELiveLinkCameraProjectionMode::Perspective;
+void FLONET2LiveLinkSource::DrainPendingPackets()
+{
+	if (bShutdownRequested || !HasClient())
+	{
+		return;
+	}
 
-		FrameData.MetaData.SceneTime = LoledUtilities::timeFromTimecodeString(timecodeToSplit, frameRate);
-		Client->PushSubjectFrameData_AnyThread({ SourceGuid, SubjectName }, MoveTemp(FrameDataStruct));
+	// Decode everything that is queued before pushing, so frames superseded within the backlog are never pushed
+	FScopeLock Lock(&DecodeLock);
+	while (FLONET2Packet* Packet = PendingPackets->Pop())
+	{
+		ProcessPacket(*Packet);
+		PacketPool->Release(Packet);
 	}
 
-	////camera
-	const TSharedPtr<FJsonObject>* CameraObject;
-	bool bHasCameraData = JsonObject->TryGetObjectField("camera_transform_data", CameraObject);
-	if (bHasCameraData) {
-		FString camName = CameraObject->Get()->GetStringField("cameraName");
-		FName SubjectName(camName);
+	FlushMailbox();
+}
 
-		if (!EncounteredSubjects.Contains(SubjectName)) {
-			FLiveLinkStaticDataStruct CameraDataStaticStruct = FLiveLinkStaticDataStruct(FLiveLinkCameraStaticData::StaticStruct());
-			FLiveLinkCameraStaticData& CameraData = *CameraDataStaticStruct.Cast<FLiveLinkCameraStaticData>();
+void FLONET2LiveLinkSource::FlushMailbox()
+{
+	SCOPE_CYCLE_COUNTER(STAT_LONET2_Push);
 
-			CameraData.bIsLocationSupported = true;
-			CameraData.bIsScaleSupported = false;
-			CameraData.bIsRotationSupported = true;
-			CameraData.bIsFocalLengthSupported = true;
-			CameraData.bIsApertureSupported = true;
-			CameraData.bIsFocusDistanceSupported = true;
+	if (JitterBuffer.IsValid())
+	{
+		ReleaseJitterBuffer();
+	}
+
+	Mailbox->Flush([this](FName SubjectName, FLiveLinkFrameDataStruct&& FrameData)
+		{
+			INC_DWORD_STAT(STAT_LONET2_FramesPushed);
+			PushSubjectFrameData({ SourceGuid, SubjectName }, MoveTemp(FrameData));
+		});
+}
 
-			CameraData.PropertyNames.SetNumUninitialized(6);
-			CameraData.PropertyNames[0] = FName("whiteBalance");
-			CameraData.PropertyNames[1] = FName("tint");
-			CameraData.PropertyNames[2] = FName("ISO");
-			CameraData.PropertyNames[3] = FName("shutter");
-			CameraData.PropertyNames[4] = FName("sensorX");
-			CameraData.PropertyNames[5] = FName("sensorY");
+void FLONET2LiveLinkSource::ReleaseJitterBuffer()
+{
+	SCOPE_CYCLE_COUNTER(STAT_LONET2_Push);
 
-			Client->PushSubjectStaticData_AnyThread({ SourceGuid, SubjectName }, ULiveLinkCameraRole::StaticClass(), MoveTemp(CameraDataStaticStruct));
-			EncounteredSubjects.Add(SubjectName);
-		}
+	JitterBuffer->Release(FPlatformTime::Seconds(), [this](FName SubjectName, FLiveLinkFrameDataStruct&& FrameData)
+		{
+			INC_DWORD_STAT(STAT_LONET2_FramesPushed);
+			PushSubjectFrameData({ SourceGuid, SubjectName }, MoveTemp(FrameData));
+		});
+}
+
+void FLONET2LiveLinkSource::ApplyJitterBufferOptions()
+{
+	const bool bEnabled = Options.JitterBufferFrames > 0 || Options.JitterBufferMilliseconds > 0.0f;
+	if (JitterBuffer.IsValid() && bEnabled)
+	{
+		JitterBuffer->SetDelay(Options.JitterBufferFrames, Options.JitterBufferMilliseconds / 1000.0);
+		return;
+	}
+	if (JitterBuffer.IsValid() == bEnabled)
+	{
+		return;
+	}
+
+	// The decoding threads insert into the buffer, it only comes and goes while they are stopped
+	const bool bRestartThreads = UdpReceiver.IsValid() || SharedMemoryReceiver.IsValid() || ReplayPlayer.IsValid() || DecodeWorker.IsValid();
+	StopThreads();
+	WaitForActiveHandlers();
+
+	if (bEnabled)
+	{
+		JitterBuffer = MakeUnique<FLONET2JitterBuffer>(Options.JitterBufferFrames, Options.JitterBufferMilliseconds / 1000.0);
+	}
+	else
+	{
+		// Held frames are not lost, they go out with the next push in timecode order
+		JitterBuffer->Release(TNumericLimits<double>::Max(), [this](FName SubjectName, FLiveLinkFrameDataStruct&& FrameData)
+			{
+				Mailbox->Post(SubjectName, MoveTemp(FrameData));
+			});
+		JitterBuffer.Reset();
+	}
+
+	if (bRestartThreads)
+	{
+		StartThreads();
+	}
+}
+
+void FLONET2LiveLinkSource::QueueFrame(FName SubjectName, FLiveLinkFrameDataStruct&& FrameData, bool bHasSceneTime, bool bMalformedTimecode)
+{
+	const FLiveLinkBaseFrameData& BaseData = *FrameData.GetBaseData();
+	Stats->AddFrame(SubjectName, BaseData.MetaData.SceneTime, bHasSceneTime, bMalformedTimecode);
 
-		FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkCameraFrameData::StaticStruct());
-		FLiveLinkCameraFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkCameraFrameData>();
+	StampWorldTime(*FrameData.GetBaseData(), bHasSceneTime);
 
-		double focalLengthRaw = 0.0, irisRaw = 0.0, focusRaw = 0.0;
-		double whiteBalance = 0.0, tint = 0.0, ISO = 0.0, shutter = 0.0, frameRate = 24.0;
+	if (JitterBuffer.IsValid() && bHasSceneTime)
+	{
+		JitterBuffer->Insert(SubjectName, MoveTemp(FrameData));
+		return;
+	}
+	Mailbox->Post(SubjectName, MoveTemp(FrameData));
+}
+
+void FLONET2LiveLinkSource::PredictPose(FName SubjectName, FLiveLinkCameraFrameData& FrameData, bool bHasSceneTime)
+{
+	// Without a timecode the arrival time is the best sample time there is
+	const double Seconds = bHasSceneTime ? FrameData.MetaData.SceneTime.AsSeconds() : PacketReceiveTime;
+	PosePredictor->Predict(SubjectName, Seconds, FrameData.Transform, [this, SubjectName](float PositionError, float RotationErrorDegrees)
+		{
+			Stats->AddPredictionError(SubjectName, PositionError, RotationErrorDegrees);
+		});
+}
+
+void FLONET2LiveLinkSource::StampWorldTime(FLiveLinkBaseFrameData& FrameData, bool bHasSceneTime)
+{
+	// Frames without a timecode can only be stamped with their arrival
+	if (PacketSenderClock == nullptr || !bHasSceneTime)
+	{
+		FrameData.WorldTime = FLiveLinkWorldTime(PacketReceiveTime);
+		return;
+	}
+
+	const double SenderSeconds = FrameData.MetaData.SceneTime.AsSeconds();
+	PacketSenderClock->AddSample(SenderSeconds, PacketReceiveTime);
+	FrameData.WorldTime = FLiveLinkWorldTime(PacketSenderClock->ToLocalSeconds(SenderSeconds));
+}
 
-		CameraObject->Get()->TryGetNumberField(TEXT("whiteBalance"), whiteBalance);
-		CameraObject->Get()->TryGetNumberField(TEXT("tint"), tint);
-		CameraObject->Get()->TryGetNumberField(TEXT("ISO"), ISO);
-		CameraObject->Get()->TryGetNumberField(TEXT("shutter"), shutter);
-		CameraObject->Get()->TryGetNumberField(TEXT("focalLengthRaw"), focalLengthRaw);
-		CameraObject->Get()->TryGetNumberField(TEXT("irisRaw"), irisRaw);
-		CameraObject->Get()->TryGetNumberField(TEXT("focusRaw"), focusRaw);
-		CameraObject->Get()->TryGetNumberField(TEXT("frameRate"), frameRate);
+void FLONET2LiveLinkSource::ProcessPacket(const FLONET2Packet& Packet)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LONET2_Decode);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	const TArray<uint8>& RawData = Packet.Data;
+
+	ForgetIdleSubjects();
+
+	PacketReceiveTime = Packet.ReceiveTime;
+	PacketSubjectSender = Options.bSubjectsPerSender ? Packet.Sender.Address : FIPv4Address::Any;
+	PacketSenderClock = nullptr;
+	if (Options.bEstimateSenderClock)
+	{
+		FSenderClock& SenderClock = SenderClocks.FindOrAdd(Packet.Sender.Address);
+		if (!SenderClock.Estimator.IsValid())
+		{
+			SenderClock.Estimator = MakeUnique<FLONET2ClockEstimator>();
+		}
+		SenderClock.LastSeen = Packet.ReceiveTime;
+		PacketSenderClock = SenderClock.Estimator.Get();
+	}
+
+	bool bDecoded = false;
+	if (FLONET2StreamDecoder::IsBinaryPacket(RawData.GetData(), RawData.Num()))
+	{
+		bDecoded = StreamDecoder->DecodeBinary(RawData.GetData(), RawData.Num()) == FLONET2StreamDecoder::EResult::Decoded;
+		if (bDecoded)
+		{
+			QueueDecodedSections();
+		}
+	}
+	else
+	{
+		bDecoded = ProcessJsonData(RawData);
+	}
 
-		TArray<TSharedPtr<FJsonValue>> positionArray = CameraObject->Get()->GetArrayField("position");
-		TArray<TSharedPtr<FJsonValue>> rotationArray = CameraObject->Get()->GetArrayField("orientation");
-		TArray<TSharedPtr<FJsonValue>> sensorSizeArray = CameraObject->Get()->GetArrayField("sensorSize");
+	INC_DWORD_STAT(STAT_LONET2_PacketsReceived);
+	INC_DWORD_STAT_BY(STAT_LONET2_BytesReceived, RawData.Num());
+	if (!bDecoded)
+	{
+		INC_DWORD_STAT(STAT_LONET2_MalformedPackets);
+	}
+	Stats->RecordPacket(RawData.Num(), FPlatformTime::Cycles64() - StartCycles, !bDecoded);
+}
 
-		FString timecodeToSplit;
-		CameraObject->Get()->TryGetStringField(TEXT("timecode"), timecodeToSplit);
+bool FLONET2LiveLinkSource::ProcessJsonData(const TArray<uint8>& RawData)
+{
+	const FLONET2StreamDecoder::EResult Result = StreamDecoder->Decode(RawData.GetData(), RawData.Num());
+	if (Result == FLONET2StreamDecoder::EResult::Fallback)
+	{
+		return ProcessJsonDataDom(RawData);
+	}
+	if (Result == FLONET2StreamDecoder::EResult::Decoded)
+	{
+		for (FLONET2DecodedLensTable& LensTable : StreamDecoder->GetLensTables())
+		{
+			LensTables->Set(LensTable.CameraName, PacketSubjectSender, MoveTemp(LensTable.Samples));
+			ResolveSubject(ELONET2Section::Lens, LensTable.CameraName);
+		}
+		QueueDecodedSections();
+		return true;
+	}
+	return false;
+}
 
-		FrameData.FocusDistance = focusRaw;
-		FrameData.Aperture = irisRaw;
-		FrameData.FocalLength = focalLengthRaw;
+void FLONET2LiveLinkSource::QueueDecodedSections()
+{
+	for (FLONET2DecodedSection& Section : StreamDecoder->GetSections())
+	{
+		const FName SubjectName = ResolveSubject(Section.Section, Section.SubjectName);
 
-		if (positionArray.Num() >= 3)
+		if (Section.bHasSequence
+			&& DeltaState->Apply(SubjectName, LONET2Schema::GetSection(Section.Section), Section.Sequence, Section.bKeyframe, Section.FieldMask, Section.FrameRate, Section.FrameData) != FLONET2DeltaState::EResult::Applied)
 		{
-			FrameData.Transform.SetLocation(FVector(positionArray[0]->AsNumber(), positionArray[1]->AsNumber(), positionArray[2]->AsNumber()));
+			continue;
 		}
-		if (rotationArray.Num() >= 4)
+
+		// Frames only carry scene time when the sender provides a timecode that parses, 00:00:00:00 included
+		bool bHasSceneTime = false;
+		if (Section.bHasTimecode)
 		{
-			FrameData.Transform.SetRotation(FQuat(rotationArray[0]->AsNumber(), rotationArray[1]->AsNumber(), rotationArray[2]->AsNumber(), rotationArray[3]->AsNumber()));
+			FQualifiedFrameTime& SceneTime = Section.FrameData.GetBaseData()->MetaData.SceneTime;
+			if (Section.bTimecodeParsed)
+			{
+				SceneTime = LoledUtilities::timeFromTimecode(Section.ParsedTimecode, Section.FrameRate);
+				bHasSceneTime = true;
+			}
+			else
+			{
+				bHasSceneTime = TimecodeParser.Parse(Section.Timecode, Section.FrameRate, SceneTime);
+			}
 		}
+		const bool bMalformedTimecode = Section.bHasTimecode && !bHasSceneTime;
 
-		FrameData.MetaData.SceneTime = LoledUtilities::timeFromTimecodeString(timecodeToSplit, frameRate);
+		if (Section.Section == ELONET2Section::Camera && PosePredictor->IsEnabled())
+		{
+			PredictPose(SubjectName, *Section.FrameData.Cast<FLiveLinkCameraFrameData>(), bHasSceneTime);
+		}
 
-		FrameData.PropertyValues.SetNumUninitialized(6);
-		FrameData.PropertyValues[0] = whiteBalance;
-		FrameData.PropertyValues[1] = tint;
-		FrameData.PropertyValues[2] = ISO;
-		FrameData.PropertyValues[3] = shutter;
-		if (sensorSizeArray.Num() >= 2)
+		// A distortion_data section for the same camera wins over the table
+		if (Section.Section == ELONET2Section::Encoder && !LensTables->IsEmpty()
+			&& !StreamDecoder->GetSections().ContainsByPredicate([&Section](const FLONET2DecodedSection& Other)
+				{
+					return Other.Section == ELONET2Section::Lens && Other.SubjectName == Section.SubjectName;
+				}))
 		{
-			FrameData.PropertyValues[4] = sensorSizeArray[0]->AsNumber();
-			FrameData.PropertyValues[5] = sensorSizeArray[1]->AsNumber();
+			QueueEvaluatedLens(Section.SubjectName, *Section.FrameData.Cast<FLiveLinkCameraFrameData>(), bHasSceneTime, bMalformedTimecode);
 		}
 
-		Client->PushSubjectFrameData_AnyThread({ SourceGuid, SubjectName }, MoveTemp(FrameDataStruct));
+		QueueFrame(SubjectName, MoveTemp(Section.FrameData), bHasSceneTime, bMalformedTimecode);
+	}
+}
+
+void FLONET2LiveLinkSource::QueueEvaluatedLens(FAnsiStringView RawCameraName, const FLiveLinkCameraFrameData& EncoderFrame, bool bHasSceneTime, bool bMalformedTimecode)
+{
+	const FLONET2LensTable* Table = LensTables->Find(RawCameraName, PacketSubjectSender);
+	if (Table == nullptr || Table->IsEmpty() || !IsSectionEnabled(ELONET2Section::Lens, RawCameraName))
+	{
+		return;
+	}
+
+	const FName SubjectName = ResolveSubject(ELONET2Section::Lens, RawCameraName);
+
+	FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkLensFrameData::StaticStruct());
+	FLiveLinkLensFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkLensFrameData>();
+
+	FrameData.Aperture = EncoderFrame.Aperture;
+	FrameData.FocalLength = EncoderFrame.FocalLength;
+	FrameData.FocusDistance = EncoderFrame.FocusDistance;
+	FrameData.ProjectionMode = ELiveLinkCameraProjectionMode::Perspective;
+	FrameData.MetaData.SceneTime = EncoderFrame.MetaData.SceneTime;
+
+	// The table's zoom axis is the mapped focal length
+	Table->Evaluate(EncoderFrame.FocusDistance, EncoderFrame.FocalLength, FrameData);
+
+	// The lens frame carries the encoder's scene time, malformed or not
+	QueueFrame(SubjectName, MoveTemp(FrameDataStruct), bHasSceneTime, bMalformedTimecode);
+}
+
+FName FLONET2LiveLinkSource::ResolveSubject(ELONET2Section Section, FAnsiStringView RawName)
+{
+	FLiveLinkSubjectKey SubjectKey;
+	if (SubjectCache->FindOrAdd(Section, RawName, PacketSubjectSender, SourceGuid, PacketReceiveTime, SubjectKey))
+	{
+		PushStaticData(Section, SubjectKey.SubjectName);
 	}
+	return SubjectKey.SubjectName;
+}
+
+void FLONET2LiveLinkSource::PushStaticData(ELONET2Section Section, FName SubjectName)
+{
+	const LONET2Schema::FSection& Schema = LONET2Schema::GetSection(Section);
+	PushSubjectStaticData({ SourceGuid, SubjectName }, Schema.Role(), LONET2Schema::MakeStaticData(Schema));
+}
 
-	//Controller
-	const TSharedPtr<FJsonObject>* ControllerObject;
-	bool bHasControllerData = JsonObject->TryGetObjectField("controller_data", ControllerObject);
-	if (bHasControllerData) {
-		FString controllerName = ControllerObject->Get()->GetStringField("controllerName");
-		FString tmpNameBase = controllerName + " Controller";
-		FName SubjectNameBase(tmpNameBase);
+bool FLONET2LiveLinkSource::ProcessJsonDataDom(const TArray<uint8>& RawData)
+{
 
-		if (!EncounteredSubjects.Contains(SubjectNameBase)) {
-			FLiveLinkStaticDataStruct UserStaticDataStruct = FLiveLinkStaticDataStruct(FLiveLinkBaseStaticData::StaticStruct());
-			FLiveLinkBaseStaticData& UserStaticData = *UserStaticDataStruct.Cast<FLiveLinkBaseStaticData>();
+	FString JsonString;
+	FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(RawData.GetData()), RawData.Num());
+	JsonString = FString(Converter.Length(), Converter.Get());
 
-			UserStaticData.PropertyNames.SetNumUninitialized(7);
-			UserStaticData.PropertyNames[0] = FName("button1");
-			UserStaticData.PropertyNames[1] = FName("button2");
-			UserStaticData.PropertyNames[2] = FName("button3");
-			UserStaticData.PropertyNames[3] = FName("trigger");
-			UserStaticData.PropertyNames[4] = FName("touchpadPressed");
-			UserStaticData.PropertyNames[5] = FName("touchpadX");
-			UserStaticData.PropertyNames[6] = FName("touchpadY");
+	TSharedPtr<FJsonObject> JsonObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
 
-			Client->PushSubjectStaticData_AnyThread({ SourceGuid, SubjectNameBase }, ULiveLinkBasicRole::StaticClass(), MoveTemp(UserStaticDataStruct));
-			EncounteredSubjects.Add(SubjectNameBase);
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	{
+		return false;
+	}
+
+	//lens calibration table
+	const TSharedPtr<FJsonObject>* CalibrationObject;
+	if (JsonObject->TryGetObjectField("lens_calibration_data", CalibrationObject)) {
+		FTCHARToUTF8 tmpName(*CalibrationObject->Get()->GetStringField("cameraName"));
+		const FAnsiStringView RawName(tmpName.Get(), tmpName.Length());
+
+		TArray<FLONET2LensSample> Samples;
+		const TArray<TSharedPtr<FJsonValue>>* SampleValues;
+		if (CalibrationObject->Get()->TryGetArrayField("samples", SampleValues)) {
+			for (const TSharedPtr<FJsonValue>& SampleValue : *SampleValues) {
+				const TSharedPtr<FJsonObject>* SampleObject;
+				if (!SampleValue->TryGetObject(SampleObject)) {
+					continue;
+				}
+				FLONET2LensSample& Sample = Samples.AddDefaulted_GetRef();
+				double focus = 0.0, zoom = 0.0;
+				SampleObject->Get()->TryGetNumberField(TEXT("focus"), focus);
+				SampleObject->Get()->TryGetNumberField(TEXT("zoom"), zoom);
+				Sample.Focus = focus;
+				Sample.Zoom = zoom;
+
+				const TArray<TSharedPtr<FJsonValue>>* fXfY;
+				const TArray<TSharedPtr<FJsonValue>>* principalPoint;
+				const TArray<TSharedPtr<FJsonValue>>* distortionParameters;
+				if (SampleObject->Get()->TryGetArrayField("fXfY", fXfY) && fXfY->Num() >= 2) {
+					Sample.FxFy[0] = (*fXfY)[0]->AsNumber();
+					Sample.FxFy[1] = (*fXfY)[1]->AsNumber();
+				}
+				if (SampleObject->Get()->TryGetArrayField("principalPoint", principalPoint) && principalPoint->Num() >= 2) {
+					Sample.PrincipalPoint[0] = (*principalPoint)[0]->AsNumber();
+					Sample.PrincipalPoint[1] = (*principalPoint)[1]->AsNumber();
+				}
+				if (SampleObject->Get()->TryGetArrayField("distortionParameters", distortionParameters)) {
+					for (const auto& val : *distortionParameters) {
+						Sample.DistortionParameters.Push(val->AsNumber());
+					}
+				}
+			}
 		}
 
-		FLiveLinkFrameDataStruct UserFrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkBaseFrameData::StaticStruct());
-		FLiveLinkBaseFrameData& UserFrameData = *UserFrameDataStruct.Cast<FLiveLinkBaseFrameData>();
+		LensTables->Set(RawName, PacketSubjectSender, MoveTemp(Samples));
+		ResolveSubject(ELONET2Section::Lens, RawName);
+	}
 
-		double button1 = 0.0, button2 = 0.0, button3 = 0.0, trigger = 0.0;
-		double touchpadPressed = 0.0, touchpadX = 0.0, touchpadY = 0.0, frameRate = 24.0;
+	const auto DistortionObjects = LONET2LiveLinkSource::GetSectionObjects(*JsonObject, ANSI_TO_TCHAR(LONET2Schema::GetSection(ELONET2Section::Lens).JsonKey));
+
+	for (const LONET2Schema::FSection& Schema : LONET2Schema::GetSections()) {
+		const FString JsonKey(Schema.JsonKey);
+		for (const TSharedPtr<FJsonObject>* SectionObject : LONET2LiveLinkSource::GetSectionObjects(*JsonObject, *JsonKey)) {
+			FLiveLinkFrameDataStruct FrameDataStruct = LONET2Schema::MakeFrame(Schema);
+			FLiveLinkBaseFrameData& FrameData = *FrameDataStruct.GetBaseData();
+
+			FString subjectString, timecodeToSplit;
+			bool bHasTimecode = false;
+			double frameRate = 24.0;
+			double sequence = 0.0;
+			bool bHasSequence = false, bKeyframe = false;
+			uint32 FieldMask = 0;
+
+			for (const LONET2Schema::FField& Field : Schema.Fields) {
+				if (SectionObject->Get()->HasField(FString(Field.Key))) {
+					FieldMask |= LONET2Schema::GetFieldBit(Schema, Field);
+				}
+				switch (Field.Target) {
+				case LONET2Schema::EFieldTarget::SubjectName:
+					SectionObject->Get()->TryGetStringField(FString(Field.Key), subjectString);
+					break;
+				case LONET2Schema::EFieldTarget::Timecode:
+					bHasTimecode = SectionObject->Get()->TryGetStringField(FString(Field.Key), timecodeToSplit);
+					break;
+				case LONET2Schema::EFieldTarget::FrameRate:
+					SectionObject->Get()->TryGetNumberField(FString(Field.Key), frameRate);
+					break;
+				case LONET2Schema::EFieldTarget::Sequence:
+					bHasSequence = SectionObject->Get()->TryGetNumberField(FString(Field.Key), sequence);
+					break;
+				case LONET2Schema::EFieldTarget::Keyframe:
+					SectionObject->Get()->TryGetBoolField(FString(Field.Key), bKeyframe);
+					break;
+				default:
+					LONET2LiveLinkSource::ReadJsonField(*SectionObject->Get(), Field, FrameData);
+					break;
+				}
+			}
 
-		ControllerObject->Get()->TryGetNumberField(TEXT("button1"), button1);
-		ControllerObject->Get()->TryGetNumberField(TEXT("button2"), button2);
-		ControllerObject->Get()->TryGetNumberField(TEXT("button3"), button3);
-		ControllerObject->Get()->TryGetNumberField(TEXT("trigger"), trigger);
-		ControllerObject->Get()->TryGetNumberField(TEXT("touchpadPressed"), touchpadPressed);
-		ControllerObject->Get()->TryGetNumberField(TEXT("touchpadX"), touchpadX);
-		ControllerObject->Get()->TryGetNumberField(TEXT("touchpadY"), touchpadY);
+			FTCHARToUTF8 tmpName(*subjectString);
+			const FAnsiStringView RawName(tmpName.Get(), tmpName.Length());
+			if (!IsSectionEnabled(Schema.Section, RawName)) {
+				continue;
+			}
+			const FName SubjectName = ResolveSubject(Schema.Section, RawName);
 
-		UserFrameData.PropertyValues.SetNumUninitialized(7);
-		UserFrameData.PropertyValues[0] = button1;
-		UserFrameData.PropertyValues[1] = button2;
-		UserFrameData.PropertyValues[2] = button3;
-		UserFrameData.PropertyValues[3] = trigger;
-		UserFrameData.PropertyValues[4] = touchpadPressed;
-		UserFrameData.PropertyValues[5] = touchpadX;
-		UserFrameData.PropertyValues[6] = touchpadY;
+			if (bHasSequence
+				&& DeltaState->Apply(SubjectName, Schema, static_cast<uint32>(static_cast<int64>(sequence)), bKeyframe, FieldMask, frameRate, FrameDataStruct) != FLONET2DeltaState::EResult::Applied) {
+				continue;
+			}
 
-		FString timecodeToSplit;
-		ControllerObject->Get()->TryGetNumberField(TEXT("frameRate"), frameRate);
-		ControllerObject->Get()->TryGetStringField(TEXT("timecode"), timecodeToSplit);
-		UserFrameData.MetaData.SceneTime = LoledUtilities::timeFromTimecodeString(timecodeToSplit, frameRate);
+			// Frames only carry scene time when the sender provides a timecode that parses, 00:00:00:00 included
+			const bool bHasSceneTime = bHasTimecode && LoledUtilities::timeFromTimecodeString(timecodeToSplit, frameRate, FrameData.MetaData.SceneTime);
+			const bool bMalformedTimecode = bHasTimecode && !bHasSceneTime;
 
-		Client->PushSubjectFrameData_AnyThread({ SourceGuid, SubjectNameBase }, MoveTemp(UserFrameDataStruct));
+			if (Schema.Section == ELONET2Section::Camera && PosePredictor->IsEnabled()) {
+				PredictPose(SubjectName, *FrameDataStruct.Cast<FLiveLinkCameraFrameData>(), bHasSceneTime);
+			}
+
+			if (Schema.Section == ELONET2Section::Encoder && !LensTables->IsEmpty()) {
+				const bool bHasDistortion = DistortionObjects.ContainsByPredicate([&subjectString](const TSharedPtr<FJsonObject>* DistortionObject)
+					{
+						return DistortionObject->Get()->GetStringField("cameraName") == subjectString;
+					});
+				if (!bHasDistortion) {
+					QueueEvaluatedLens(RawName, *FrameDataStruct.Cast<FLiveLinkCameraFrameData>(), bHasSceneTime, bMalformedTimecode);
+				}
+			}
+
+			QueueFrame(SubjectName, MoveTemp(FrameDataStruct), bHasSceneTime, bMalformedTimecode);
+		}
 	}
+
+	return true;
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
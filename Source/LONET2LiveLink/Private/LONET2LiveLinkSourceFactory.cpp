@@ -2,6 +2,7 @@
 #include "LONET2LiveLinkSourceFactory.h"
 #include "LONET2LiveLinkSource.h"
 #include "SLONET2LiveLinkSourceFactory.h"
+#include "Misc/Parse.h"
 
 #define LOCTEXT_NAMESPACE "LONET2LiveLinkSourceFactory"
 
@@ -12,7 +13,7 @@ FText ULONET2LiveLinkSourceFactory::GetSourceDisplayName() const
 
 FText ULONET2LiveLinkSourceFactory::GetSourceTooltip() const
 {
-	return LOCTEXT("SourceTooltip", "Creates a connection to a LONET 2 UDP Stream");
+	return LOCTEXT("SourceTooltip", "Creates a connection to a LONET 2 UDP Stream, or replays a LONET 2 capture file");
 }
 
 TSharedPtr<SWidget> ULONET2LiveLinkSourceFactory::BuildCreationPanel(FOnLiveLinkSourceCreated InOnLiveLinkSourceCreated) const
@@ -23,18 +24,46 @@ TSharedPtr<SWidget> ULONET2LiveLinkSourceFactory::BuildCreationPanel(FOnLiveLink
 
 TSharedPtr<ILiveLinkSource> ULONET2LiveLinkSourceFactory::CreateSource(const FString& InConnectionString) const
 {
-	FIPv4Endpoint DeviceEndPoint;
-	if (!FIPv4Endpoint::Parse(InConnectionString, DeviceEndPoint))
+	FLONET2LiveLinkSourceOptions Options;
+	if (FParse::Value(*InConnectionString, TEXT("ReplayFile="), Options.ReplayFile))
+	{
+		FParse::Bool(*InConnectionString, TEXT("RealTime="), Options.bReplayRealTime);
+		FParse::Bool(*InConnectionString, TEXT("Loop="), Options.bReplayLoop);
+		return MakeShared<FLONET2LiveLinkSource>(FIPv4Endpoint::Any, Options);
+	}
+
+	if (FLONET2LiveLinkSource::ParseSharedMemoryName(InConnectionString, Options.SharedMemoryName))
+	{
+		return MakeShared<FLONET2LiveLinkSource>(FIPv4Endpoint::Any, Options);
+	}
+
+	TArray<FIPv4Endpoint> DeviceEndPoints;
+	if (!FLONET2LiveLinkSource::ParseEndpoints(InConnectionString, DeviceEndPoints))
 	{
 		return TSharedPtr<ILiveLinkSource>();
 	}
 
-	return MakeShared<FLONET2LiveLinkSource>(DeviceEndPoint);
+	return MakeShared<FLONET2LiveLinkSource>(MoveTemp(DeviceEndPoints));
 }
 
-void ULONET2LiveLinkSourceFactory::OnOkClicked(FIPv4Endpoint InEndpoint, FOnLiveLinkSourceCreated InOnLiveLinkSourceCreated) const
+void ULONET2LiveLinkSourceFactory::OnOkClicked(TArray<FIPv4Endpoint> InEndpoints, const FLONET2LiveLinkSourceOptions& InOptions, FOnLiveLinkSourceCreated InOnLiveLinkSourceCreated) const
 {
-	InOnLiveLinkSourceCreated.ExecuteIfBound(MakeShared<FLONET2LiveLinkSource>(InEndpoint), InEndpoint.ToString());
+	if (!InOptions.ReplayFile.IsEmpty())
+	{
+		const FString ConnectionString = FString::Printf(TEXT("ReplayFile=\"%s\" RealTime=%s Loop=%s"), *InOptions.ReplayFile,
+			InOptions.bReplayRealTime ? TEXT("true") : TEXT("false"), InOptions.bReplayLoop ? TEXT("true") : TEXT("false"));
+		InOnLiveLinkSourceCreated.ExecuteIfBound(MakeShared<FLONET2LiveLinkSource>(FIPv4Endpoint::Any, InOptions), ConnectionString);
+		return;
+	}
+
+	if (!InOptions.SharedMemoryName.IsEmpty())
+	{
+		InOnLiveLinkSourceCreated.ExecuteIfBound(MakeShared<FLONET2LiveLinkSource>(FIPv4Endpoint::Any, InOptions), TEXT("shm://") + InOptions.SharedMemoryName);
+		return;
+	}
+
+	const FString ConnectionString = FLONET2LiveLinkSource::EndpointsToString(InEndpoints);
+	InOnLiveLinkSourceCreated.ExecuteIfBound(MakeShared<FLONET2LiveLinkSource>(MoveTemp(InEndpoints)), ConnectionString);
 }
 
-#undef LOCTEXT_NAMESPACE
\ No newline at end of file
+#undef LOCTEXT_NAMESPACE
@@ -7,6 +7,7 @@
 #include "LONET2LiveLinkSourceFactory.generated.h"
 
 class SLONET2LiveLinkSourceEditor;
+struct FLONET2LiveLinkSourceOptions;
 
 UCLASS()
 class ULONET2LiveLinkSourceFactory : public ULiveLinkSourceFactory
@@ -20,7 +21,14 @@ public:
 
 	virtual EMenuType GetMenuType() const override { return EMenuType::SubPanel; }
 	virtual TSharedPtr<SWidget> BuildCreationPanel(FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const override;
+
+	/**
+	 * Accepts an endpoint such as 236.12.12.12:60608, a comma separated list of endpoints served by one source,
+	 * a shared memory ring written by senders on the same host (Linux only) such as shm://tracker,
+	 * or a replay of a capture file:
+	 * ReplayFile="D:/Captures/Stage.ln2cap" RealTime=true Loop=false
+	 */
 	TSharedPtr<ILiveLinkSource> CreateSource(const FString& ConnectionString) const override;
 private:
-	void OnOkClicked(FIPv4Endpoint Endpoint, FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const;
-};
\ No newline at end of file
+	void OnOkClicked(TArray<FIPv4Endpoint> Endpoints, const FLONET2LiveLinkSourceOptions& Options, FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const;
+};
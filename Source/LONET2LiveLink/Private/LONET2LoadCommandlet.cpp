@@ -0,0 +1,341 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2LoadCommandlet.h"
+
+#include "LONET2LiveLinkSource.h"
+#include "LONET2BinaryProtocol.h"
+#include "LONET2SharedMemory.h"
+#include "LONET2StreamDecoder.h"
+#include "LONET2SyntheticTraffic.h"
+#include "Common/UdpSocketBuilder.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace LONET2Load
+{
+	struct FSubject
+	{
+		ELONET2Section Section;
+		FString Name;
+	};
+
+	struct FDatagram
+	{
+		TArray<uint8> Bytes;
+		int32 Sections = 0;
+	};
+
+	/** Datagrams of one tick, every subject once. */
+	typedef TArray<FDatagram> FTick;
+
+	struct FStepResult
+	{
+		float Rate = 0.0f;
+		double Seconds = 0.0;
+		uint64 Ticks = 0;
+		uint64 LateTicks = 0;
+		uint64 Datagrams = 0;
+		uint64 Sections = 0;
+		uint64 Bytes = 0;
+		uint64 Dropped = 0;
+		uint64 Reordered = 0;
+		uint64 SendFailures = 0;
+	};
+
+	static const ELONET2Section SectionOrder[] = { ELONET2Section::Encoder, ELONET2Section::Lens, ELONET2Section::Camera, ELONET2Section::Controller };
+
+	static void AddSubjects(TArray<FSubject>& Subjects, ELONET2Section Section, const TCHAR* Prefix, int32 Count)
+	{
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Subjects.Add({ Section, FString::Printf(TEXT("%s%d"), Prefix, Index + 1) });
+		}
+	}
+
+	/** One key per section type, holding an array when the datagram carries several subjects of that type. */
+	static TArray<uint8> MakeJsonPacket(TArrayView<const FSubject> Subjects, int32 Frame)
+	{
+		FString Json = TEXT("{");
+		for (const ELONET2Section Section : SectionOrder)
+		{
+			TArray<FString> Objects;
+			for (const FSubject& Subject : Subjects)
+			{
+				if (Subject.Section == Section)
+				{
+					Objects.Add(LONET2SyntheticTraffic::MakeJsonSection(Section, Subject.Name, Frame));
+				}
+			}
+			if (Objects.Num() == 0)
+			{
+				continue;
+			}
+
+			if (Json.Len() > 1)
+			{
+				Json += TEXT(",");
+			}
+			Json += FString::Printf(TEXT("\"%s\":"), LONET2SyntheticTraffic::GetJsonKey(Section));
+			Json += Objects.Num() == 1 ? Objects[0] : TEXT("[") + FString::Join(Objects, TEXT(",")) + TEXT("]");
+		}
+		Json += TEXT("}");
+
+		const FTCHARToUTF8 Utf8(*Json);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	static TArray<uint8> MakeBinaryPacket(TArrayView<const FSubject> Subjects, int32 Frame)
+	{
+		TArray<uint8> Bytes;
+		FLONET2BinaryWriter Writer(Bytes);
+		for (const FSubject& Subject : Subjects)
+		{
+			LONET2SyntheticTraffic::AddBinarySection(Writer, Subject.Section, Subject.Name, Frame);
+		}
+		return Bytes;
+	}
+
+	/** Builds every datagram up front, so the send loop measures the receiver rather than string formatting. */
+	static TArray<FTick> MakeTicks(const TArray<FSubject>& Subjects, int32 NumFrames, int32 SectionsPerPacket, bool bBinary)
+	{
+		TArray<FTick> Ticks;
+		Ticks.SetNum(NumFrames);
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 First = 0; First < Subjects.Num(); First += SectionsPerPacket)
+			{
+				const TArrayView<const FSubject> Batch(Subjects.GetData() + First, FMath::Min(SectionsPerPacket, Subjects.Num() - First));
+
+				FDatagram& Datagram = Ticks[Frame].AddDefaulted_GetRef();
+				Datagram.Bytes = bBinary ? MakeBinaryPacket(Batch, Frame) : MakeJsonPacket(Batch, Frame);
+				Datagram.Sections = Batch.Num();
+			}
+		}
+		return Ticks;
+	}
+}
+
+ULONET2LoadCommandlet::ULONET2LoadCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 ULONET2LoadCommandlet::Main(const FString& Params)
+{
+	using namespace LONET2Load;
+
+	const TCHAR* CmdLine = *Params;
+
+	FString TargetString = TEXT("127.0.0.1:60609");
+	FParse::Value(CmdLine, TEXT("Target="), TargetString);
+	FIPv4Endpoint Target;
+	FString SharedMemoryName;
+	const bool bSharedMemory = FLONET2LiveLinkSource::ParseSharedMemoryName(TargetString, SharedMemoryName);
+	if (!bSharedMemory && !FIPv4Endpoint::Parse(TargetString, Target))
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Invalid target %s, expected address:port or shm://name"), *TargetString);
+		return 1;
+	}
+
+	int32 NumCameras = 1;
+	int32 NumLenses = 0;
+	int32 NumEncoders = 0;
+	int32 NumControllers = 0;
+	FParse::Value(CmdLine, TEXT("Cameras="), NumCameras);
+	FParse::Value(CmdLine, TEXT("Lenses="), NumLenses);
+	FParse::Value(CmdLine, TEXT("Encoders="), NumEncoders);
+	FParse::Value(CmdLine, TEXT("Controllers="), NumControllers);
+
+	TArray<FSubject> Subjects;
+	AddSubjects(Subjects, ELONET2Section::Encoder, TEXT("Cam"), NumEncoders);
+	AddSubjects(Subjects, ELONET2Section::Lens, TEXT("Cam"), NumLenses);
+	AddSubjects(Subjects, ELONET2Section::Camera, TEXT("Cam"), NumCameras);
+	AddSubjects(Subjects, ELONET2Section::Controller, TEXT("Wand"), NumControllers);
+	if (Subjects.Num() == 0)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("No subjects to send, set -Cameras, -Lenses, -Encoders or -Controllers"));
+		return 1;
+	}
+
+	FString Format = TEXT("Json");
+	FParse::Value(CmdLine, TEXT("Format="), Format);
+	const bool bBinary = Format.Equals(TEXT("Binary"), ESearchCase::IgnoreCase);
+
+	// A binary packet counts its sections in one byte
+	int32 SectionsPerPacket = 1;
+	FParse::Value(CmdLine, TEXT("SectionsPerPacket="), SectionsPerPacket);
+	SectionsPerPacket = FMath::Clamp(SectionsPerPacket, 1, bBinary ? static_cast<int32>(MAX_uint8) : MAX_int32);
+
+	float Rate = 60.0f;
+	FParse::Value(CmdLine, TEXT("Rate="), Rate);
+	TArray<float> Rates;
+	FString RateSteps;
+	if (FParse::Value(CmdLine, TEXT("RateSteps="), RateSteps, false))
+	{
+		TArray<FString> Steps;
+		RateSteps.ParseIntoArray(Steps, TEXT(","));
+		for (const FString& Step : Steps)
+		{
+			if (FCString::Atof(*Step) > 0.0f)
+			{
+				Rates.Add(FCString::Atof(*Step));
+			}
+		}
+	}
+	if (Rates.Num() == 0)
+	{
+		Rates.Add(FMath::Max(Rate, 1.0f));
+	}
+
+	float Duration = 10.0f;
+	float Loss = 0.0f;
+	float Reorder = 0.0f;
+	int32 Seed = 0;
+	int32 Ttl = 1;
+	int32 NumFrames = 240;
+	FParse::Value(CmdLine, TEXT("Duration="), Duration);
+	FParse::Value(CmdLine, TEXT("Loss="), Loss);
+	FParse::Value(CmdLine, TEXT("Reorder="), Reorder);
+	FParse::Value(CmdLine, TEXT("Seed="), Seed);
+	FParse::Value(CmdLine, TEXT("Ttl="), Ttl);
+	FParse::Value(CmdLine, TEXT("Frames="), NumFrames);
+	NumFrames = FMath::Max(NumFrames, 1);
+
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	FSocket* Sender = nullptr;
+	TUniquePtr<FLONET2SharedMemoryWriter> SharedMemoryWriter;
+	if (bSharedMemory)
+	{
+		SharedMemoryWriter = FLONET2SharedMemoryWriter::Create(SharedMemoryName);
+		if (!SharedMemoryWriter.IsValid())
+		{
+			UE_LOG(ModuleLog, Error, TEXT("Failed to open the shared memory ring %s"), *SharedMemoryName);
+			return 1;
+		}
+	}
+	else
+	{
+		Sender = FUdpSocketBuilder(TEXT("LONET2LoadSender"))
+			.WithSendBufferSize(4 * 1024 * 1024)
+			.WithMulticastTtl(static_cast<uint8>(FMath::Clamp(Ttl, 0, 255)))
+			.WithMulticastLoopback();
+		if (Sender == nullptr)
+		{
+			UE_LOG(ModuleLog, Error, TEXT("Failed to create the sender socket"));
+			return 1;
+		}
+	}
+	TSharedRef<FInternetAddr> Destination = Target.ToInternetAddr();
+
+	const TArray<FTick> Ticks = MakeTicks(Subjects, NumFrames, SectionsPerPacket, bBinary);
+
+	UE_LOG(ModuleLog, Display, TEXT("LONET 2 load to %s: %d subjects, %s, %d sections per packet, %d datagrams per tick, %.1f%% loss, %.1f%% reorder"),
+		bSharedMemory ? *TargetString : *Target.ToString(), Subjects.Num(), bBinary ? TEXT("binary") : TEXT("JSON"), SectionsPerPacket, Ticks[0].Num(), Loss * 100.0f, Reorder * 100.0f);
+
+	// The same seed gives the same loss and reorder pattern, so runs are repeatable
+	FRandomStream Random(Seed);
+	int32 Frame = 0;
+
+	TArray<FStepResult> Results;
+	for (const float StepRate : Rates)
+	{
+		FStepResult& Result = Results.AddDefaulted_GetRef();
+		Result.Rate = StepRate;
+
+		const FDatagram* Held = nullptr;
+		auto Send = [&](const FDatagram& Datagram)
+		{
+			int32 BytesSent = Datagram.Bytes.Num();
+			const bool bSent = SharedMemoryWriter.IsValid() ? SharedMemoryWriter->Write(Datagram.Bytes)
+				: Sender->SendTo(Datagram.Bytes.GetData(), Datagram.Bytes.Num(), BytesSent, *Destination);
+			if (!bSent)
+			{
+				++Result.SendFailures;
+				return;
+			}
+			++Result.Datagrams;
+			Result.Sections += Datagram.Sections;
+			Result.Bytes += BytesSent;
+		};
+
+		const double Period = 1.0 / StepRate;
+		const int64 NumTicks = FMath::Max<int64>(1, static_cast<int64>(Duration * StepRate));
+		const double Start = FPlatformTime::Seconds();
+		double Now = Start;
+		for (int64 Tick = 0; Tick < NumTicks && !IsEngineExitRequested(); ++Tick)
+		{
+			const double Due = Start + Tick * Period;
+			Now = FPlatformTime::Seconds();
+			if (Now - Due > Period)
+			{
+				++Result.LateTicks;
+			}
+			while (Now < Due)
+			{
+				// Sleep through most of the wait and yield for the rest, the scheduler wakes up too late for short sleeps
+				const double Remaining = Due - Now;
+				FPlatformProcess::Sleep(Remaining > 0.002 ? static_cast<float>(Remaining - 0.001) : 0.0f);
+				Now = FPlatformTime::Seconds();
+			}
+
+			for (const FDatagram& Datagram : Ticks[Frame % Ticks.Num()])
+			{
+				if (Random.FRand() < Loss)
+				{
+					++Result.Dropped;
+					continue;
+				}
+				if (Held == nullptr && Random.FRand() < Reorder)
+				{
+					Held = &Datagram;
+					++Result.Reordered;
+					continue;
+				}
+
+				Send(Datagram);
+				if (Held != nullptr)
+				{
+					Send(*Held);
+					Held = nullptr;
+				}
+			}
+			++Frame;
+			++Result.Ticks;
+		}
+		if (Held != nullptr)
+		{
+			Send(*Held);
+		}
+		Result.Seconds = FMath::Max(FPlatformTime::Seconds() - Start, SMALL_NUMBER);
+
+		UE_LOG(ModuleLog, Display, TEXT("%8.1f Hz: %10.0f datagrams/s %10.0f sections/s %8.2f MB/s, %llu late ticks, %llu dropped, %llu reordered, %llu send failures"),
+			StepRate, Result.Datagrams / Result.Seconds, Result.Sections / Result.Seconds, Result.Bytes / Result.Seconds / (1024.0 * 1024.0),
+			Result.LateTicks, Result.Dropped, Result.Reordered, Result.SendFailures);
+	}
+
+	if (Sender != nullptr)
+	{
+		Sender->Close();
+		SocketSubsystem->DestroySocket(Sender);
+	}
+
+	FString CsvPath;
+	if (FParse::Value(CmdLine, TEXT("Csv="), CsvPath))
+	{
+		FString Csv = TEXT("Rate,Seconds,Ticks,LateTicks,Datagrams,Sections,Bytes,DatagramsPerSecond,SectionsPerSecond,Dropped,Reordered,SendFailures\n");
+		for (const FStepResult& Result : Results)
+		{
+			Csv += FString::Printf(TEXT("%.1f,%.3f,%llu,%llu,%llu,%llu,%llu,%.0f,%.0f,%llu,%llu,%llu\n"), Result.Rate, Result.Seconds, Result.Ticks, Result.LateTicks,
+				Result.Datagrams, Result.Sections, Result.Bytes, Result.Datagrams / Result.Seconds, Result.Sections / Result.Seconds,
+				Result.Dropped, Result.Reordered, Result.SendFailures);
+		}
+		FFileHelper::SaveStringToFile(Csv, *CsvPath);
+	}
+	return 0;
+}
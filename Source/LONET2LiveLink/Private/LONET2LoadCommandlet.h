@@ -0,0 +1,31 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "LONET2LoadCommandlet.generated.h"
+
+/**
+ * Load generator for capacity testing, sends synthetic LONET 2 traffic to a receiving editor or game.
+ * Read the receive side with "stat LONET2" or a CSV profile while it runs.
+ *
+ * UnrealEditor-Cmd <Project> -run=LONET2Load [-Target=127.0.0.1:60609|shm://name] [-Cameras=N] [-Lenses=N] [-Encoders=N] [-Controllers=N]
+ *     [-Rate=Hz] [-RateSteps=60,120,240] [-Duration=Seconds] [-Format=Json|Binary] [-SectionsPerPacket=N]
+ *     [-Loss=0..1] [-Reorder=0..1] [-Seed=N] [-Ttl=N] [-Csv=<file>]
+ *
+ * Every subject sends one section per tick at the per subject rate. The sections of a tick are batched up to SectionsPerPacket per datagram,
+ * as section arrays in JSON and as consecutive sections in binary. Loss drops datagrams at random, Reorder delays one behind the next.
+ * With RateSteps the run repeats for Duration seconds at each rate, one point of the saturation curve per step.
+ * A shm:// target writes the datagrams to a shared memory ring instead, for sources on the same host (Linux only).
+ */
+UCLASS()
+class ULONET2LoadCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	ULONET2LoadCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
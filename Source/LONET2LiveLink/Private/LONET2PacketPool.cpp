@@ -0,0 +1,101 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2PacketPool.h"
+
+#include "Misc/ScopeLock.h"
+
+FLONET2PacketPool::FLONET2PacketPool(int32 InBufferSize, int32 InPreallocatedPackets, int32 InMaxPackets)
+	: BufferSize(InBufferSize)
+	, MaxPackets(FMath::Max(InMaxPackets, InPreallocatedPackets))
+{
+	AllPackets.Reserve(MaxPackets);
+	FreePackets.Reserve(MaxPackets);
+
+	for (int32 Index = 0; Index < InPreallocatedPackets; ++Index)
+	{
+		FreePackets.Add(Allocate());
+	}
+}
+
+FLONET2PacketPool::~FLONET2PacketPool()
+{
+	ensureMsgf(FreePackets.Num() == AllPackets.Num(), TEXT("LONET 2 packets are still in flight while their pool is destroyed"));
+}
+
+FLONET2Packet* FLONET2PacketPool::Allocate()
+{
+	TUniquePtr<FLONET2Packet>& Packet = AllPackets.Add_GetRef(MakeUnique<FLONET2Packet>());
+	Packet->Data.SetNumUninitialized(BufferSize);
+	return Packet.Get();
+}
+
+FLONET2Packet* FLONET2PacketPool::Acquire()
+{
+	FScopeLock Lock(&CriticalSection);
+
+	FLONET2Packet* Packet = nullptr;
+	if (FreePackets.Num() > 0)
+	{
+		Packet = FreePackets.Pop(false);
+	}
+	else if (AllPackets.Num() < MaxPackets)
+	{
+		Packet = Allocate();
+	}
+
+	if (Packet != nullptr)
+	{
+		Packet->Data.SetNumUninitialized(FMath::Max(Packet->Data.Max(), BufferSize), false);
+	}
+	return Packet;
+}
+
+void FLONET2PacketPool::Release(FLONET2Packet* Packet)
+{
+	if (Packet != nullptr)
+	{
+		FScopeLock Lock(&CriticalSection);
+		FreePackets.Add(Packet);
+	}
+}
+
+FLONET2PacketBatch::FLONET2PacketBatch(FLONET2PacketPool& InPool, int32 InSize)
+	: Pool(InPool)
+{
+	Packets.SetNumZeroed(FMath::Max(InSize, 1));
+}
+
+FLONET2PacketBatch::~FLONET2PacketBatch()
+{
+	Release();
+}
+
+TArrayView<FLONET2Packet*> FLONET2PacketBatch::Refill()
+{
+	NumFilled = 0;
+	while (NumFilled < Packets.Num() && (Packets[NumFilled] != nullptr || (Packets[NumFilled] = Pool.Acquire()) != nullptr))
+	{
+		++NumFilled;
+	}
+	return MakeArrayView(Packets.GetData(), NumFilled);
+}
+
+void FLONET2PacketBatch::HandOver(int32 NumHandedOver)
+{
+	// Move the unused packets to the front so the handed over slots are refilled next time
+	for (int32 Index = 0; Index < NumFilled; ++Index)
+	{
+		Packets[Index] = Index + NumHandedOver < NumFilled ? Packets[Index + NumHandedOver] : nullptr;
+	}
+	NumFilled -= NumHandedOver;
+}
+
+void FLONET2PacketBatch::Release()
+{
+	for (FLONET2Packet*& Packet : Packets)
+	{
+		Pool.Release(Packet);
+		Packet = nullptr;
+	}
+	NumFilled = 0;
+}
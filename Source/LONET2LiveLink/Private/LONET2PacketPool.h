@@ -0,0 +1,80 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+
+/** One received datagram. Data keeps its allocation when the packet goes back to the pool. */
+struct FLONET2Packet
+{
+	TArray<uint8> Data;
+
+	FIPv4Endpoint Sender;
+
+	/** FPlatformTime::Seconds() when the datagram arrived, from the kernel timestamp where the platform has one. */
+	double ReceiveTime = 0.0;
+};
+
+/**
+ * Recycled packet buffers for the receive pipeline.
+ * A few packets are allocated up front, more are added on demand up to MaxPackets and are then reused forever,
+ * so steady state receiving does not touch the allocator.
+ */
+class FLONET2PacketPool
+{
+public:
+
+	FLONET2PacketPool(int32 InBufferSize, int32 InPreallocatedPackets, int32 InMaxPackets);
+	~FLONET2PacketPool();
+
+	/** Returns nullptr when every packet is in flight. Data is sized to the buffer size. */
+	FLONET2Packet* Acquire();
+
+	void Release(FLONET2Packet* Packet);
+
+	int32 GetBufferSize() const { return BufferSize; }
+
+private:
+
+	FLONET2Packet* Allocate();
+
+	FCriticalSection CriticalSection;
+
+	TArray<FLONET2Packet*> FreePackets;
+
+	TArray<TUniquePtr<FLONET2Packet>> AllPackets;
+
+	int32 BufferSize;
+	int32 MaxPackets;
+};
+
+/**
+ * A receive thread's batch of pooled packets. Packets left over from a short receive stay in the batch,
+ * only the slots that were handed over are refilled from the pool.
+ */
+class FLONET2PacketBatch
+{
+public:
+
+	FLONET2PacketBatch(FLONET2PacketPool& InPool, int32 InSize);
+	~FLONET2PacketBatch();
+
+	/** Fills the empty slots from the pool and returns the packets to receive into, empty when every packet is in flight. */
+	TArrayView<FLONET2Packet*> Refill();
+
+	/** Gives up the first NumHandedOver packets of the last Refill(), the handler owns them now. */
+	void HandOver(int32 NumHandedOver);
+
+	/** Returns every packet to the pool, on the thread that is done with the batch. */
+	void Release();
+
+private:
+
+	FLONET2PacketPool& Pool;
+
+	TArray<FLONET2Packet*> Packets;
+
+	int32 NumFilled = 0;
+};
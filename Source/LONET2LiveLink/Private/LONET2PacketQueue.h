@@ -0,0 +1,94 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include "LONET2PacketPool.h"
+
+/**
+ * Bounded FIFO of received datagrams between the receiver thread and the decode stage.
+ * When full the oldest datagram goes back to the pool, so a stalled consumer never falls further behind.
+ */
+class FLONET2PacketQueue
+{
+public:
+
+	FLONET2PacketQueue(FLONET2PacketPool& InPool, int32 InCapacity)
+		: Pool(InPool)
+	{
+		Ring.SetNumZeroed(FMath::Max(InCapacity, 1));
+	}
+
+	~FLONET2PacketQueue()
+	{
+		Empty();
+	}
+
+	/** Takes ownership of Packet. Returns false if the oldest packet was dropped to make room. */
+	bool Push(FLONET2Packet* Packet)
+	{
+		FLONET2Packet* Dropped = nullptr;
+		{
+			FScopeLock Lock(&CriticalSection);
+
+			if (Count == Ring.Num())
+			{
+				Dropped = Ring[Head];
+				Head = (Head + 1) % Ring.Num();
+				--Count;
+				++DroppedCount;
+			}
+
+			Ring[(Head + Count) % Ring.Num()] = Packet;
+			++Count;
+		}
+
+		Pool.Release(Dropped);
+		return Dropped == nullptr;
+	}
+
+	/** The caller owns the packet and releases it to the pool. */
+	FLONET2Packet* Pop()
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		if (Count == 0)
+		{
+			return nullptr;
+		}
+
+		FLONET2Packet* Packet = Ring[Head];
+		Head = (Head + 1) % Ring.Num();
+		--Count;
+		return Packet;
+	}
+
+	void Empty()
+	{
+		while (FLONET2Packet* Packet = Pop())
+		{
+			Pool.Release(Packet);
+		}
+	}
+
+	uint64 GetDroppedCount() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		return DroppedCount;
+	}
+
+private:
+
+	FLONET2PacketPool& Pool;
+
+	mutable FCriticalSection CriticalSection;
+
+	TArray<FLONET2Packet*> Ring;
+
+	int32 Head = 0;
+	int32 Count = 0;
+
+	uint64 DroppedCount = 0;
+};
@@ -0,0 +1,136 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2PosePredictor.h"
+
+#include "Misc/ScopeLock.h"
+
+void FLONET2PosePredictor::SetDefaultLookAhead(double Seconds)
+{
+	FScopeLock Lock(&CriticalSection);
+	DefaultLookAhead = FMath::Max(Seconds, 0.0);
+	UpdateEnabled();
+}
+
+void FLONET2PosePredictor::SetSubjectLookAhead(FName SubjectName, double Seconds)
+{
+	FScopeLock Lock(&CriticalSection);
+	SubjectLookAheads.Add(SubjectName, FMath::Max(Seconds, 0.0));
+	UpdateEnabled();
+}
+
+void FLONET2PosePredictor::ResetSubjectLookAheads()
+{
+	FScopeLock Lock(&CriticalSection);
+	SubjectLookAheads.Empty();
+	UpdateEnabled();
+}
+
+void FLONET2PosePredictor::UpdateEnabled()
+{
+	bool bAnyLookAhead = DefaultLookAhead > 0.0;
+	for (const TPair<FName, double>& Pair : SubjectLookAheads)
+	{
+		bAnyLookAhead |= Pair.Value > 0.0;
+	}
+	bEnabled = bAnyLookAhead;
+}
+
+double FLONET2PosePredictor::GetLookAhead(FName SubjectName) const
+{
+	const double* LookAhead = SubjectLookAheads.Find(SubjectName);
+	return LookAhead != nullptr ? *LookAhead : DefaultLookAhead;
+}
+
+void FLONET2PosePredictor::Predict(FName SubjectName, double Seconds, FTransform& InOutTransform, TFunctionRef<void(float PositionError, float RotationErrorDegrees)> ReportError)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const double LookAhead = GetLookAhead(SubjectName);
+	if (LookAhead <= 0.0)
+	{
+		Subjects.Remove(SubjectName);
+		return;
+	}
+
+	FSubject& Subject = Subjects.FindOrAdd(SubjectName);
+
+	const FVector Location = InOutTransform.GetLocation();
+	const FQuat Rotation = InOutTransform.GetRotation().GetNormalized();
+
+	if (Subject.History.Num() > 0)
+	{
+		const FSample& Previous = Subject.History.Last();
+		const double Step = Seconds - Previous.Seconds;
+
+		// Time running backwards (sender restart, replay loop) or a dropout leaves nothing to extrapolate from
+		if (Step < 0.0 || Step > MaxSampleGap)
+		{
+			Subject.History.Reset();
+			Subject.Pending.Reset();
+		}
+		else if (Step > 0.0)
+		{
+			while (Subject.Pending.Num() > 0 && Subject.Pending[0].TargetSeconds <= Seconds)
+			{
+				const FPrediction& Prediction = Subject.Pending[0];
+				const double Alpha = FMath::Clamp((Prediction.TargetSeconds - Previous.Seconds) / Step, 0.0, 1.0);
+				const FVector RealLocation = FMath::Lerp(Previous.Location, Location, Alpha);
+				const FQuat RealRotation = FQuat::Slerp(Previous.Rotation, Rotation, Alpha);
+
+				ReportError(FVector::Dist(RealLocation, Prediction.Location), FMath::RadiansToDegrees(RealRotation.AngularDistance(Prediction.Rotation)));
+				Subject.Pending.RemoveAt(0, 1, false);
+			}
+		}
+	}
+
+	// Samples sharing a time (several sections in one datagram without timecode) add nothing to the velocity
+	if (Subject.History.Num() == 0 || Seconds > Subject.History.Last().Seconds)
+	{
+		if (Subject.History.Num() == HistorySize)
+		{
+			Subject.History.RemoveAt(0, 1, false);
+		}
+		Subject.History.Add({ Seconds, Location, Rotation });
+	}
+
+	if (Subject.History.Num() < 2)
+	{
+		return;
+	}
+
+	const FSample& First = Subject.History[0];
+	const FSample& Last = Subject.History.Last();
+	const double Span = Last.Seconds - First.Seconds;
+
+	const FVector Velocity = (Last.Location - First.Location) / Span;
+
+	// Rotation from the first sample to the last in world space, the short way round
+	FQuat Delta = Last.Rotation * First.Rotation.Inverse();
+	Delta.EnforceShortestArcWith(FQuat::Identity);
+	const FVector Axis = Delta.GetRotationAxis();
+	const double AngularSpeed = Delta.GetAngle() / Span;
+
+	// Extrapolate from the newest sample, which is the one being pushed
+	const FVector PredictedLocation = Location + Velocity * LookAhead;
+	const FQuat PredictedRotation = (FQuat(Axis, AngularSpeed * LookAhead) * Rotation).GetNormalized();
+
+	if (Subject.Pending.Num() < MaxPending)
+	{
+		Subject.Pending.Add({ Seconds + LookAhead, PredictedLocation, PredictedRotation });
+	}
+
+	InOutTransform.SetLocation(PredictedLocation);
+	InOutTransform.SetRotation(PredictedRotation);
+}
+
+void FLONET2PosePredictor::Remove(FName SubjectName)
+{
+	FScopeLock Lock(&CriticalSection);
+	Subjects.Remove(SubjectName);
+}
+
+void FLONET2PosePredictor::Empty()
+{
+	FScopeLock Lock(&CriticalSection);
+	Subjects.Empty();
+}
@@ -0,0 +1,86 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+
+/**
+ * Short horizon pose prediction for camera subjects, to hide the network and decode latency of the tracker.
+ * Linear and angular velocity are estimated over the last few samples of a subject and the pose is extrapolated
+ * by the subject's look-ahead, the orientation along its angular velocity.
+ *
+ * Every prediction is kept until a real sample reaches its target time, then compared with the real pose at that time,
+ * interpolated between the samples around it. That is the prediction error handed to the caller.
+ */
+class FLONET2PosePredictor
+{
+public:
+
+	/** Look-ahead of every subject unless overridden, 0 disables prediction. */
+	void SetDefaultLookAhead(double Seconds);
+
+	void SetSubjectLookAhead(FName SubjectName, double Seconds);
+
+	/** Drops every SetSubjectLookAhead override, the subjects go back to the default look-ahead. */
+	void ResetSubjectLookAheads();
+
+	/** False while no subject has a look-ahead, callers then skip Predict. */
+	bool IsEnabled() const { return bEnabled; }
+
+	/**
+	 * Adds the subject's real pose at Seconds and replaces it with the predicted pose.
+	 * ReportError gets the position (in transform units) and rotation (in degrees) error of every earlier prediction this sample resolves.
+	 */
+	void Predict(FName SubjectName, double Seconds, FTransform& InOutTransform, TFunctionRef<void(float PositionError, float RotationErrorDegrees)> ReportError);
+
+	void Remove(FName SubjectName);
+
+	void Empty();
+
+private:
+
+	struct FSample
+	{
+		double Seconds = 0.0;
+		FVector Location;
+		FQuat Rotation;
+	};
+
+	struct FPrediction
+	{
+		double TargetSeconds = 0.0;
+		FVector Location;
+		FQuat Rotation;
+	};
+
+	/** Samples the velocity is estimated over, more smooth out tracker noise at the cost of reacting later. */
+	static constexpr int32 HistorySize = 4;
+
+	/** Samples further apart than this (dropouts, a paused sender) start the history over. */
+	static constexpr double MaxSampleGap = 0.25;
+
+	/** Predictions waiting for a real sample, more than this means the look-ahead spans many samples and the oldest are not checked. */
+	static constexpr int32 MaxPending = 32;
+
+	struct FSubject
+	{
+		TArray<FSample, TInlineAllocator<HistorySize>> History;
+		TArray<FPrediction, TInlineAllocator<8>> Pending;
+	};
+
+	double GetLookAhead(FName SubjectName) const;
+
+	void UpdateEnabled();
+
+	FCriticalSection CriticalSection;
+
+	TMap<FName, FSubject> Subjects;
+
+	double DefaultLookAhead = 0.0;
+
+	TMap<FName, double> SubjectLookAheads;
+
+	FThreadSafeBool bEnabled;
+};
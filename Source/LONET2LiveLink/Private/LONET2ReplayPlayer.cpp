@@ -0,0 +1,112 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2ReplayPlayer.h"
+
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "LONET2Capture.h"
+#include "LONET2PacketPool.h"
+
+FLONET2ReplayPlayer::FLONET2ReplayPlayer(const FLONET2CaptureReader& InReader, FLONET2PacketPool& InPool, int32 InBatchSize, bool bInRealTime, bool bInLoop, FOnPacketsReceived InOnPacketsReceived,
+	const TCHAR* ThreadName, EThreadPriority Priority, uint64 AffinityMask)
+	: Reader(InReader)
+	, Pool(InPool)
+	, bRealTime(bInRealTime)
+	, bLoop(bInLoop)
+	, OnPacketsReceived(InOnPacketsReceived)
+{
+	Batch.SetNumZeroed(FMath::Max(InBatchSize, 1));
+	StopEvent = FPlatformProcess::GetSynchEventFromPool(true);
+	StartThread(ThreadName, Priority, AffinityMask);
+}
+
+FLONET2ReplayPlayer::~FLONET2ReplayPlayer()
+{
+	StopThread();
+
+	FPlatformProcess::ReturnSynchEventToPool(StopEvent);
+	StopEvent = nullptr;
+}
+
+uint32 FLONET2ReplayPlayer::Run()
+{
+	int64 Offset = Reader.GetFirstRecordOffset();
+	FLONET2CaptureReader::FRecord Record;
+	bool bHasRecord = Reader.Next(Offset, Record);
+
+	double StartTime = FPlatformTime::Seconds();
+	uint64 FirstTimeNs = Record.TimeNs;
+
+	while (!bStopping && bHasRecord)
+	{
+		ApplyThreadAffinity();
+
+		// Hand over everything that is due as one batch, like a receiver wakeup draining the socket
+		int32 NumFilled = 0;
+		bool bPoolExhausted = false;
+		while (bHasRecord && NumFilled < Batch.Num())
+		{
+			if (bRealTime && FPlatformTime::Seconds() < StartTime + (Record.TimeNs - FirstTimeNs) * 1.0e-9)
+			{
+				break;
+			}
+
+			FLONET2Packet* Packet = Pool.Acquire();
+			if (Packet == nullptr)
+			{
+				bPoolExhausted = true;
+				break;
+			}
+
+			if (Record.Num <= Packet->Data.Num())
+			{
+				FMemory::Memcpy(Packet->Data.GetData(), Record.Data, Record.Num);
+				Packet->Data.SetNumUninitialized(Record.Num, false);
+				Packet->Sender = Record.Sender;
+				Packet->ReceiveTime = FPlatformTime::Seconds();
+				Batch[NumFilled++] = Packet;
+			}
+			else
+			{
+				Pool.Release(Packet);
+			}
+
+			bHasRecord = Reader.Next(Offset, Record);
+			if (!bHasRecord && bLoop)
+			{
+				Offset = Reader.GetFirstRecordOffset();
+				bHasRecord = Reader.Next(Offset, Record);
+				StartTime = FPlatformTime::Seconds();
+				FirstTimeNs = Record.TimeNs;
+			}
+		}
+
+		if (NumFilled > 0)
+		{
+			OnPacketsReceived.Execute(MakeArrayView(Batch.GetData(), NumFilled));
+			continue;
+		}
+
+		if (bPoolExhausted || !bRealTime)
+		{
+			// The pool is exhausted, wait for the decode stage to return packets. A due record would otherwise be retried in a busy loop.
+			FPlatformProcess::SleepNoStats(0.001f);
+		}
+		else if (bHasRecord)
+		{
+			// Wait for the next arrival, Stop() ends the wait early
+			const double Wait = StartTime + (Record.TimeNs - FirstTimeNs) * 1.0e-9 - FPlatformTime::Seconds();
+			StopEvent->Wait(FTimespan::FromSeconds(FMath::Clamp(Wait, 0.0, 1.0)));
+		}
+	}
+
+	bFinished = !bHasRecord;
+	return 0;
+}
+
+void FLONET2ReplayPlayer::Stop()
+{
+	bStopping = true;
+	StopEvent->Trigger();
+}
@@ -0,0 +1,57 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "LONET2Runnable.h"
+
+class FEvent;
+class FLONET2CaptureReader;
+class FLONET2PacketPool;
+struct FLONET2Packet;
+
+/**
+ * Plays a capture file back in place of the UDP receiver thread.
+ * Datagrams are handed over in batches exactly like received ones, either at their recorded arrival times or as fast as the pool allows.
+ */
+class FLONET2ReplayPlayer : public FLONET2Runnable
+{
+public:
+
+	/** The handler takes ownership of every packet in the batch, like FLONET2UdpReceiver::FOnPacketsReceived. */
+	DECLARE_DELEGATE_OneParam(FOnPacketsReceived, TArrayView<FLONET2Packet*>);
+
+	FLONET2ReplayPlayer(const FLONET2CaptureReader& InReader, FLONET2PacketPool& InPool, int32 InBatchSize, bool bInRealTime, bool bInLoop, FOnPacketsReceived InOnPacketsReceived,
+		const TCHAR* ThreadName, EThreadPriority Priority = TPri_AboveNormal, uint64 AffinityMask = 0);
+	virtual ~FLONET2ReplayPlayer();
+
+	/** True once the last record was handed over, never when looping. */
+	bool IsFinished() const { return bFinished; }
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable Interface
+
+private:
+
+	const FLONET2CaptureReader& Reader;
+
+	FLONET2PacketPool& Pool;
+
+	bool bRealTime;
+
+	bool bLoop;
+
+	FOnPacketsReceived OnPacketsReceived;
+
+	TArray<FLONET2Packet*> Batch;
+
+	FThreadSafeBool bStopping;
+
+	/** Triggered by Stop() to cut a real time wait short. */
+	FEvent* StopEvent = nullptr;
+
+	FThreadSafeBool bFinished;
+};
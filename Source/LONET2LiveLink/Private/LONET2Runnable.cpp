@@ -0,0 +1,45 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2Runnable.h"
+
+#include "HAL/PlatformAffinity.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+void FLONET2Runnable::StartThread(const TCHAR* ThreadName, EThreadPriority Priority, uint64 AffinityMask)
+{
+	Thread = FRunnableThread::Create(this, ThreadName, 128 * 1024, Priority, AffinityMask != 0 ? AffinityMask : FPlatformAffinity::GetNoAffinityMask());
+}
+
+void FLONET2Runnable::StopThread()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FLONET2Runnable::SetThreadPriority(EThreadPriority Priority)
+{
+	if (Thread != nullptr)
+	{
+		Thread->SetThreadPriority(Priority);
+	}
+}
+
+void FLONET2Runnable::SetThreadAffinityMask(uint64 AffinityMask)
+{
+	PendingAffinityMask = AffinityMask;
+	bAffinityChanged = true;
+}
+
+void FLONET2Runnable::ApplyThreadAffinity()
+{
+	if (bAffinityChanged)
+	{
+		bAffinityChanged = false;
+		FPlatformProcess::SetThreadAffinityMask(PendingAffinityMask != 0 ? PendingAffinityMask : FPlatformAffinity::GetNoAffinityMask());
+	}
+}
@@ -0,0 +1,41 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+
+class FRunnableThread;
+
+/**
+ * Base of the plugin's worker threads, whose priority and CPU affinity can change while they run.
+ * Derived classes start the thread in their constructor and stop it in their destructor, while their members are still alive.
+ */
+class FLONET2Runnable : public FRunnable
+{
+public:
+
+	void SetThreadPriority(EThreadPriority Priority);
+
+	/** Takes effect at the thread's next wakeup, 0 lets it run on any core. */
+	void SetThreadAffinityMask(uint64 AffinityMask);
+
+protected:
+
+	void StartThread(const TCHAR* ThreadName, EThreadPriority Priority, uint64 AffinityMask);
+
+	/** Stops and joins the thread. */
+	void StopThread();
+
+	/** Called by Run() at every wakeup, a thread can only change its own affinity on every platform. */
+	void ApplyThreadAffinity();
+
+private:
+
+	FRunnableThread* Thread = nullptr;
+
+	uint64 PendingAffinityMask = 0;
+
+	FThreadSafeBool bAffinityChanged;
+};
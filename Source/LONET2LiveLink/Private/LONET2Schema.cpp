@@ -0,0 +1,349 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2Schema.h"
+
+#include "LONET2StreamDecoder.h"
+#include "Roles/LiveLinkBasicRole.h"
+#include "Roles/LiveLinkCameraRole.h"
+#include "Roles/LiveLinkCameraTypes.h"
+#include "LiveLinkLensRole.h"
+#include "LiveLinkLensTypes.h"
+
+namespace LONET2Schema
+{
+	using ETarget = EFieldTarget;
+
+	static const FField EncoderFields[] =
+	{
+		{ "cameraName", ETarget::SubjectName, 0, 1 },
+		{ "timecode", ETarget::Timecode, 0, 1 },
+		{ "frameRate", ETarget::FrameRate, 0, 1 },
+		{ "sequence", ETarget::Sequence, 0, 1 },
+		{ "keyframe", ETarget::Keyframe, 0, 1 },
+		{ "focalLengthMapped", ETarget::Float, STRUCT_OFFSET(FLiveLinkCameraFrameData, FocalLength), 1 },
+		{ "irisMapped", ETarget::Float, STRUCT_OFFSET(FLiveLinkCameraFrameData, Aperture), 1 },
+		{ "focusMapped", ETarget::Float, STRUCT_OFFSET(FLiveLinkCameraFrameData, FocusDistance), 1 },
+	};
+
+	// The lens section carries the same mapped encoder values
+	static const FField LensFields[] =
+	{
+		{ "cameraName", ETarget::SubjectName, 0, 1 },
+		{ "timecode", ETarget::Timecode, 0, 1 },
+		{ "frameRate", ETarget::FrameRate, 0, 1 },
+		{ "sequence", ETarget::Sequence, 0, 1 },
+		{ "keyframe", ETarget::Keyframe, 0, 1 },
+		{ "focalLengthMapped", ETarget::Float, STRUCT_OFFSET(FLiveLinkLensFrameData, FocalLength), 1 },
+		{ "irisMapped", ETarget::Float, STRUCT_OFFSET(FLiveLinkLensFrameData, Aperture), 1 },
+		{ "focusMapped", ETarget::Float, STRUCT_OFFSET(FLiveLinkLensFrameData, FocusDistance), 1 },
+		{ "fXfY", ETarget::Vector2D, STRUCT_OFFSET(FLiveLinkLensFrameData, FxFy), 2 },
+		{ "principalPoint", ETarget::Vector2D, STRUCT_OFFSET(FLiveLinkLensFrameData, PrincipalPoint), 2 },
+		{ "distortionParameters", ETarget::FloatArray, STRUCT_OFFSET(FLiveLinkLensFrameData, DistortionParameters), 0 },
+	};
+
+	static const FField CameraFields[] =
+	{
+		{ "cameraName", ETarget::SubjectName, 0, 1 },
+		{ "timecode", ETarget::Timecode, 0, 1 },
+		{ "frameRate", ETarget::FrameRate, 0, 1 },
+		{ "sequence", ETarget::Sequence, 0, 1 },
+		{ "keyframe", ETarget::Keyframe, 0, 1 },
+		{ "position", ETarget::Location, 0, 3 },
+		{ "orientation", ETarget::Rotation, 0, 4 },
+		{ "focalLengthRaw", ETarget::Float, STRUCT_OFFSET(FLiveLinkCameraFrameData, FocalLength), 1 },
+		{ "irisRaw", ETarget::Float, STRUCT_OFFSET(FLiveLinkCameraFrameData, Aperture), 1 },
+		{ "focusRaw", ETarget::Float, STRUCT_OFFSET(FLiveLinkCameraFrameData, FocusDistance), 1 },
+		{ "whiteBalance", ETarget::Properties, 0, 1 },
+		{ "tint", ETarget::Properties, 1, 1 },
+		{ "ISO", ETarget::Properties, 2, 1 },
+		{ "shutter", ETarget::Properties, 3, 1 },
+		{ "sensorSize", ETarget::Properties, 4, 2 },
+	};
+
+	static const FField ControllerFields[] =
+	{
+		{ "controllerName", ETarget::SubjectName, 0, 1 },
+		{ "timecode", ETarget::Timecode, 0, 1 },
+		{ "frameRate", ETarget::FrameRate, 0, 1 },
+		{ "sequence", ETarget::Sequence, 0, 1 },
+		{ "keyframe", ETarget::Keyframe, 0, 1 },
+		{ "button1", ETarget::Properties, 0, 1 },
+		{ "button2", ETarget::Properties, 1, 1 },
+		{ "button3", ETarget::Properties, 2, 1 },
+		{ "trigger", ETarget::Properties, 3, 1 },
+		{ "touchpadPressed", ETarget::Properties, 4, 1 },
+		{ "touchpadX", ETarget::Properties, 5, 1 },
+		{ "touchpadY", ETarget::Properties, 6, 1 },
+	};
+
+	// Field masks have one bit per field
+	static_assert(UE_ARRAY_COUNT(CameraFields) <= 32 && UE_ARRAY_COUNT(LensFields) <= 32, "Too many fields for a field mask");
+
+	static const ANSICHAR* const CameraProperties[] = { "whiteBalance", "tint", "ISO", "shutter", "sensorX", "sensorY" };
+	static const ANSICHAR* const ControllerProperties[] = { "button1", "button2", "button3", "trigger", "touchpadPressed", "touchpadX", "touchpadY" };
+
+	static constexpr uint32 LensFlags = FocalLength | Aperture | FocusDistance;
+
+	/** Indexed by ELONET2Section. */
+	static const FSection Sections[] =
+	{
+		{
+			ELONET2Section::Encoder, "encoder_data",
+			&FLiveLinkCameraFrameData::StaticStruct, &FLiveLinkCameraStaticData::StaticStruct, &ULiveLinkCameraRole::StaticClass,
+			LensFlags, Location | Rotation | Scale | AspectRatio | FieldOfView, nullptr,
+			{}, EncoderFields,
+		},
+		{
+			ELONET2Section::Lens, "distortion_data",
+			&FLiveLinkLensFrameData::StaticStruct, &FLiveLinkLensStaticData::StaticStruct, &ULiveLinkLensRole::StaticClass,
+			LensFlags, Location | Rotation | Scale | AspectRatio | FieldOfView, TEXT("spherical"),
+			{}, LensFields,
+		},
+		{
+			ELONET2Section::Camera, "camera_transform_data",
+			&FLiveLinkCameraFrameData::StaticStruct, &FLiveLinkCameraStaticData::StaticStruct, &ULiveLinkCameraRole::StaticClass,
+			LensFlags | Location | Rotation, Scale, nullptr,
+			CameraProperties, CameraFields,
+		},
+		{
+			ELONET2Section::Controller, "controller_data",
+			&FLiveLinkBaseFrameData::StaticStruct, &FLiveLinkBaseStaticData::StaticStruct, &ULiveLinkBasicRole::StaticClass,
+			0, 0, nullptr,
+			ControllerProperties, ControllerFields,
+		},
+	};
+
+	bool KeyEquals(FAnsiStringView Key, const ANSICHAR* Literal)
+	{
+		int32 Index = 0;
+		for (; Literal[Index]; ++Index)
+		{
+			if (Index >= Key.Len() || FCharAnsi::ToLower(Key[Index]) != FCharAnsi::ToLower(Literal[Index]))
+			{
+				return false;
+			}
+		}
+		return Index == Key.Len();
+	}
+
+	static uint32 HashKey(FAnsiStringView Key, uint32 Seed)
+	{
+		uint32 Hash = 2166136261u ^ Seed;
+		for (const ANSICHAR Char : Key)
+		{
+			Hash = (Hash ^ static_cast<uint8>(FCharAnsi::ToLower(Char))) * 16777619u;
+		}
+		return Hash ^ (Hash >> 15);
+	}
+
+	/**
+	 * Collision free hash of a fixed key set, built once by searching for a seed under which every key gets its own slot.
+	 * A lookup is one hash and one key compare, however many keys the table holds.
+	 */
+	class FPerfectHash
+	{
+	public:
+
+		template <typename KeyOfType>
+		FPerfectHash(int32 NumKeys, KeyOfType KeyOf)
+		{
+			const int32 NumSlots = FMath::RoundUpToPowerOfTwo(FMath::Max(NumKeys * 4, 8));
+			Mask = NumSlots - 1;
+
+			for (Seed = 0; Seed < 65536; ++Seed)
+			{
+				Slots.Init(INDEX_NONE, NumSlots);
+				bool bCollision = false;
+				for (int32 Index = 0; Index < NumKeys && !bCollision; ++Index)
+				{
+					int8& Slot = Slots[HashKey(KeyOf(Index), Seed) & Mask];
+					bCollision = Slot != INDEX_NONE;
+					Slot = static_cast<int8>(Index);
+				}
+				if (!bCollision)
+				{
+					return;
+				}
+			}
+			checkf(false, TEXT("No perfect hash seed found for the LONET 2 schema"));
+		}
+
+		/** Index of the only key that can match, INDEX_NONE if none can. */
+		int32 Find(FAnsiStringView Key) const
+		{
+			return Slots[HashKey(Key, Seed) & Mask];
+		}
+
+	private:
+
+		uint32 Seed = 0;
+		uint32 Mask = 0;
+		TArray<int8, TInlineAllocator<64>> Slots;
+	};
+
+	static const FPerfectHash& GetSectionHash()
+	{
+		static const FPerfectHash Hash(UE_ARRAY_COUNT(Sections), [](int32 Index) { return FAnsiStringView(Sections[Index].JsonKey); });
+		return Hash;
+	}
+
+	static const FPerfectHash& GetFieldHash(const FSection& Section)
+	{
+		static const FPerfectHash Hashes[] =
+		{
+			FPerfectHash(Sections[0].Fields.Num(), [](int32 Index) { return FAnsiStringView(Sections[0].Fields[Index].Key); }),
+			FPerfectHash(Sections[1].Fields.Num(), [](int32 Index) { return FAnsiStringView(Sections[1].Fields[Index].Key); }),
+			FPerfectHash(Sections[2].Fields.Num(), [](int32 Index) { return FAnsiStringView(Sections[2].Fields[Index].Key); }),
+			FPerfectHash(Sections[3].Fields.Num(), [](int32 Index) { return FAnsiStringView(Sections[3].Fields[Index].Key); }),
+		};
+		static_assert(UE_ARRAY_COUNT(Hashes) == UE_ARRAY_COUNT(Sections), "One field hash per section");
+		return Hashes[static_cast<int32>(Section.Section)];
+	}
+
+	TArrayView<const FSection> GetSections()
+	{
+		return Sections;
+	}
+
+	const FSection& GetSection(ELONET2Section Section)
+	{
+		const FSection& Result = Sections[static_cast<int32>(Section)];
+		checkSlow(Result.Section == Section);
+		return Result;
+	}
+
+	const FSection* FindSection(FAnsiStringView JsonKey)
+	{
+		const int32 Index = GetSectionHash().Find(JsonKey);
+		return Index != INDEX_NONE && KeyEquals(JsonKey, Sections[Index].JsonKey) ? &Sections[Index] : nullptr;
+	}
+
+	const FField* FindField(const FSection& Section, FAnsiStringView Key)
+	{
+		const int32 Index = GetFieldHash(Section).Find(Key);
+		return Index != INDEX_NONE && KeyEquals(Key, Section.Fields[Index].Key) ? &Section.Fields[Index] : nullptr;
+	}
+
+	FLiveLinkFrameDataStruct MakeFrame(const FSection& Section)
+	{
+		FLiveLinkFrameDataStruct Frame(Section.FrameStruct());
+		Frame.GetBaseData()->PropertyValues.SetNumZeroed(Section.PropertyNames.Num());
+		if (FLiveLinkLensFrameData* LensFrame = Frame.Cast<FLiveLinkLensFrameData>())
+		{
+			LensFrame->ProjectionMode = ELiveLinkCameraProjectionMode::Perspective;
+		}
+		return Frame;
+	}
+
+	FLiveLinkStaticDataStruct MakeStaticData(const FSection& Section)
+	{
+		FLiveLinkStaticDataStruct StaticData(Section.StaticStruct());
+
+		TArray<FName>& PropertyNames = StaticData.GetBaseData()->PropertyNames;
+		for (const ANSICHAR* PropertyName : Section.PropertyNames)
+		{
+			PropertyNames.Add(FName(PropertyName));
+		}
+
+		if (FLiveLinkCameraStaticData* CameraData = StaticData.Cast<FLiveLinkCameraStaticData>())
+		{
+			auto Apply = [&Section](uint32 Flag, bool& bSupported)
+			{
+				if (Section.SupportedFlags & Flag)
+				{
+					bSupported = true;
+				}
+				else if (Section.UnsupportedFlags & Flag)
+				{
+					bSupported = false;
+				}
+			};
+			Apply(FocalLength, CameraData->bIsFocalLengthSupported);
+			Apply(Aperture, CameraData->bIsApertureSupported);
+			Apply(FocusDistance, CameraData->bIsFocusDistanceSupported);
+			Apply(Location, CameraData->bIsLocationSupported);
+			Apply(Rotation, CameraData->bIsRotationSupported);
+			Apply(Scale, CameraData->bIsScaleSupported);
+			Apply(AspectRatio, CameraData->bIsAspectRatioSupported);
+			Apply(FieldOfView, CameraData->bIsFieldOfViewSupported);
+		}
+
+		if (FLiveLinkLensStaticData* LensData = StaticData.Cast<FLiveLinkLensStaticData>())
+		{
+			LensData->LensModel = Section.LensModel;
+		}
+
+		return StaticData;
+	}
+
+	void WriteNumbers(const FField& Field, const double* Values, int32 Count, FLiveLinkBaseFrameData& Frame)
+	{
+		if (Count < Field.Count)
+		{
+			return;
+		}
+
+		uint8* const Target = reinterpret_cast<uint8*>(&Frame) + Field.Offset;
+		switch (Field.Target)
+		{
+		case ETarget::Float:
+			*reinterpret_cast<float*>(Target) = Values[0];
+			break;
+		case ETarget::Vector2D:
+			*reinterpret_cast<FVector2D*>(Target) = FVector2D(Values[0], Values[1]);
+			break;
+		case ETarget::Properties:
+			for (int32 Index = 0; Index < Field.Count; ++Index)
+			{
+				Frame.PropertyValues[Field.Offset + Index] = Values[Index];
+			}
+			break;
+		case ETarget::Location:
+			static_cast<FLiveLinkTransformFrameData&>(Frame).Transform.SetLocation(FVector(Values[0], Values[1], Values[2]));
+			break;
+		case ETarget::Rotation:
+			static_cast<FLiveLinkTransformFrameData&>(Frame).Transform.SetRotation(FQuat(Values[0], Values[1], Values[2], Values[3]));
+			break;
+		default:
+			break;
+		}
+	}
+
+	TArray<float>& GetFloatArray(const FField& Field, FLiveLinkBaseFrameData& Frame)
+	{
+		check(Field.Target == ETarget::FloatArray);
+		return *reinterpret_cast<TArray<float>*>(reinterpret_cast<uint8*>(&Frame) + Field.Offset);
+	}
+
+	void CopyField(const FField& Field, const FLiveLinkBaseFrameData& From, FLiveLinkBaseFrameData& To)
+	{
+		const uint8* const Source = reinterpret_cast<const uint8*>(&From) + Field.Offset;
+		uint8* const Target = reinterpret_cast<uint8*>(&To) + Field.Offset;
+		switch (Field.Target)
+		{
+		case ETarget::Float:
+			*reinterpret_cast<float*>(Target) = *reinterpret_cast<const float*>(Source);
+			break;
+		case ETarget::Vector2D:
+			*reinterpret_cast<FVector2D*>(Target) = *reinterpret_cast<const FVector2D*>(Source);
+			break;
+		case ETarget::FloatArray:
+			*reinterpret_cast<TArray<float>*>(Target) = *reinterpret_cast<const TArray<float>*>(Source);
+			break;
+		case ETarget::Properties:
+			for (int32 Index = Field.Offset; Index < Field.Offset + Field.Count && Index < From.PropertyValues.Num() && Index < To.PropertyValues.Num(); ++Index)
+			{
+				To.PropertyValues[Index] = From.PropertyValues[Index];
+			}
+			break;
+		case ETarget::Location:
+			static_cast<FLiveLinkTransformFrameData&>(To).Transform.SetLocation(static_cast<const FLiveLinkTransformFrameData&>(From).Transform.GetLocation());
+			break;
+		case ETarget::Rotation:
+			static_cast<FLiveLinkTransformFrameData&>(To).Transform.SetRotation(static_cast<const FLiveLinkTransformFrameData&>(From).Transform.GetRotation());
+			break;
+		default:
+			break;
+		}
+	}
+}
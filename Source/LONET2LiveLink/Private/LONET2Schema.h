@@ -0,0 +1,112 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LiveLinkTypes.h"
+
+enum class ELONET2Section : uint8;
+
+/**
+ * The LONET 2 JSON sections, each described once: its key, LiveLink role, static data and where every field lands in the frame struct.
+ * Both JSON decoders and the static data setup are driven by these tables, so a new field or message type is a table entry.
+ */
+namespace LONET2Schema
+{
+	/** Where a field is written. */
+	enum class EFieldTarget : uint8
+	{
+		SubjectName,
+		Timecode,
+		FrameRate,
+		/** One number into the float at Offset. */
+		Float,
+		/** Count numbers into PropertyValues, from index Offset on. */
+		Properties,
+		/** Two numbers into the FVector2D at Offset. */
+		Vector2D,
+		/** A number array of any length into the TArray<float> at Offset. */
+		FloatArray,
+		/** x, y, z into the transform location. */
+		Location,
+		/** x, y, z, w into the transform rotation. */
+		Rotation,
+		/** Keyframe and delta mode, see FLONET2DeltaState. */
+		Sequence,
+		Keyframe,
+	};
+
+	struct FField
+	{
+		const ANSICHAR* Key;
+		EFieldTarget Target;
+		/** Byte offset in the frame struct, or the first property index. */
+		uint16 Offset;
+		/** Numbers the field holds, more than one is a JSON array. */
+		uint8 Count;
+	};
+
+	/** Static data capabilities of camera and lens subjects. */
+	enum EStaticFlags : uint32
+	{
+		FocalLength = 1 << 0,
+		Aperture = 1 << 1,
+		FocusDistance = 1 << 2,
+		Location = 1 << 3,
+		Rotation = 1 << 4,
+		Scale = 1 << 5,
+		AspectRatio = 1 << 6,
+		FieldOfView = 1 << 7,
+	};
+
+	struct FSection
+	{
+		ELONET2Section Section;
+		const ANSICHAR* JsonKey;
+
+		UScriptStruct* (*FrameStruct)();
+		UScriptStruct* (*StaticStruct)();
+		UClass* (*Role)();
+
+		/** Capabilities set to true and to false, those in neither keep the struct's default. */
+		uint32 SupportedFlags;
+		uint32 UnsupportedFlags;
+
+		/** Lens model of lens subjects. */
+		const TCHAR* LensModel;
+
+		TArrayView<const ANSICHAR* const> PropertyNames;
+		TArrayView<const FField> Fields;
+	};
+
+	/** Every section, in the order the FJsonObject decoder reads them. */
+	TArrayView<const FSection> GetSections();
+
+	const FSection& GetSection(ELONET2Section Section);
+
+	/** FJsonObject keys are FString map keys, so key compares are case insensitive. */
+	bool KeyEquals(FAnsiStringView Key, const ANSICHAR* Literal);
+
+	/** Perfect hash lookups, case insensitive like FJsonObject keys. nullptr for unknown keys. */
+	const FSection* FindSection(FAnsiStringView JsonKey);
+	const FField* FindField(const FSection& Section, FAnsiStringView Key);
+
+	/** New frame of the section's struct, with its property values and projection mode set up. */
+	FLiveLinkFrameDataStruct MakeFrame(const FSection& Section);
+
+	FLiveLinkStaticDataStruct MakeStaticData(const FSection& Section);
+
+	/** Writes a Float, Properties, Vector2D, Location or Rotation field. Arrays shorter than the field are ignored. */
+	void WriteNumbers(const FField& Field, const double* Values, int32 Count, FLiveLinkBaseFrameData& Frame);
+
+	TArray<float>& GetFloatArray(const FField& Field, FLiveLinkBaseFrameData& Frame);
+
+	/** Copies a number or number array field from one frame of the section's struct to another. */
+	void CopyField(const FField& Field, const FLiveLinkBaseFrameData& From, FLiveLinkBaseFrameData& To);
+
+	/** Bit of the field in a section's field mask. */
+	inline uint32 GetFieldBit(const FSection& Section, const FField& Field)
+	{
+		return 1u << static_cast<uint32>(&Field - Section.Fields.GetData());
+	}
+}
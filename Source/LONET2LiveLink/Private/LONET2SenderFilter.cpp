@@ -0,0 +1,75 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2SenderFilter.h"
+
+#include "LONET2PacketPool.h"
+#include "Misc/ScopeRWLock.h"
+
+void FLONET2SenderFilter::Set(TArray<FIPv4Address> InAllowed, TArray<FIPv4Address> InDenied)
+{
+	FWriteScopeLock WriteLock(Lock);
+	Allowed = MoveTemp(InAllowed);
+	Denied = MoveTemp(InDenied);
+	bEnabled = Allowed.Num() > 0 || Denied.Num() > 0;
+}
+
+bool FLONET2SenderFilter::IsAllowed(const FIPv4Address& Sender) const
+{
+	if (!bEnabled)
+	{
+		return true;
+	}
+
+	FReadScopeLock ReadLock(Lock);
+	return IsAllowedLocked(Sender);
+}
+
+bool FLONET2SenderFilter::IsAllowedLocked(const FIPv4Address& Sender) const
+{
+	// A handful of devices per stage, a linear scan beats hashing
+	return (Allowed.Num() == 0 || Allowed.Contains(Sender)) && !Denied.Contains(Sender);
+}
+
+int32 FLONET2SenderFilter::Filter(TArrayView<FLONET2Packet*> Packets, FLONET2PacketPool& Pool)
+{
+	if (!bEnabled)
+	{
+		return Packets.Num();
+	}
+
+	FReadScopeLock ReadLock(Lock);
+
+	int32 NumKept = 0;
+	for (int32 Index = 0; Index < Packets.Num(); ++Index)
+	{
+		if (IsAllowedLocked(Packets[Index]->Sender.Address))
+		{
+			Packets[NumKept++] = Packets[Index];
+		}
+		else
+		{
+			Pool.Release(Packets[Index]);
+		}
+	}
+
+	RejectedCount.Add(Packets.Num() - NumKept);
+	return NumKept;
+}
+
+bool FLONET2SenderFilter::ParseAddresses(const FString& String, TArray<FIPv4Address>& OutAddresses)
+{
+	TArray<FString> Entries;
+	String.Replace(TEXT(";"), TEXT(",")).ParseIntoArray(Entries, TEXT(","));
+
+	OutAddresses.Reset(Entries.Num());
+	for (const FString& Entry : Entries)
+	{
+		FIPv4Address Address;
+		if (!FIPv4Address::Parse(Entry.TrimStartAndEnd(), Address))
+		{
+			return false;
+		}
+		OutAddresses.AddUnique(Address);
+	}
+	return true;
+}
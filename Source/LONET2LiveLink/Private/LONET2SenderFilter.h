@@ -0,0 +1,54 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+
+class FLONET2PacketPool;
+struct FLONET2Packet;
+
+/**
+ * Allow and deny lists of sender addresses, checked on the receive thread before a datagram is captured, queued or decoded.
+ * With an allow list only its senders pass, the deny list is checked on top. Lists are set from the game thread.
+ */
+class FLONET2SenderFilter
+{
+public:
+
+	void Set(TArray<FIPv4Address> InAllowed, TArray<FIPv4Address> InDenied);
+
+	/** False while both lists are empty, callers then skip the filter. */
+	bool IsEnabled() const { return bEnabled; }
+
+	bool IsAllowed(const FIPv4Address& Sender) const;
+
+	/**
+	 * Moves the packets of allowed senders to the front of Packets and releases the others to the pool.
+	 * Returns how many packets are left.
+	 */
+	int32 Filter(TArrayView<FLONET2Packet*> Packets, FLONET2PacketPool& Pool);
+
+	/** Datagrams dropped by Filter. */
+	uint64 GetRejectedCount() const { return RejectedCount.GetValue(); }
+
+	/** Parses a comma or semicolon separated address list such as "10.0.0.21, 10.0.0.22". False if any entry is invalid. */
+	static bool ParseAddresses(const FString& String, TArray<FIPv4Address>& OutAddresses);
+
+private:
+
+	bool IsAllowedLocked(const FIPv4Address& Sender) const;
+
+	mutable FRWLock Lock;
+
+	TArray<FIPv4Address> Allowed;
+
+	TArray<FIPv4Address> Denied;
+
+	FThreadSafeBool bEnabled;
+
+	FThreadSafeCounter64 RejectedCount;
+};
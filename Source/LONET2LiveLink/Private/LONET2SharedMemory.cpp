@@ -0,0 +1,32 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2SharedMemory.h"
+
+#include "LONET2SharedMemoryRing.h"
+
+TUniquePtr<FLONET2SharedMemoryWriter> FLONET2SharedMemoryWriter::Create(const FString& Name, int32 Capacity)
+{
+	TUniquePtr<FLONET2SharedMemoryRing> Ring = FLONET2SharedMemoryRing::Open(Name, Capacity, true);
+	if (!Ring.IsValid())
+	{
+		return nullptr;
+	}
+	return TUniquePtr<FLONET2SharedMemoryWriter>(new FLONET2SharedMemoryWriter(MoveTemp(Ring)));
+}
+
+FLONET2SharedMemoryWriter::FLONET2SharedMemoryWriter(TUniquePtr<FLONET2SharedMemoryRing> InRing)
+	: Ring(MoveTemp(InRing))
+{
+}
+
+FLONET2SharedMemoryWriter::~FLONET2SharedMemoryWriter() = default;
+
+bool FLONET2SharedMemoryWriter::Write(const uint8* Data, int32 Num)
+{
+	return Ring->Write(Data, Num);
+}
+
+int32 FLONET2SharedMemoryWriter::GetMaxDatagramSize() const
+{
+	return Ring->GetMaxPayloadSize();
+}
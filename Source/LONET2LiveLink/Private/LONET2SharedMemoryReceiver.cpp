@@ -0,0 +1,85 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2SharedMemoryReceiver.h"
+
+#include "HAL/PlatformProcess.h"
+#include "LONET2PacketPool.h"
+#include "LONET2SharedMemoryRing.h"
+#include "LONET2Stats.h"
+
+FLONET2SharedMemoryReceiver::FLONET2SharedMemoryReceiver(FLONET2SharedMemoryRing& InRing, FLONET2PacketPool& InPool, FTimespan InWaitTime, int32 InBatchSize,
+	FOnPacketsReceived InOnPacketsReceived, const TCHAR* ThreadName, EThreadPriority Priority, uint64 AffinityMask)
+	: Ring(InRing)
+	, WaitTimeTicks(InWaitTime.GetTicks())
+	, OnPacketsReceived(InOnPacketsReceived)
+	, Batch(InPool, InBatchSize)
+{
+	StartThread(ThreadName, Priority, AffinityMask);
+}
+
+FLONET2SharedMemoryReceiver::~FLONET2SharedMemoryReceiver()
+{
+	StopThread();
+}
+
+void FLONET2SharedMemoryReceiver::SetWaitTime(FTimespan InWaitTime)
+{
+	WaitTimeTicks.Set(InWaitTime.GetTicks());
+}
+
+uint32 FLONET2SharedMemoryReceiver::Run()
+{
+	while (!bStopping)
+	{
+		ApplyThreadAffinity();
+
+		if (!Ring.WaitForData(FTimespan(WaitTimeTicks.GetValue())))
+		{
+			continue;
+		}
+
+		bool bPoolExhausted = false;
+		while (!bStopping && ReceiveBatch(bPoolExhausted))
+		{
+		}
+
+		if (bPoolExhausted)
+		{
+			// Every packet is still queued for decoding, the writer overtakes us if this lasts and the loss is counted
+			FPlatformProcess::SleepNoStats(0.001f);
+		}
+	}
+
+	Batch.Release();
+
+	return 0;
+}
+
+bool FLONET2SharedMemoryReceiver::ReceiveBatch(bool& bOutPoolExhausted)
+{
+	const TArrayView<FLONET2Packet*> Packets = Batch.Refill();
+	if (Packets.Num() == 0)
+	{
+		bOutPoolExhausted = true;
+		return false;
+	}
+
+	int32 NumReceived = 0;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LONET2_Receive);
+		NumReceived = Ring.ReceiveBatch(Packets);
+	}
+	if (NumReceived > 0)
+	{
+		OnPacketsReceived.Execute(Packets.Left(NumReceived));
+		Batch.HandOver(NumReceived);
+	}
+
+	return NumReceived == Packets.Num();
+}
+
+void FLONET2SharedMemoryReceiver::Stop()
+{
+	bStopping = true;
+	Ring.WakeReaders();
+}
@@ -0,0 +1,51 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "LONET2PacketPool.h"
+#include "LONET2Runnable.h"
+
+class FLONET2SharedMemoryRing;
+
+/**
+ * Receive thread for a LONET 2 shared memory ring, the same-host counterpart of FLONET2UdpReceiver.
+ * The thread sleeps on the ring's futex and every wakeup drains the committed records into pooled packets, handed over in batches.
+ */
+class FLONET2SharedMemoryReceiver : public FLONET2Runnable
+{
+public:
+
+	/** The handler takes ownership of every packet in the batch and releases them to the pool once decoded. */
+	DECLARE_DELEGATE_OneParam(FOnPacketsReceived, TArrayView<FLONET2Packet*>);
+
+	FLONET2SharedMemoryReceiver(FLONET2SharedMemoryRing& InRing, FLONET2PacketPool& InPool, FTimespan InWaitTime, int32 InBatchSize, FOnPacketsReceived InOnPacketsReceived,
+		const TCHAR* ThreadName, EThreadPriority Priority = TPri_AboveNormal, uint64 AffinityMask = 0);
+	virtual ~FLONET2SharedMemoryReceiver();
+
+	/** Longest wait between wakeups without data, used from the next wait on. Stop() wakes the thread at once. */
+	void SetWaitTime(FTimespan InWaitTime);
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable Interface
+
+private:
+
+	/** Reads one batch from the ring and hands it over, false once the ring is drained or the pool is empty. */
+	bool ReceiveBatch(bool& bOutPoolExhausted);
+
+	FLONET2SharedMemoryRing& Ring;
+
+	/** FTimespan ticks, set from the game thread. */
+	FThreadSafeCounter64 WaitTimeTicks;
+
+	FOnPacketsReceived OnPacketsReceived;
+
+	FLONET2PacketBatch Batch;
+
+	FThreadSafeBool bStopping;
+};
@@ -0,0 +1,365 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2SharedMemoryRing.h"
+
+#include "LONET2LiveLinkSource.h"
+#include "LONET2PacketPool.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+#if PLATFORM_LINUX
+
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+struct FLONET2SharedMemoryRing::FHeader
+{
+	std::atomic<uint32> Magic;
+	uint32 Version;
+	uint32 Capacity;
+	uint32 NextSequence;
+	alignas(64) std::atomic<uint64> Reserved;
+	alignas(64) std::atomic<uint64> Committed;
+	alignas(64) std::atomic<uint32> Futex;
+	std::atomic<uint32> Waiters;
+};
+
+namespace LONET2SharedMemoryRing
+{
+	static constexpr uint32 Magic = 0x32544E4C;
+	static constexpr uint32 Version = 1;
+	static constexpr uint32 WrapMarker = 0xFFFFFFFF;
+	static constexpr uint32 RecordHeaderSize = 8;
+	static constexpr int32 MinCapacity = 64 * 1024;
+
+	static_assert(std::atomic<uint64>::is_always_lock_free && std::atomic<uint32>::is_always_lock_free, "The ring header is shared between processes");
+
+	// Not FUTEX_PRIVATE_FLAG, the word is shared between processes
+	static long Futex(std::atomic<uint32>& Word, int Operation, uint32 Value, const timespec* Timeout = nullptr)
+	{
+		return syscall(SYS_futex, reinterpret_cast<uint32*>(&Word), Operation, Value, Timeout, nullptr, 0);
+	}
+}
+
+TUniquePtr<FLONET2SharedMemoryRing> FLONET2SharedMemoryRing::Open(const FString& Name, int32 InCapacity, bool bWriter)
+{
+	using namespace LONET2SharedMemoryRing;
+
+	static_assert(sizeof(FHeader) == 256, "The ring header layout is part of the transport");
+
+	const FTCHARToUTF8 Path(*(TEXT("/") + Name));
+	const uint32 CreateCapacity = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(InCapacity, MinCapacity)));
+
+	bool bCreated = false;
+	int Fd = shm_open(Path.Get(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+	if (Fd >= 0)
+	{
+		bCreated = true;
+		if (ftruncate(Fd, sizeof(FHeader) + CreateCapacity) != 0)
+		{
+			UE_LOG(ModuleLog, Error, TEXT("Failed to size shared memory ring %s (errno %d)"), *Name, errno);
+			close(Fd);
+			shm_unlink(Path.Get());
+			return nullptr;
+		}
+	}
+	else if (errno == EEXIST)
+	{
+		Fd = shm_open(Path.Get(), O_RDWR | O_CLOEXEC, 0);
+	}
+	if (Fd < 0)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Failed to open shared memory ring %s (errno %d)"), *Name, errno);
+		return nullptr;
+	}
+
+	TUniquePtr<FLONET2SharedMemoryRing> Result(new FLONET2SharedMemoryRing());
+	Result->Fd = Fd;
+
+	if (bWriter && flock(Fd, LOCK_EX | LOCK_NB) != 0)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Shared memory ring %s already has a writer"), *Name);
+		return nullptr;
+	}
+
+	uint32 RingCapacity = CreateCapacity;
+	if (!bCreated)
+	{
+		// The creator may still be sizing the ring and filling in its header
+		const double Timeout = FPlatformTime::Seconds() + 1.0;
+		for (;;)
+		{
+			struct stat Stat;
+			if (fstat(Fd, &Stat) == 0 && Stat.st_size >= static_cast<off_t>(sizeof(FHeader)))
+			{
+				void* Mapping = mmap(nullptr, sizeof(FHeader), PROT_READ, MAP_SHARED, Fd, 0);
+				if (Mapping != MAP_FAILED)
+				{
+					const FHeader* Existing = static_cast<const FHeader*>(Mapping);
+					const bool bReady = Existing->Magic.load(std::memory_order_acquire) == Magic;
+					const bool bValid = bReady && Existing->Version == Version && FMath::IsPowerOfTwo(Existing->Capacity)
+						&& Stat.st_size >= static_cast<off_t>(sizeof(FHeader) + Existing->Capacity);
+					RingCapacity = Existing->Capacity;
+					munmap(Mapping, sizeof(FHeader));
+
+					if (bValid)
+					{
+						break;
+					}
+					if (bReady)
+					{
+						UE_LOG(ModuleLog, Error, TEXT("Shared memory ring %s has an unsupported layout"), *Name);
+						return nullptr;
+					}
+				}
+			}
+			if (FPlatformTime::Seconds() > Timeout)
+			{
+				UE_LOG(ModuleLog, Error, TEXT("Shared memory ring %s was never initialized"), *Name);
+				return nullptr;
+			}
+			FPlatformProcess::SleepNoStats(0.01f);
+		}
+	}
+
+	void* Mapping = mmap(nullptr, sizeof(FHeader) + RingCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+	if (Mapping == MAP_FAILED)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Failed to map shared memory ring %s (errno %d)"), *Name, errno);
+		return nullptr;
+	}
+
+	Result->Header = static_cast<FHeader*>(Mapping);
+	Result->Data = static_cast<uint8*>(Mapping) + sizeof(FHeader);
+	Result->Capacity = RingCapacity;
+
+	FHeader& RingHeader = *Result->Header;
+	if (bCreated)
+	{
+		RingHeader.Version = Version;
+		RingHeader.Capacity = RingCapacity;
+		RingHeader.NextSequence = 0;
+		RingHeader.Reserved.store(0, std::memory_order_relaxed);
+		RingHeader.Committed.store(0, std::memory_order_relaxed);
+		RingHeader.Futex.store(0, std::memory_order_relaxed);
+		RingHeader.Waiters.store(0, std::memory_order_relaxed);
+		RingHeader.Magic.store(Magic, std::memory_order_release);
+	}
+
+	if (bWriter)
+	{
+		// A writer that died mid-record left Reserved ahead, the record was never committed
+		RingHeader.Reserved.store(RingHeader.Committed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	Result->ReadOffset = RingHeader.Committed.load(std::memory_order_acquire);
+
+	return Result;
+}
+
+FLONET2SharedMemoryRing::~FLONET2SharedMemoryRing()
+{
+	if (Header != nullptr)
+	{
+		munmap(Header, sizeof(FHeader) + Capacity);
+		Header = nullptr;
+	}
+
+	// The ring stays for the other side, and for a restarted writer to carry on
+	if (Fd >= 0)
+	{
+		close(Fd);
+		Fd = -1;
+	}
+}
+
+bool FLONET2SharedMemoryRing::Write(const uint8* Payload, int32 Num)
+{
+	using namespace LONET2SharedMemoryRing;
+
+	if (Num < 0 || Num > GetMaxPayloadSize())
+	{
+		return false;
+	}
+
+	const uint64 Offset = Header->Committed.load(std::memory_order_relaxed);
+	uint32 Position = static_cast<uint32>(Offset & (Capacity - 1));
+	const uint32 RecordSize = Align(RecordHeaderSize + static_cast<uint32>(Num), 8);
+	const uint32 WrapSize = Capacity - Position < RecordSize ? Capacity - Position : 0;
+	const uint64 End = Offset + WrapSize + RecordSize;
+
+	// Readers copying anything up to End minus Capacity see this and drop their copy
+	Header->Reserved.store(End, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	if (WrapSize > 0)
+	{
+		FMemory::Memcpy(Data + Position, &WrapMarker, sizeof(WrapMarker));
+		Position = 0;
+	}
+
+	const uint32 Size = static_cast<uint32>(Num);
+	const uint32 Sequence = Header->NextSequence++;
+	FMemory::Memcpy(Data + Position, &Size, sizeof(Size));
+	FMemory::Memcpy(Data + Position + sizeof(Size), &Sequence, sizeof(Sequence));
+	FMemory::Memcpy(Data + Position + RecordHeaderSize, Payload, Num);
+
+	Header->Committed.store(End, std::memory_order_release);
+	Header->Futex.fetch_add(1, std::memory_order_seq_cst);
+	if (Header->Waiters.load(std::memory_order_seq_cst) != 0)
+	{
+		Futex(Header->Futex, FUTEX_WAKE, INT_MAX);
+	}
+	return true;
+}
+
+bool FLONET2SharedMemoryRing::WaitForData(FTimespan WaitTime)
+{
+	using namespace LONET2SharedMemoryRing;
+
+	// Read before Committed, so a record committed after the check changes the word and the wait returns at once
+	const uint32 Sequence = Header->Futex.load(std::memory_order_seq_cst);
+	if (Header->Committed.load(std::memory_order_seq_cst) != ReadOffset)
+	{
+		return true;
+	}
+
+	const int64 Nanoseconds = WaitTime.GetTicks() * ETimespan::NanosecondsPerTick;
+	timespec Timeout;
+	Timeout.tv_sec = static_cast<time_t>(Nanoseconds / 1000000000);
+	Timeout.tv_nsec = static_cast<long>(Nanoseconds % 1000000000);
+
+	Header->Waiters.fetch_add(1, std::memory_order_seq_cst);
+	Futex(Header->Futex, FUTEX_WAIT, Sequence, &Timeout);
+	Header->Waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+	return Header->Committed.load(std::memory_order_acquire) != ReadOffset;
+}
+
+void FLONET2SharedMemoryRing::WakeReaders()
+{
+	using namespace LONET2SharedMemoryRing;
+
+	Header->Futex.fetch_add(1, std::memory_order_seq_cst);
+	Futex(Header->Futex, FUTEX_WAKE, INT_MAX);
+}
+
+int32 FLONET2SharedMemoryRing::ReceiveBatch(TArrayView<FLONET2Packet*> Packets)
+{
+	using namespace LONET2SharedMemoryRing;
+
+	const uint64 Committed = Header->Committed.load(std::memory_order_acquire);
+
+	// Overtaken by a whole ring, what is left of the old records is being overwritten. The sequence numbers count the loss.
+	if (static_cast<int64>(Committed - ReadOffset) > static_cast<int64>(Capacity) || static_cast<int64>(Committed - ReadOffset) < 0)
+	{
+		ReadOffset = Committed;
+	}
+
+	const double ReceiveTime = FPlatformTime::Seconds();
+
+	int32 NumFilled = 0;
+	while (NumFilled < Packets.Num() && static_cast<int64>(Committed - ReadOffset) > 0)
+	{
+		const uint32 Position = static_cast<uint32>(ReadOffset & (Capacity - 1));
+
+		uint32 Size = 0;
+		uint32 Sequence = 0;
+		FMemory::Memcpy(&Size, Data + Position, sizeof(Size));
+		if (Size == WrapMarker)
+		{
+			// The marker may itself be a record being overwritten, trust it only if the writer has not come round to it
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (static_cast<int64>(Header->Reserved.load(std::memory_order_relaxed) - ReadOffset) > static_cast<int64>(Capacity))
+			{
+				ReadOffset = Header->Committed.load(std::memory_order_acquire);
+				break;
+			}
+			ReadOffset += Capacity - Position;
+			continue;
+		}
+		FMemory::Memcpy(&Sequence, Data + Position + sizeof(Size), sizeof(Sequence));
+
+		FLONET2Packet& Packet = *Packets[NumFilled];
+		const bool bFits = Size <= Capacity - Position - RecordHeaderSize;
+		const bool bTruncated = bFits && Size > static_cast<uint32>(Packet.Data.Num());
+		if (bFits && !bTruncated)
+		{
+			FMemory::Memcpy(Packet.Data.GetData(), Data + Position + RecordHeaderSize, Size);
+		}
+
+		// A record the writer started to overwrite meanwhile is garbage, and so is everything read after it
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (!bFits || static_cast<int64>(Header->Reserved.load(std::memory_order_relaxed) - ReadOffset) > static_cast<int64>(Capacity))
+		{
+			ReadOffset = Header->Committed.load(std::memory_order_acquire);
+			break;
+		}
+
+		if (bHasReadSequence && Sequence != NextReadSequence)
+		{
+			LostCount.Add(static_cast<uint32>(Sequence - NextReadSequence));
+		}
+		NextReadSequence = Sequence + 1;
+		bHasReadSequence = true;
+
+		ReadOffset += Align(RecordHeaderSize + Size, 8);
+
+		if (bTruncated)
+		{
+			++TruncatedCount;
+			continue;
+		}
+
+		Packet.Data.SetNumUninitialized(Size, false);
+		// No network sender, Any keeps the subjects out of the per sender namespaces
+		Packet.Sender = FIPv4Endpoint::Any;
+		Packet.ReceiveTime = ReceiveTime;
+		++NumFilled;
+	}
+
+	return NumFilled;
+}
+
+#else
+
+struct FLONET2SharedMemoryRing::FHeader
+{
+};
+
+TUniquePtr<FLONET2SharedMemoryRing> FLONET2SharedMemoryRing::Open(const FString& Name, int32 InCapacity, bool bWriter)
+{
+	UE_LOG(ModuleLog, Error, TEXT("Shared memory ring %s: the shared memory transport is only available on Linux"), *Name);
+	return nullptr;
+}
+
+FLONET2SharedMemoryRing::~FLONET2SharedMemoryRing() = default;
+
+bool FLONET2SharedMemoryRing::Write(const uint8* Payload, int32 Num)
+{
+	return false;
+}
+
+bool FLONET2SharedMemoryRing::WaitForData(FTimespan WaitTime)
+{
+	return false;
+}
+
+void FLONET2SharedMemoryRing::WakeReaders()
+{
+}
+
+int32 FLONET2SharedMemoryRing::ReceiveBatch(TArrayView<FLONET2Packet*> Packets)
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,88 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+struct FLONET2Packet;
+
+/**
+ * POSIX shared memory ring carrying LONET 2 datagrams between processes on one host, Linux only.
+ *
+ * Layout, all integers little endian: a 256 byte header, then Capacity bytes of records.
+ *   0   uint32 Magic 'LNT2', written last by the creator
+ *   4   uint32 Version
+ *   8   uint32 Capacity, a power of two
+ *   12  uint32 NextSequence, writer only
+ *   64  uint64 Reserved, end offset of the record being written, stored before its bytes
+ *   128 uint64 Committed, end offset of the last complete record, stored after its bytes
+ *   192 uint32 Futex, incremented after every record, readers FUTEX_WAIT on it
+ *   196 uint32 Waiters, readers blocked on the futex, the writer only calls FUTEX_WAKE when it is not 0
+ * Offsets grow forever and are taken modulo Capacity. A record is a uint32 payload size, a uint32 sequence number and the payload,
+ * padded to 8 bytes. A size of 0xFFFFFFFF means the rest of the ring is unused and the next record starts at its beginning.
+ *
+ * There is one writer, which never waits for readers: a reader a whole ring behind loses the oldest records, like a full socket buffer.
+ * Readers copy a record out and then check Reserved, so a record overwritten while it was copied is dropped rather than delivered torn.
+ */
+class FLONET2SharedMemoryRing
+{
+public:
+
+	static constexpr int32 DefaultCapacity = 4 * 1024 * 1024;
+
+	/**
+	 * Opens the ring, creating it with Capacity bytes if it does not exist, so either side can start first. An existing ring keeps its capacity.
+	 * A writer takes an exclusive lock on the ring and fails if another writer holds it. Readers start at the newest record.
+	 * The ring is created readable and writable by its owner only, writer and readers must run as the same user.
+	 */
+	static TUniquePtr<FLONET2SharedMemoryRing> Open(const FString& Name, int32 Capacity, bool bWriter);
+
+	~FLONET2SharedMemoryRing();
+
+	/** Largest payload, a quarter of the ring so a burst of datagrams fits. */
+	int32 GetMaxPayloadSize() const { return static_cast<int32>(Capacity / 4); }
+
+	/** Writer: appends a record and wakes blocked readers. Never blocks. */
+	bool Write(const uint8* Payload, int32 Num);
+
+	/** Reader: blocks until a record newer than the last one read is committed, WaitTime passes or WakeReaders is called. */
+	bool WaitForData(FTimespan WaitTime);
+
+	/** Wakes every reader blocked in WaitForData, in any process. */
+	void WakeReaders();
+
+	/** Reader: copies committed records into Packets without blocking, returns how many were filled. */
+	int32 ReceiveBatch(TArrayView<FLONET2Packet*> Packets);
+
+	/** Records this reader lost because the writer overtook it. */
+	uint64 GetLostCount() const { return LostCount.GetValue(); }
+
+	/** Records larger than the packet buffers, dropped by ReceiveBatch. */
+	uint64 GetTruncatedCount() const { return TruncatedCount; }
+
+private:
+
+	FLONET2SharedMemoryRing() = default;
+
+	struct FHeader;
+
+	FHeader* Header = nullptr;
+
+	uint8* Data = nullptr;
+
+	uint32 Capacity = 0;
+
+	int Fd = -1;
+
+	/** End offset of the last record read, readers only. */
+	uint64 ReadOffset = 0;
+
+	/** Sequence number the next record should have, to count lost records. */
+	uint32 NextReadSequence = 0;
+	bool bHasReadSequence = false;
+
+	FThreadSafeCounter64 LostCount;
+
+	uint64 TruncatedCount = 0;
+};
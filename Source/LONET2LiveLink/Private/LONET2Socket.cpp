@@ -0,0 +1,462 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2Socket.h"
+
+#include "LONET2LiveLinkSource.h"
+#include "LONET2PacketPool.h"
+#include "HAL/PlatformTime.h"
+
+#if PLATFORM_LINUX
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include "Common/UdpSocketBuilder.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#endif
+
+#define LONET2_MAX_RECV_BATCH 64
+
+#if PLATFORM_LINUX
+
+namespace LONET2Socket
+{
+	static ip_mreq_source MakeSourceMembership(const FIPv4Address& Group, const FIPv4Address& Source)
+	{
+		ip_mreq_source SourceMembership = {};
+		SourceMembership.imr_multiaddr.s_addr = htonl(Group.Value);
+		SourceMembership.imr_sourceaddr.s_addr = htonl(Source.Value);
+		SourceMembership.imr_interface.s_addr = htonl(INADDR_ANY);
+		return SourceMembership;
+	}
+}
+
+FLONET2SocketWaker::FLONET2SocketWaker()
+{
+	EventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (EventFd < 0)
+	{
+		UE_LOG(ModuleLog, Warning, TEXT("eventfd() failed (errno %d), receiver shutdown waits for the receive timeout"), errno);
+	}
+}
+
+FLONET2SocketWaker::~FLONET2SocketWaker()
+{
+	if (EventFd >= 0)
+	{
+		close(EventFd);
+		EventFd = -1;
+	}
+}
+
+void FLONET2SocketWaker::Wake()
+{
+	bWoken = true;
+	if (EventFd >= 0)
+	{
+		const uint64 One = 1;
+		const ssize_t Written = write(EventFd, &One, sizeof(One));
+		(void)Written;
+	}
+}
+
+TUniquePtr<FLONET2Socket> FLONET2Socket::Create(const FIPv4Endpoint& Endpoint, int32 ReceiveBufferSize, TConstArrayView<FIPv4Address> Sources,
+	TConstArrayView<FIPv4Address> BlockedSources)
+{
+	const int NativeSocket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+	if (NativeSocket < 0)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("socket() failed for %s (errno %d)"), *Endpoint.ToString(), errno);
+		return nullptr;
+	}
+
+	TUniquePtr<FLONET2Socket> Result(new FLONET2Socket());
+	Result->NativeSocket = NativeSocket;
+
+	const int Enable = 1;
+	setsockopt(NativeSocket, SOL_SOCKET, SO_REUSEADDR, &Enable, sizeof(Enable));
+	setsockopt(NativeSocket, SOL_SOCKET, SO_RCVBUF, &ReceiveBufferSize, sizeof(ReceiveBufferSize));
+
+	// Ask the kernel to stamp each datagram as it arrives, before any thread wakeup delay
+	setsockopt(NativeSocket, SOL_SOCKET, SO_TIMESTAMPNS, &Enable, sizeof(Enable));
+
+	const bool bMulticast = Endpoint.Address.IsMulticastAddress();
+
+	sockaddr_in BindAddress = {};
+	BindAddress.sin_family = AF_INET;
+	BindAddress.sin_port = htons(Endpoint.Port);
+	BindAddress.sin_addr.s_addr = bMulticast ? htonl(INADDR_ANY) : htonl(Endpoint.Address.Value);
+
+	if (bind(NativeSocket, reinterpret_cast<const sockaddr*>(&BindAddress), sizeof(BindAddress)) != 0)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("bind() failed for %s (errno %d)"), *Endpoint.ToString(), errno);
+		return nullptr;
+	}
+
+	if (bMulticast)
+	{
+		// A socket bound to the wildcard address would otherwise get the groups every other socket on the host joined on this port
+		const int Disable = 0;
+		setsockopt(NativeSocket, IPPROTO_IP, IP_MULTICAST_ALL, &Disable, sizeof(Disable));
+
+		if (!Result->JoinGroup(Endpoint.Address, Sources, BlockedSources))
+		{
+			return nullptr;
+		}
+
+		const uint8 Loopback = 1;
+		const uint8 Ttl = 2;
+		setsockopt(NativeSocket, IPPROTO_IP, IP_MULTICAST_LOOP, &Loopback, sizeof(Loopback));
+		setsockopt(NativeSocket, IPPROTO_IP, IP_MULTICAST_TTL, &Ttl, sizeof(Ttl));
+	}
+
+	return Result;
+}
+
+bool FLONET2Socket::JoinGroup(const FIPv4Address& Group, TConstArrayView<FIPv4Address> Sources, TConstArrayView<FIPv4Address> BlockedSources)
+{
+	int32 NumJoined = 0;
+	for (const FIPv4Address& Source : Sources)
+	{
+		const ip_mreq_source SourceMembership = LONET2Socket::MakeSourceMembership(Group, Source);
+		if (setsockopt(NativeSocket, IPPROTO_IP, IP_ADD_SOURCE_MEMBERSHIP, &SourceMembership, sizeof(SourceMembership)) != 0)
+		{
+			UE_LOG(ModuleLog, Warning, TEXT("Failed to join multicast group %s for sender %s (errno %d)"), *Group.ToString(), *Source.ToString(), errno);
+			continue;
+		}
+		++NumJoined;
+	}
+	if (Sources.Num() > 0)
+	{
+		if (NumJoined == Sources.Num())
+		{
+			return true;
+		}
+
+		// A group cannot be joined for some senders and for any sender at once, leave the partial join before falling back
+		for (const FIPv4Address& Source : Sources)
+		{
+			const ip_mreq_source SourceMembership = LONET2Socket::MakeSourceMembership(Group, Source);
+			setsockopt(NativeSocket, IPPROTO_IP, IP_DROP_SOURCE_MEMBERSHIP, &SourceMembership, sizeof(SourceMembership));
+		}
+		UE_LOG(ModuleLog, Warning, TEXT("Joining multicast group %s for any sender, the allowed senders are filtered after receive"), *Group.ToString());
+	}
+
+	ip_mreq Membership = {};
+	Membership.imr_multiaddr.s_addr = htonl(Group.Value);
+	Membership.imr_interface.s_addr = htonl(INADDR_ANY);
+	if (setsockopt(NativeSocket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &Membership, sizeof(Membership)) != 0)
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Failed to join multicast group %s (errno %d)"), *Group.ToString(), errno);
+		return false;
+	}
+
+	for (const FIPv4Address& BlockedSource : BlockedSources)
+	{
+		const ip_mreq_source SourceMembership = LONET2Socket::MakeSourceMembership(Group, BlockedSource);
+		if (setsockopt(NativeSocket, IPPROTO_IP, IP_BLOCK_SOURCE, &SourceMembership, sizeof(SourceMembership)) != 0)
+		{
+			UE_LOG(ModuleLog, Verbose, TEXT("Failed to block sender %s on multicast group %s (errno %d)"), *BlockedSource.ToString(), *Group.ToString(), errno);
+		}
+	}
+	return true;
+}
+
+bool FLONET2Socket::SetReceiveBufferSize(int32 ReceiveBufferSize)
+{
+	if (setsockopt(NativeSocket, SOL_SOCKET, SO_RCVBUF, &ReceiveBufferSize, sizeof(ReceiveBufferSize)) != 0)
+	{
+		UE_LOG(ModuleLog, Warning, TEXT("Failed to set the receive buffer to %d bytes (errno %d)"), ReceiveBufferSize, errno);
+		return false;
+	}
+	return true;
+}
+
+FLONET2Socket::~FLONET2Socket()
+{
+	if (NativeSocket >= 0)
+	{
+		close(NativeSocket);
+		NativeSocket = -1;
+	}
+}
+
+bool FLONET2Socket::WaitForRead(FTimespan WaitTime)
+{
+	pollfd PollFd = {};
+	PollFd.fd = NativeSocket;
+	PollFd.events = POLLIN;
+	return poll(&PollFd, 1, static_cast<int>(WaitTime.GetTotalMilliseconds())) > 0 && (PollFd.revents & POLLIN) != 0;
+}
+
+bool FLONET2Socket::WaitForRead(TArrayView<FLONET2Socket* const> Sockets, FTimespan WaitTime, TBitArray<>& OutReadable, const FLONET2SocketWaker* Waker)
+{
+	OutReadable.Init(false, Sockets.Num());
+	if (Waker != nullptr && Waker->IsWoken())
+	{
+		return false;
+	}
+
+	TArray<pollfd, TInlineAllocator<65>> PollFds;
+	PollFds.SetNumZeroed(Sockets.Num());
+	for (int32 Index = 0; Index < Sockets.Num(); ++Index)
+	{
+		PollFds[Index].fd = Sockets[Index]->NativeSocket;
+		PollFds[Index].events = POLLIN;
+	}
+
+	// The eventfd stays readable once woken, nothing ever reads it
+	if (Waker != nullptr && Waker->EventFd >= 0)
+	{
+		pollfd& WakePollFd = PollFds.AddZeroed_GetRef();
+		WakePollFd.fd = Waker->EventFd;
+		WakePollFd.events = POLLIN;
+	}
+
+	if (poll(PollFds.GetData(), PollFds.Num(), static_cast<int>(WaitTime.GetTotalMilliseconds())) <= 0 || (Waker != nullptr && Waker->IsWoken()))
+	{
+		return false;
+	}
+
+	bool bAnyReadable = false;
+	for (int32 Index = 0; Index < Sockets.Num(); ++Index)
+	{
+		if (PollFds[Index].revents & POLLIN)
+		{
+			OutReadable[Index] = true;
+			bAnyReadable = true;
+		}
+	}
+	return bAnyReadable;
+}
+
+int32 FLONET2Socket::ReceiveBatch(TArrayView<FLONET2Packet*> Packets)
+{
+	const int32 BatchSize = FMath::Min(Packets.Num(), LONET2_MAX_RECV_BATCH);
+
+	mmsghdr Messages[LONET2_MAX_RECV_BATCH];
+	iovec Buffers[LONET2_MAX_RECV_BATCH];
+	sockaddr_in Senders[LONET2_MAX_RECV_BATCH];
+	alignas(cmsghdr) uint8 Controls[LONET2_MAX_RECV_BATCH][CMSG_SPACE(sizeof(timespec))];
+
+	for (int32 Index = 0; Index < BatchSize; ++Index)
+	{
+		Buffers[Index].iov_base = Packets[Index]->Data.GetData();
+		Buffers[Index].iov_len = Packets[Index]->Data.Num();
+
+		Messages[Index] = {};
+		Messages[Index].msg_hdr.msg_name = &Senders[Index];
+		Messages[Index].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		Messages[Index].msg_hdr.msg_iov = &Buffers[Index];
+		Messages[Index].msg_hdr.msg_iovlen = 1;
+		Messages[Index].msg_hdr.msg_control = Controls[Index];
+		Messages[Index].msg_hdr.msg_controllen = sizeof(Controls[Index]);
+	}
+
+	const int NumReceived = recvmmsg(NativeSocket, Messages, BatchSize, MSG_DONTWAIT, nullptr);
+	if (NumReceived <= 0)
+	{
+		return 0;
+	}
+
+	// Kernel stamps are CLOCK_REALTIME, move them onto the FPlatformTime clock by their age at this point
+	const double ReceiveTime = FPlatformTime::Seconds();
+	timespec Now;
+	clock_gettime(CLOCK_REALTIME, &Now);
+
+	// Compact the batch so truncated datagrams leave no gaps
+	int32 NumFilled = 0;
+	for (int32 Index = 0; Index < NumReceived; ++Index)
+	{
+		if (Messages[Index].msg_hdr.msg_flags & MSG_TRUNC)
+		{
+			++TruncatedCount;
+			continue;
+		}
+
+		Swap(Packets[NumFilled], Packets[Index]);
+		FLONET2Packet& Packet = *Packets[NumFilled++];
+		Packet.Data.SetNumUninitialized(Messages[Index].msg_len, false);
+		Packet.Sender = FIPv4Endpoint(FIPv4Address(ntohl(Senders[Index].sin_addr.s_addr)), ntohs(Senders[Index].sin_port));
+		Packet.ReceiveTime = ReceiveTime;
+
+		for (cmsghdr* Control = CMSG_FIRSTHDR(&Messages[Index].msg_hdr); Control != nullptr; Control = CMSG_NXTHDR(&Messages[Index].msg_hdr, Control))
+		{
+			if (Control->cmsg_level == SOL_SOCKET && Control->cmsg_type == SCM_TIMESTAMPNS)
+			{
+				timespec Stamp;
+				FMemory::Memcpy(&Stamp, CMSG_DATA(Control), sizeof(Stamp));
+				const double Age = double(Now.tv_sec - Stamp.tv_sec) + double(Now.tv_nsec - Stamp.tv_nsec) * 1.0e-9;
+				Packet.ReceiveTime = ReceiveTime - FMath::Clamp(Age, 0.0, 1.0);
+				break;
+			}
+		}
+	}
+
+	return NumFilled;
+}
+
+#else
+
+FLONET2SocketWaker::FLONET2SocketWaker() = default;
+
+FLONET2SocketWaker::~FLONET2SocketWaker() = default;
+
+void FLONET2SocketWaker::Wake()
+{
+	bWoken = true;
+}
+
+TUniquePtr<FLONET2Socket> FLONET2Socket::Create(const FIPv4Endpoint& Endpoint, int32 ReceiveBufferSize, TConstArrayView<FIPv4Address> Sources,
+	TConstArrayView<FIPv4Address> BlockedSources)
+{
+	// FSocket has no source specific join or block, senders are filtered after receive
+	FSocket* Socket = nullptr;
+	if (Endpoint.Address.IsMulticastAddress())
+	{
+		Socket = FUdpSocketBuilder(TEXT("LONET2SOCKET"))
+			.AsNonBlocking()
+			.AsReusable()
+			.BoundToPort(Endpoint.Port)
+			.WithReceiveBufferSize(ReceiveBufferSize)
+			.BoundToAddress(FIPv4Address::Any)
+			.JoinedToGroup(Endpoint.Address)
+			.WithMulticastLoopback()
+			.WithMulticastTtl(2);
+	}
+	else
+	{
+		Socket = FUdpSocketBuilder(TEXT("LONET2SOCKET"))
+			.AsNonBlocking()
+			.AsReusable()
+			.BoundToAddress(Endpoint.Address)
+			.BoundToPort(Endpoint.Port)
+			.WithReceiveBufferSize(ReceiveBufferSize);
+	}
+
+	if (Socket == nullptr || Socket->GetSocketType() != SOCKTYPE_Datagram)
+	{
+		if (Socket != nullptr)
+		{
+			ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		}
+		return nullptr;
+	}
+
+	TUniquePtr<FLONET2Socket> Result(new FLONET2Socket());
+	Result->Socket = Socket;
+	return Result;
+}
+
+FLONET2Socket::~FLONET2Socket()
+{
+	if (Socket != nullptr)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+}
+
+bool FLONET2Socket::JoinGroup(const FIPv4Address& Group, TConstArrayView<FIPv4Address> Sources, TConstArrayView<FIPv4Address> BlockedSources)
+{
+	if (!Socket->JoinMulticastGroup(*FIPv4Endpoint(Group, 0).ToInternetAddr()))
+	{
+		UE_LOG(ModuleLog, Error, TEXT("Failed to join multicast group %s"), *Group.ToString());
+		return false;
+	}
+	return true;
+}
+
+bool FLONET2Socket::SetReceiveBufferSize(int32 ReceiveBufferSize)
+{
+	int32 NewSize = 0;
+	if (!Socket->SetReceiveBufferSize(ReceiveBufferSize, NewSize))
+	{
+		UE_LOG(ModuleLog, Warning, TEXT("Failed to set the receive buffer to %d bytes"), ReceiveBufferSize);
+		return false;
+	}
+	return true;
+}
+
+bool FLONET2Socket::WaitForRead(FTimespan WaitTime)
+{
+	return Socket->Wait(ESocketWaitConditions::WaitForRead, WaitTime);
+}
+
+bool FLONET2Socket::WaitForRead(TArrayView<FLONET2Socket* const> Sockets, FTimespan WaitTime, TBitArray<>& OutReadable, const FLONET2SocketWaker* Waker)
+{
+	OutReadable.Init(false, Sockets.Num());
+	if (Sockets.Num() == 1 && Waker == nullptr)
+	{
+		OutReadable[0] = Sockets[0]->WaitForRead(WaitTime);
+		return OutReadable[0];
+	}
+
+	// FSocket cannot wait on several sockets at once, or be woken, so wait on each in turn for a short slice
+	const FTimespan Slice = FMath::Min(WaitTime, FTimespan::FromMilliseconds(Sockets.Num() == 1 ? 5 : 2));
+	const double EndTime = FPlatformTime::Seconds() + WaitTime.GetTotalSeconds();
+	int32 WaitIndex = 0;
+	do
+	{
+		bool bAnyReadable = false;
+		uint32 PendingSize = 0;
+		for (int32 Index = 0; Index < Sockets.Num(); ++Index)
+		{
+			if (Sockets[Index]->Socket->HasPendingData(PendingSize))
+			{
+				OutReadable[Index] = true;
+				bAnyReadable = true;
+			}
+		}
+		if (bAnyReadable || Sockets.Num() == 0 || (Waker != nullptr && Waker->IsWoken()))
+		{
+			return bAnyReadable;
+		}
+
+		Sockets[WaitIndex]->WaitForRead(Slice);
+		WaitIndex = (WaitIndex + 1) % Sockets.Num();
+	}
+	while (FPlatformTime::Seconds() < EndTime);
+
+	return false;
+}
+
+int32 FLONET2Socket::ReceiveBatch(TArrayView<FLONET2Packet*> Packets)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	TSharedRef<FInternetAddr> SenderAddress = SocketSubsystem->CreateInternetAddr();
+
+	int32 NumFilled = 0;
+	uint32 PendingSize = 0;
+	while (NumFilled < Packets.Num() && Socket->HasPendingData(PendingSize))
+	{
+		FLONET2Packet& Packet = *Packets[NumFilled];
+
+		int32 BytesRead = 0;
+		if (!Socket->RecvFrom(Packet.Data.GetData(), Packet.Data.Num(), BytesRead, *SenderAddress))
+		{
+			// Oversized datagrams fail the read, the next one can still be valid
+			if (SocketSubsystem->GetLastErrorCode() == SE_EMSGSIZE)
+			{
+				++TruncatedCount;
+				continue;
+			}
+			break;
+		}
+
+		Packet.Data.SetNumUninitialized(BytesRead, false);
+		Packet.Sender = FIPv4Endpoint(SenderAddress);
+		Packet.ReceiveTime = FPlatformTime::Seconds();
+		++NumFilled;
+	}
+
+	return NumFilled;
+}
+
+#endif
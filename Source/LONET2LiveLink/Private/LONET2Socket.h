@@ -0,0 +1,97 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+
+class FSocket;
+struct FLONET2Packet;
+
+/**
+ * Wakes a thread blocked in FLONET2Socket::WaitForRead, so a shutdown does not wait out the wait time.
+ * On Linux an eventfd is polled along with the sockets, elsewhere the wait is sliced and the flag checked between slices.
+ * Once woken it stays set, it is meant for stopping a receiver for good.
+ */
+class FLONET2SocketWaker
+{
+public:
+
+	FLONET2SocketWaker();
+	~FLONET2SocketWaker();
+
+	void Wake();
+
+	bool IsWoken() const { return bWoken; }
+
+private:
+
+	friend class FLONET2Socket;
+
+#if PLATFORM_LINUX
+	int EventFd = -1;
+#endif
+
+	FThreadSafeBool bWoken;
+};
+
+/**
+ * UDP receive socket for a LONET 2 endpoint.
+ * On Linux this owns a native socket so a whole batch of datagrams can be read with one recvmmsg call,
+ * other platforms go through FSocket and read datagrams one RecvFrom at a time.
+ */
+class FLONET2Socket
+{
+public:
+
+	/**
+	 * Binds (and joins, for multicast addresses) the endpoint. Returns nullptr on failure.
+	 * Sources and BlockedSources limit multicast joins, see JoinGroup.
+	 */
+	static TUniquePtr<FLONET2Socket> Create(const FIPv4Endpoint& Endpoint, int32 ReceiveBufferSize, TConstArrayView<FIPv4Address> Sources = {},
+		TConstArrayView<FIPv4Address> BlockedSources = {});
+
+	~FLONET2Socket();
+
+	/**
+	 * Joins another multicast group on the bound port, so one socket serves several groups.
+	 * With Sources the group is joined for those senders only (IGMPv3 source specific multicast) where the OS supports it,
+	 * so the network and kernel drop everything else. Joined for any sender, the kernel drops BlockedSources where the OS supports it.
+	 * Senders the OS cannot filter still arrive, callers filter them after receive.
+	 */
+	bool JoinGroup(const FIPv4Address& Group, TConstArrayView<FIPv4Address> Sources = {}, TConstArrayView<FIPv4Address> BlockedSources = {});
+
+	/** Resizes the kernel receive buffer of the open socket. */
+	bool SetReceiveBufferSize(int32 ReceiveBufferSize);
+
+	/** Blocks until data is pending or WaitTime passes. */
+	bool WaitForRead(FTimespan WaitTime);
+
+	/**
+	 * Blocks until any of the sockets has data pending, WaitTime passes or Waker is woken, one poll() over all of them on Linux.
+	 * OutReadable has a bit per socket, set for those with pending data. Returns false on timeout and wakeup.
+	 */
+	static bool WaitForRead(TArrayView<FLONET2Socket* const> Sockets, FTimespan WaitTime, TBitArray<>& OutReadable, const FLONET2SocketWaker* Waker = nullptr);
+
+	/**
+	 * Reads pending datagrams into Packets without blocking, returns how many were filled.
+	 * ReceiveTime is the kernel arrival stamp (SO_TIMESTAMPNS) on Linux, the time of the read elsewhere.
+	 */
+	int32 ReceiveBatch(TArrayView<FLONET2Packet*> Packets);
+
+	/** Datagrams larger than the packet buffers, dropped by ReceiveBatch. */
+	uint64 GetTruncatedCount() const { return TruncatedCount; }
+
+private:
+
+	FLONET2Socket() = default;
+
+#if PLATFORM_LINUX
+	int NativeSocket = -1;
+#else
+	FSocket* Socket = nullptr;
+#endif
+
+	uint64 TruncatedCount = 0;
+};
@@ -0,0 +1,207 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2Stats.h"
+
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_STAT(STAT_LONET2_Receive);
+DEFINE_STAT(STAT_LONET2_Decode);
+DEFINE_STAT(STAT_LONET2_Push);
+
+DEFINE_STAT(STAT_LONET2_PacketsReceived);
+DEFINE_STAT(STAT_LONET2_BytesReceived);
+DEFINE_STAT(STAT_LONET2_FramesPushed);
+DEFINE_STAT(STAT_LONET2_MalformedPackets);
+
+CSV_DEFINE_CATEGORY(LONET2, true);
+
+void FLONET2SourceStats::AddFrame(FName SubjectName, const FQualifiedFrameTime& SceneTime, bool bHasSceneTime, bool bMalformedTimecode)
+{
+	FPacketFrame& Frame = PacketFrames.AddDefaulted_GetRef();
+	Frame.SubjectName = SubjectName;
+	Frame.SceneTime = SceneTime;
+	Frame.bHasSceneTime = bHasSceneTime;
+	Frame.bMalformedTimecode = bMalformedTimecode;
+}
+
+void FLONET2SourceStats::AddPredictionError(FName SubjectName, float PositionError, float RotationErrorDegrees)
+{
+	PacketPredictionErrors.Add({ SubjectName, PositionError, RotationErrorDegrees });
+}
+
+void FLONET2SourceStats::RecordPacket(int32 Bytes, uint64 DecodeCycles, bool bMalformed)
+{
+	ON_SCOPE_EXIT
+	{
+		PacketFrames.Reset();
+		PacketPredictionErrors.Reset();
+	};
+	TConstArrayView<FPacketFrame> Frames = PacketFrames;
+
+	FScopeLock Lock(&CriticalSection);
+
+	++Total.Packets;
+	Total.Bytes += Bytes;
+	Total.DecodeCycles += DecodeCycles;
+	Total.Malformed += bMalformed ? 1 : 0;
+
+	if (Frames.Num() == 0)
+	{
+		return;
+	}
+
+	const uint64 FrameBytes = Bytes / Frames.Num();
+	const uint64 FrameCycles = DecodeCycles / Frames.Num();
+
+	for (const FPacketFrame& Frame : Frames)
+	{
+		FSubject* Subject = Subjects.Find(Frame.SubjectName);
+		if (Subject == nullptr)
+		{
+			Subject = &Subjects.Add(Frame.SubjectName);
+#if CSV_PROFILER
+			const FString Prefix = Frame.SubjectName.ToString();
+			Subject->PacketsStatName = FName(Prefix + TEXT("/PacketsPerSecond"));
+			Subject->BytesStatName = FName(Prefix + TEXT("/BytesPerSecond"));
+			Subject->DecodeStatName = FName(Prefix + TEXT("/DecodeMicroseconds"));
+			Subject->MalformedStatName = FName(Prefix + TEXT("/MalformedPerSecond"));
+			Subject->GapsStatName = FName(Prefix + TEXT("/TimecodeGapsPerSecond"));
+			Subject->PositionErrorStatName = FName(Prefix + TEXT("/PredictionErrorCm"));
+			Subject->RotationErrorStatName = FName(Prefix + TEXT("/PredictionErrorDegrees"));
+#endif
+		}
+
+		++Subject->Counters.Packets;
+		Subject->Counters.Bytes += FrameBytes;
+		Subject->Counters.DecodeCycles += FrameCycles;
+
+		if (Frame.bMalformedTimecode)
+		{
+			++Subject->Counters.Malformed;
+			++Total.Malformed;
+		}
+
+		if (!Frame.bHasSceneTime)
+		{
+			continue;
+		}
+
+		// A frame number more than one past the previous frame means frames were lost on the way, or never sent
+		if (Subject->bHasLastSceneTime && Subject->LastSceneTime.Rate == Frame.SceneTime.Rate)
+		{
+			const int32 Step = Frame.SceneTime.Time.GetFrame().Value - Subject->LastSceneTime.Time.GetFrame().Value;
+			if (Step > 1)
+			{
+				++Subject->Counters.TimecodeGaps;
+				++Total.TimecodeGaps;
+			}
+		}
+		Subject->LastSceneTime = Frame.SceneTime;
+		Subject->bHasLastSceneTime = true;
+	}
+
+	for (const FPredictionError& Error : PacketPredictionErrors)
+	{
+		auto AddError = [&Error](FCounters& Counters)
+		{
+			++Counters.Predictions;
+			Counters.PositionErrorSum += Error.PositionError;
+			Counters.RotationErrorSum += Error.RotationErrorDegrees;
+		};
+		AddError(Total);
+		if (FSubject* Subject = Subjects.Find(Error.SubjectName))
+		{
+			AddError(Subject->Counters);
+		}
+	}
+}
+
+FLONET2SourceStats::FRates FLONET2SourceStats::MakeRates(const FCounters& Counters, const FCounters& LastCounters, double Seconds)
+{
+	FRates Rates;
+	const uint64 Packets = Counters.Packets - LastCounters.Packets;
+	Rates.PacketsPerSecond = Packets / Seconds;
+	Rates.BytesPerSecond = (Counters.Bytes - LastCounters.Bytes) / Seconds;
+	Rates.DecodeMicrosecondsPerPacket = Packets > 0 ? (Counters.DecodeCycles - LastCounters.DecodeCycles) * FPlatformTime::GetSecondsPerCycle64() * 1000000.0 / Packets : 0.0;
+	Rates.MalformedPerSecond = (Counters.Malformed - LastCounters.Malformed) / Seconds;
+	Rates.TimecodeGapsPerSecond = (Counters.TimecodeGaps - LastCounters.TimecodeGaps) / Seconds;
+
+	const uint64 Predictions = Counters.Predictions - LastCounters.Predictions;
+	if (Predictions > 0)
+	{
+		Rates.PredictionErrorCentimeters = (Counters.PositionErrorSum - LastCounters.PositionErrorSum) / Predictions;
+		Rates.PredictionErrorDegrees = (Counters.RotationErrorSum - LastCounters.RotationErrorSum) / Predictions;
+	}
+	return Rates;
+}
+
+bool FLONET2SourceStats::Tick(double Now, double IntervalSeconds)
+{
+	if (LastTickTime == 0.0)
+	{
+		LastTickTime = Now;
+		return false;
+	}
+
+	const double Seconds = Now - LastTickTime;
+	if (Seconds < IntervalSeconds)
+	{
+		return false;
+	}
+	LastTickTime = Now;
+
+	FScopeLock Lock(&CriticalSection);
+
+	TotalRates = MakeRates(Total, LastTotal, Seconds);
+	LastTotal = Total;
+
+	for (TPair<FName, FSubject>& Pair : Subjects)
+	{
+		FSubject& Subject = Pair.Value;
+		Subject.Rates = MakeRates(Subject.Counters, Subject.LastCounters, Seconds);
+		Subject.LastCounters = Subject.Counters;
+	}
+
+#if CSV_PROFILER
+	if (FCsvProfiler::Get()->IsCapturing())
+	{
+		const int32 CategoryIndex = CSV_CATEGORY_INDEX(LONET2);
+		for (const TPair<FName, FSubject>& Pair : Subjects)
+		{
+			const FSubject& Subject = Pair.Value;
+			FCsvProfiler::RecordCustomStat(Subject.PacketsStatName, CategoryIndex, static_cast<float>(Subject.Rates.PacketsPerSecond), ECsvCustomStatOp::Set);
+			FCsvProfiler::RecordCustomStat(Subject.BytesStatName, CategoryIndex, static_cast<float>(Subject.Rates.BytesPerSecond), ECsvCustomStatOp::Set);
+			FCsvProfiler::RecordCustomStat(Subject.DecodeStatName, CategoryIndex, static_cast<float>(Subject.Rates.DecodeMicrosecondsPerPacket), ECsvCustomStatOp::Set);
+			FCsvProfiler::RecordCustomStat(Subject.MalformedStatName, CategoryIndex, static_cast<float>(Subject.Rates.MalformedPerSecond), ECsvCustomStatOp::Set);
+			FCsvProfiler::RecordCustomStat(Subject.GapsStatName, CategoryIndex, static_cast<float>(Subject.Rates.TimecodeGapsPerSecond), ECsvCustomStatOp::Set);
+			if (Subject.Counters.Predictions > 0)
+			{
+				FCsvProfiler::RecordCustomStat(Subject.PositionErrorStatName, CategoryIndex, static_cast<float>(Subject.Rates.PredictionErrorCentimeters), ECsvCustomStatOp::Set);
+				FCsvProfiler::RecordCustomStat(Subject.RotationErrorStatName, CategoryIndex, static_cast<float>(Subject.Rates.PredictionErrorDegrees), ECsvCustomStatOp::Set);
+			}
+		}
+	}
+#endif
+
+	return true;
+}
+
+FLONET2SourceStats::FRates FLONET2SourceStats::GetTotalRates() const
+{
+	FScopeLock Lock(&CriticalSection);
+	return TotalRates;
+}
+
+void FLONET2SourceStats::RemoveSubject(FName SubjectName)
+{
+	FScopeLock Lock(&CriticalSection);
+	Subjects.Remove(SubjectName);
+}
+
+void FLONET2SourceStats::Empty()
+{
+	FScopeLock Lock(&CriticalSection);
+	Subjects.Empty();
+}
@@ -0,0 +1,136 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/QualifiedFrameTime.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("LONET2"), STATGROUP_LONET2, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Receive"), STAT_LONET2_Receive, STATGROUP_LONET2, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Decode"), STAT_LONET2_Decode, STATGROUP_LONET2, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Push"), STAT_LONET2_Push, STATGROUP_LONET2, );
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Packets Received"), STAT_LONET2_PacketsReceived, STATGROUP_LONET2, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Bytes Received"), STAT_LONET2_BytesReceived, STATGROUP_LONET2, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Frames Pushed"), STAT_LONET2_FramesPushed, STATGROUP_LONET2, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Malformed Packets"), STAT_LONET2_MalformedPackets, STATGROUP_LONET2, );
+
+CSV_DECLARE_CATEGORY_EXTERN(LONET2);
+
+/**
+ * Packet, byte, decode time, malformed and timecode gap counts of one source, in total and per subject.
+ * The decoding thread records one packet at a time, the game thread turns the counts into rates once a second
+ * for the source status text and the CSV profiler.
+ */
+class FLONET2SourceStats
+{
+public:
+
+	/** Rates over the last completed interval. */
+	struct FRates
+	{
+		double PacketsPerSecond = 0.0;
+		double BytesPerSecond = 0.0;
+		double DecodeMicrosecondsPerPacket = 0.0;
+		double MalformedPerSecond = 0.0;
+		double TimecodeGapsPerSecond = 0.0;
+		/** Mean error of the pose predictions resolved in the interval, 0 without prediction. */
+		double PredictionErrorCentimeters = 0.0;
+		double PredictionErrorDegrees = 0.0;
+	};
+
+	/** Notes a frame queued from the packet being decoded, bMalformedTimecode when its timecode did not parse. Decoding thread only. */
+	void AddFrame(FName SubjectName, const FQualifiedFrameTime& SceneTime, bool bHasSceneTime, bool bMalformedTimecode);
+
+	/** Notes the error of a pose prediction resolved by the packet being decoded. Decoding thread only. */
+	void AddPredictionError(FName SubjectName, float PositionError, float RotationErrorDegrees);
+
+	/**
+	 * Records the decoded packet with the frames added since the last call.
+	 * Decode time and bytes are shared evenly between those frames.
+	 * bMalformed counts against the source only, a packet that does not decode names no subject.
+	 */
+	void RecordPacket(int32 Bytes, uint64 DecodeCycles, bool bMalformed);
+
+	/**
+	 * Closes the interval once at least IntervalSeconds have passed since the last one, updating the rates.
+	 * Returns true when it did, the CSV profiler then gets every subject's rates. Game thread only.
+	 */
+	bool Tick(double Now, double IntervalSeconds = 1.0);
+
+	/** Source wide rates. */
+	FRates GetTotalRates() const;
+
+	void RemoveSubject(FName SubjectName);
+
+	void Empty();
+
+private:
+
+	struct FPacketFrame
+	{
+		FName SubjectName;
+		FQualifiedFrameTime SceneTime;
+		bool bHasSceneTime = false;
+		bool bMalformedTimecode = false;
+	};
+
+	struct FPredictionError
+	{
+		FName SubjectName;
+		float PositionError = 0.0f;
+		float RotationErrorDegrees = 0.0f;
+	};
+
+	struct FCounters
+	{
+		uint64 Packets = 0;
+		uint64 Bytes = 0;
+		uint64 DecodeCycles = 0;
+		uint64 Malformed = 0;
+		uint64 TimecodeGaps = 0;
+		uint64 Predictions = 0;
+		double PositionErrorSum = 0.0;
+		double RotationErrorSum = 0.0;
+	};
+
+	struct FSubject
+	{
+		FCounters Counters;
+		FCounters LastCounters;
+		FRates Rates;
+
+		FQualifiedFrameTime LastSceneTime;
+		bool bHasLastSceneTime = false;
+
+#if CSV_PROFILER
+		FName PacketsStatName;
+		FName BytesStatName;
+		FName DecodeStatName;
+		FName MalformedStatName;
+		FName GapsStatName;
+		FName PositionErrorStatName;
+		FName RotationErrorStatName;
+#endif
+	};
+
+	static FRates MakeRates(const FCounters& Counters, const FCounters& LastCounters, double Seconds);
+
+	/** Frames of the packet being decoded, only touched by the decoding thread. */
+	TArray<FPacketFrame, TInlineAllocator<8>> PacketFrames;
+	TArray<FPredictionError, TInlineAllocator<8>> PacketPredictionErrors;
+
+	mutable FCriticalSection CriticalSection;
+
+	FCounters Total;
+	FCounters LastTotal;
+	FRates TotalRates;
+
+	TMap<FName, FSubject> Subjects;
+
+	double LastTickTime = 0.0;
+};
@@ -0,0 +1,629 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2StreamDecoder.h"
+
+#include "LONET2Schema.h"
+
+#include "Roles/LiveLinkCameraTypes.h"
+#include "LiveLinkLensTypes.h"
+
+namespace LONET2StreamDecoder
+{
+	using EResult = FLONET2StreamDecoder::EResult;
+
+	static constexpr int32 MaxSkipDepth = 64;
+	static constexpr int32 MaxNumberLength = 63;
+
+	struct FCursor
+	{
+		const ANSICHAR* Pos;
+		const ANSICHAR* End;
+
+		void SkipWhitespace()
+		{
+			while (Pos < End && (*Pos == ' ' || *Pos == '\t' || *Pos == '\n' || *Pos == '\r'))
+			{
+				++Pos;
+			}
+		}
+
+		ANSICHAR Peek()
+		{
+			SkipWhitespace();
+			return Pos < End ? *Pos : '\0';
+		}
+
+		bool Consume(ANSICHAR Expected)
+		{
+			if (Peek() == Expected)
+			{
+				++Pos;
+				return true;
+			}
+			return false;
+		}
+
+		// Returns the raw bytes between the quotes. Escaped strings are reported so the caller can fall back.
+		EResult ReadString(FAnsiStringView& OutString)
+		{
+			if (!Consume('"'))
+			{
+				return EResult::Malformed;
+			}
+
+			const ANSICHAR* Start = Pos;
+			bool bHasEscapes = false;
+			while (Pos < End && *Pos != '"')
+			{
+				if (*Pos == '\\')
+				{
+					bHasEscapes = true;
+					++Pos;
+				}
+				else if (static_cast<uint8>(*Pos) < 0x20)
+				{
+					return EResult::Malformed;
+				}
+				++Pos;
+			}
+
+			if (Pos >= End)
+			{
+				return EResult::Malformed;
+			}
+
+			OutString = FAnsiStringView(Start, static_cast<int32>(Pos - Start));
+			++Pos;
+			return bHasEscapes ? EResult::Fallback : EResult::Decoded;
+		}
+
+		EResult ReadNumber(double& OutValue)
+		{
+			const ANSICHAR First = Peek();
+			if (First != '-' && !FCharAnsi::IsDigit(First))
+			{
+				// Strings, bools and nulls are coerced differently by FJsonValue, leave those to the DOM path
+				return (First == '"' || First == 't' || First == 'f' || First == 'n') ? EResult::Fallback : EResult::Malformed;
+			}
+
+			ANSICHAR Buffer[MaxNumberLength + 1];
+			int32 Length = 0;
+			while (Pos < End && (FCharAnsi::IsDigit(*Pos) || *Pos == '-' || *Pos == '+' || *Pos == '.' || *Pos == 'e' || *Pos == 'E'))
+			{
+				if (Length == MaxNumberLength)
+				{
+					return EResult::Fallback;
+				}
+				Buffer[Length++] = *Pos++;
+			}
+			Buffer[Length] = '\0';
+
+			OutValue = FCStringAnsi::Atod(Buffer);
+			return EResult::Decoded;
+		}
+
+		// Steps over a number without converting it, for values nobody reads
+		EResult SkipNumber()
+		{
+			const ANSICHAR First = Peek();
+			if (First != '-' && !FCharAnsi::IsDigit(First))
+			{
+				return EResult::Malformed;
+			}
+			while (Pos < End && (FCharAnsi::IsDigit(*Pos) || *Pos == '-' || *Pos == '+' || *Pos == '.' || *Pos == 'e' || *Pos == 'E'))
+			{
+				++Pos;
+			}
+			return EResult::Decoded;
+		}
+
+		// Reads up to Capacity numbers, further elements are validated and ignored like the DOM path does.
+		EResult ReadNumberArray(double* OutValues, int32 Capacity, int32& OutCount)
+		{
+			OutCount = 0;
+			if (Peek() != '[')
+			{
+				return EResult::Fallback;
+			}
+			++Pos;
+
+			if (Consume(']'))
+			{
+				return EResult::Decoded;
+			}
+
+			do
+			{
+				double Value = 0.0;
+				const EResult Result = ReadNumber(Value);
+				if (Result != EResult::Decoded)
+				{
+					return Result;
+				}
+				if (OutCount < Capacity)
+				{
+					OutValues[OutCount] = Value;
+				}
+				++OutCount;
+			} while (Consume(','));
+
+			return Consume(']') ? EResult::Decoded : EResult::Malformed;
+		}
+
+		EResult ReadNumberArray(TArray<float>& OutValues)
+		{
+			if (Peek() != '[')
+			{
+				return EResult::Fallback;
+			}
+			++Pos;
+
+			if (Consume(']'))
+			{
+				return EResult::Decoded;
+			}
+
+			do
+			{
+				double Value = 0.0;
+				const EResult Result = ReadNumber(Value);
+				if (Result != EResult::Decoded)
+				{
+					return Result;
+				}
+				OutValues.Push(Value);
+			} while (Consume(','));
+
+			return Consume(']') ? EResult::Decoded : EResult::Malformed;
+		}
+
+		EResult ReadBool(bool& OutValue)
+		{
+			switch (Peek())
+			{
+			case 't':
+				OutValue = true;
+				return SkipLiteral("true") ? EResult::Decoded : EResult::Malformed;
+			case 'f':
+				OutValue = false;
+				return SkipLiteral("false") ? EResult::Decoded : EResult::Malformed;
+			default:
+				// Numbers and strings are coerced by FJsonValue
+				return EResult::Fallback;
+			}
+		}
+
+		bool SkipLiteral(const ANSICHAR* Literal)
+		{
+			for (; *Literal; ++Literal, ++Pos)
+			{
+				if (Pos >= End || *Pos != *Literal)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		EResult SkipValue(int32 Depth = 0)
+		{
+			if (Depth > MaxSkipDepth)
+			{
+				return EResult::Malformed;
+			}
+
+			switch (Peek())
+			{
+			case '"':
+			{
+				FAnsiStringView Ignored;
+				return ReadString(Ignored) == EResult::Malformed ? EResult::Malformed : EResult::Decoded;
+			}
+			case '{':
+			{
+				++Pos;
+				if (Consume('}'))
+				{
+					return EResult::Decoded;
+				}
+				do
+				{
+					FAnsiStringView Ignored;
+					if (ReadString(Ignored) == EResult::Malformed || !Consume(':') || SkipValue(Depth + 1) != EResult::Decoded)
+					{
+						return EResult::Malformed;
+					}
+				} while (Consume(','));
+				return Consume('}') ? EResult::Decoded : EResult::Malformed;
+			}
+			case '[':
+			{
+				++Pos;
+				if (Consume(']'))
+				{
+					return EResult::Decoded;
+				}
+				do
+				{
+					if (SkipValue(Depth + 1) != EResult::Decoded)
+					{
+						return EResult::Malformed;
+					}
+				} while (Consume(','));
+				return Consume(']') ? EResult::Decoded : EResult::Malformed;
+			}
+			case 't':
+				return SkipLiteral("true") ? EResult::Decoded : EResult::Malformed;
+			case 'f':
+				return SkipLiteral("false") ? EResult::Decoded : EResult::Malformed;
+			case 'n':
+				return SkipLiteral("null") ? EResult::Decoded : EResult::Malformed;
+			default:
+				return SkipNumber();
+			}
+		}
+	};
+
+	using LONET2Schema::KeyEquals;
+
+	static EResult ReadLensSample(FCursor& Cursor, FLONET2LensSample& Out)
+	{
+		if (!Cursor.Consume('{'))
+		{
+			return EResult::Malformed;
+		}
+		if (Cursor.Consume('}'))
+		{
+			return EResult::Decoded;
+		}
+
+		do
+		{
+			FAnsiStringView Key;
+			EResult Result = Cursor.ReadString(Key);
+			if (Result != EResult::Decoded)
+			{
+				return Result;
+			}
+			if (!Cursor.Consume(':'))
+			{
+				return EResult::Malformed;
+			}
+
+			double Value = 0.0;
+			double Pair[2] = { 0.0, 0.0 };
+			int32 Count = 0;
+			if (KeyEquals(Key, "focus"))
+			{
+				Result = Cursor.ReadNumber(Value);
+				Out.Focus = Value;
+			}
+			else if (KeyEquals(Key, "zoom"))
+			{
+				Result = Cursor.ReadNumber(Value);
+				Out.Zoom = Value;
+			}
+			else if (KeyEquals(Key, "fXfY") || KeyEquals(Key, "principalPoint"))
+			{
+				float* Target = KeyEquals(Key, "fXfY") ? Out.FxFy : Out.PrincipalPoint;
+				Result = Cursor.ReadNumberArray(Pair, 2, Count);
+				Target[0] = Pair[0];
+				Target[1] = Pair[1];
+			}
+			else if (KeyEquals(Key, "distortionParameters"))
+			{
+				Result = Cursor.ReadNumberArray(Out.DistortionParameters);
+			}
+			else
+			{
+				Result = Cursor.SkipValue();
+			}
+
+			if (Result != EResult::Decoded)
+			{
+				return Result;
+			}
+		} while (Cursor.Consume(','));
+
+		return Cursor.Consume('}') ? EResult::Decoded : EResult::Malformed;
+	}
+
+	// Calibration tables are rare and not pushed as frames, unknown keys are skipped rather than handed to the DOM path
+	static EResult ReadLensTable(FCursor& Cursor, FLONET2DecodedLensTable& Out)
+	{
+		if (!Cursor.Consume('{'))
+		{
+			return EResult::Fallback;
+		}
+		if (Cursor.Consume('}'))
+		{
+			return EResult::Decoded;
+		}
+
+		do
+		{
+			FAnsiStringView Key;
+			EResult Result = Cursor.ReadString(Key);
+			if (Result != EResult::Decoded)
+			{
+				return Result;
+			}
+			if (!Cursor.Consume(':'))
+			{
+				return EResult::Malformed;
+			}
+
+			if (KeyEquals(Key, "cameraName"))
+			{
+				Result = Cursor.Peek() == '"' ? Cursor.ReadString(Out.CameraName) : EResult::Fallback;
+			}
+			else if (KeyEquals(Key, "samples"))
+			{
+				if (!Cursor.Consume('['))
+				{
+					return EResult::Malformed;
+				}
+				if (!Cursor.Consume(']'))
+				{
+					do
+					{
+						Result = ReadLensSample(Cursor, Out.Samples.AddDefaulted_GetRef());
+						if (Result != EResult::Decoded)
+						{
+							return Result;
+						}
+					} while (Cursor.Consume(','));
+
+					Result = Cursor.Consume(']') ? EResult::Decoded : EResult::Malformed;
+				}
+			}
+			else
+			{
+				Result = Cursor.SkipValue();
+			}
+
+			if (Result != EResult::Decoded)
+			{
+				return Result;
+			}
+		} while (Cursor.Consume(','));
+
+		return Cursor.Consume('}') ? EResult::Decoded : EResult::Malformed;
+	}
+
+	static EResult ReadField(FCursor& Cursor, const LONET2Schema::FField& Field, FLONET2DecodedSection& Out)
+	{
+		using LONET2Schema::EFieldTarget;
+
+		FLiveLinkBaseFrameData& Frame = *Out.FrameData.GetBaseData();
+		switch (Field.Target)
+		{
+		case EFieldTarget::SubjectName:
+			return Cursor.Peek() == '"' ? Cursor.ReadString(Out.SubjectName) : EResult::Fallback;
+		case EFieldTarget::Timecode:
+			Out.bHasTimecode = true;
+			return Cursor.Peek() == '"' ? Cursor.ReadString(Out.Timecode) : EResult::Fallback;
+		case EFieldTarget::FrameRate:
+			return Cursor.ReadNumber(Out.FrameRate);
+		case EFieldTarget::Sequence:
+		{
+			double Sequence = 0.0;
+			const EResult Result = Cursor.ReadNumber(Sequence);
+			Out.Sequence = static_cast<uint32>(static_cast<int64>(Sequence));
+			Out.bHasSequence = true;
+			return Result;
+		}
+		case EFieldTarget::Keyframe:
+			return Cursor.ReadBool(Out.bKeyframe);
+		case EFieldTarget::FloatArray:
+		{
+			TArray<float>& Values = LONET2Schema::GetFloatArray(Field, Frame);
+			Values.Reset();
+			return Cursor.ReadNumberArray(Values);
+		}
+		default:
+		{
+			double Values[4];
+			int32 Count = 0;
+			check(Field.Count <= UE_ARRAY_COUNT(Values));
+
+			EResult Result;
+			if (Field.Count == 1)
+			{
+				Result = Cursor.ReadNumber(Values[0]);
+				Count = Result == EResult::Decoded ? 1 : 0;
+			}
+			else
+			{
+				Result = Cursor.ReadNumberArray(Values, Field.Count, Count);
+			}
+			LONET2Schema::WriteNumbers(Field, Values, Count, Frame);
+			return Result;
+		}
+		}
+	}
+
+	// Steps over the rest of a section object, from after a member up to and including its closing brace
+	static EResult SkipSectionMembers(FCursor& Cursor)
+	{
+		while (Cursor.Consume(','))
+		{
+			FAnsiStringView Key;
+			if (Cursor.ReadString(Key) == EResult::Malformed || !Cursor.Consume(':') || Cursor.SkipValue() != EResult::Decoded)
+			{
+				return EResult::Malformed;
+			}
+		}
+		return Cursor.Consume('}') ? EResult::Decoded : EResult::Malformed;
+	}
+
+	static EResult ReadSection(FCursor& Cursor, FLONET2DecodedSection& Out, const FLONET2StreamDecoder::FIsSubjectEnabled* IsSubjectEnabled, bool& bOutSkipped)
+	{
+		if (!Cursor.Consume('{'))
+		{
+			// FJsonObject ignores sections that are not objects
+			return EResult::Fallback;
+		}
+
+		const LONET2Schema::FSection& Schema = LONET2Schema::GetSection(Out.Section);
+		Out.FrameData = LONET2Schema::MakeFrame(Schema);
+
+		if (Cursor.Consume('}'))
+		{
+			return EResult::Decoded;
+		}
+
+		do
+		{
+			FAnsiStringView Key;
+			EResult Result = Cursor.ReadString(Key);
+			if (Result != EResult::Decoded)
+			{
+				return Result;
+			}
+			if (!Cursor.Consume(':'))
+			{
+				return EResult::Malformed;
+			}
+
+			// Keys outside the schema go to the FJsonObject path
+			const LONET2Schema::FField* Field = LONET2Schema::FindField(Schema, Key);
+			if (Field == nullptr)
+			{
+				return EResult::Fallback;
+			}
+			Out.FieldMask |= LONET2Schema::GetFieldBit(Schema, *Field);
+			Result = ReadField(Cursor, *Field, Out);
+
+			if (Result != EResult::Decoded)
+			{
+				return Result;
+			}
+
+			// Senders put the name first, so a disabled subject costs little more than its name
+			if (Field->Target == LONET2Schema::EFieldTarget::SubjectName && IsSubjectEnabled != nullptr && !IsSubjectEnabled->Execute(Out.Section, Out.SubjectName))
+			{
+				bOutSkipped = true;
+				return SkipSectionMembers(Cursor);
+			}
+		} while (Cursor.Consume(','));
+
+		return Cursor.Consume('}') ? EResult::Decoded : EResult::Malformed;
+	}
+}
+
+const FLONET2StreamDecoder::FIsSubjectEnabled* FLONET2StreamDecoder::GetSubjectFilter() const
+{
+	if (!IsSubjectEnabled.IsBound() || (HasDisabledSubjects.IsBound() && !HasDisabledSubjects.Execute()))
+	{
+		return nullptr;
+	}
+	return &IsSubjectEnabled;
+}
+
+FLONET2StreamDecoder::EResult FLONET2StreamDecoder::Decode(const uint8* Data, int32 Num)
+{
+	using namespace LONET2StreamDecoder;
+
+	Sections.Reset();
+	LensTables.Reset();
+
+	const FIsSubjectEnabled* SubjectFilter = GetSubjectFilter();
+
+	FCursor Cursor{ reinterpret_cast<const ANSICHAR*>(Data), reinterpret_cast<const ANSICHAR*>(Data) + Num };
+
+	// UTF-8 byte order mark
+	if (Num >= 3 && Data[0] == 0xEF && Data[1] == 0xBB && Data[2] == 0xBF)
+	{
+		Cursor.Pos += 3;
+	}
+
+	if (!Cursor.Consume('{'))
+	{
+		return EResult::Malformed;
+	}
+
+	if (Cursor.Consume('}'))
+	{
+		return EResult::Decoded;
+	}
+
+	uint32 SeenSections = 0;
+	do
+	{
+		FAnsiStringView Key;
+		EResult Result = Cursor.ReadString(Key);
+		if (Result != EResult::Decoded)
+		{
+			return Result;
+		}
+		if (!Cursor.Consume(':'))
+		{
+			return EResult::Malformed;
+		}
+
+		if (const LONET2Schema::FSection* Schema = LONET2Schema::FindSection(Key))
+		{
+			const ELONET2Section Section = Schema->Section;
+
+			// A repeated section would replace the first one in FJsonObject
+			const uint32 SectionBit = 1u << static_cast<uint32>(Section);
+			if (SeenSections & SectionBit)
+			{
+				return EResult::Fallback;
+			}
+			SeenSections |= SectionBit;
+
+			if (Cursor.Consume('['))
+			{
+				// One section per subject, several subjects per datagram
+				Result = EResult::Decoded;
+				if (!Cursor.Consume(']'))
+				{
+					do
+					{
+						FLONET2DecodedSection& DecodedSection = Sections.AddDefaulted_GetRef();
+						DecodedSection.Section = Section;
+						bool bSkipped = false;
+						Result = ReadSection(Cursor, DecodedSection, SubjectFilter, bSkipped);
+						if (bSkipped)
+						{
+							Sections.Pop(false);
+						}
+					} while (Result == EResult::Decoded && Cursor.Consume(','));
+
+					if (Result == EResult::Decoded && !Cursor.Consume(']'))
+					{
+						Result = EResult::Malformed;
+					}
+				}
+			}
+			else
+			{
+				FLONET2DecodedSection& DecodedSection = Sections.AddDefaulted_GetRef();
+				DecodedSection.Section = Section;
+				bool bSkipped = false;
+				Result = ReadSection(Cursor, DecodedSection, SubjectFilter, bSkipped);
+				if (bSkipped)
+				{
+					Sections.Pop(false);
+				}
+			}
+		}
+		else if (KeyEquals(Key, "lens_calibration_data"))
+		{
+			Result = ReadLensTable(Cursor, LensTables.AddDefaulted_GetRef());
+		}
+		else
+		{
+			Result = Cursor.SkipValue();
+		}
+
+		if (Result != EResult::Decoded)
+		{
+			return Result;
+		}
+	} while (Cursor.Consume(','));
+
+	return Cursor.Consume('}') ? EResult::Decoded : EResult::Malformed;
+}
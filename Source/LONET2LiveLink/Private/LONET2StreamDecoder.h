@@ -0,0 +1,110 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LiveLinkTypes.h"
+#include "Misc/Timecode.h"
+#include "LONET2LensTable.h"
+
+enum class ELONET2Section : uint8
+{
+	Encoder,
+	Lens,
+	Camera,
+	Controller,
+};
+
+/** One LONET 2 section decoded straight into its LiveLink frame struct. Views point into the packet bytes. */
+struct FLONET2DecodedSection
+{
+	ELONET2Section Section = ELONET2Section::Camera;
+
+	FAnsiStringView SubjectName;
+	FAnsiStringView Timecode;
+	bool bHasTimecode = false;
+	double FrameRate = 24.0;
+
+	/** Binary packets carry the timecode as numbers, they skip string parsing. */
+	FTimecode ParsedTimecode;
+	bool bTimecodeParsed = false;
+
+	/** Binary packets may name the subject by a numeric id, SubjectName then views its decimal text. */
+	uint32 SubjectId = 0;
+	bool bSubjectIsId = false;
+	ANSICHAR SubjectIdBuffer[12];
+
+	/** Keyframe and delta mode, sections without a sequence number are always complete. */
+	uint32 Sequence = 0;
+	bool bHasSequence = false;
+	bool bKeyframe = false;
+
+	/** One bit per schema field the section carried, the fields a delta leaves out keep their last value. */
+	uint32 FieldMask = 0;
+
+	FLiveLinkFrameDataStruct FrameData;
+};
+
+/** A lens_calibration_data section, the calibration table of one camera. */
+struct FLONET2DecodedLensTable
+{
+	FAnsiStringView CameraName;
+
+	TArray<FLONET2LensSample> Samples;
+};
+
+/**
+ * SAX style decoder for LONET 2 JSON datagrams.
+ * Walks the raw UTF-8 bytes once and writes known keys directly into the frame structs, without building strings or JSON values.
+ * Anything it does not fully understand (unknown section keys, escaped strings, unexpected value types) yields Fallback so the caller can use the FJsonObject path.
+ * Binary packets decode into the same sections through DecodeBinary.
+ */
+class FLONET2StreamDecoder
+{
+public:
+
+	enum class EResult : uint8
+	{
+		Decoded,
+		Fallback,
+		Malformed,
+	};
+
+	/** Asked once a section's subject name is read, sections it returns false for are skipped without decoding their values. */
+	DECLARE_DELEGATE_RetVal_TwoParams(bool, FIsSubjectEnabled, ELONET2Section, FAnsiStringView);
+
+	/** Asked once per packet, false skips the per section name checks (and the formatting of numeric ids) for the whole packet. */
+	DECLARE_DELEGATE_RetVal(bool, FHasDisabledSubjects);
+
+	void SetSubjectFilter(FIsSubjectEnabled InIsSubjectEnabled, FHasDisabledSubjects InHasDisabledSubjects = FHasDisabledSubjects())
+	{
+		IsSubjectEnabled = MoveTemp(InIsSubjectEnabled);
+		HasDisabledSubjects = MoveTemp(InHasDisabledSubjects);
+	}
+
+	EResult Decode(const uint8* Data, int32 Num);
+
+	/** Decodes a packet in the LONET 2 binary format, see LONET2BinaryProtocol.h. */
+	EResult DecodeBinary(const uint8* Data, int32 Num);
+
+	static bool IsBinaryPacket(const uint8* Data, int32 Num);
+
+	/** Sections of the last successfully decoded packet, in packet order, without the skipped ones. */
+	TArrayView<FLONET2DecodedSection> GetSections() { return Sections; }
+
+	/** Lens calibration tables of the last successfully decoded packet, usually none. */
+	TArrayView<FLONET2DecodedLensTable> GetLensTables() { return LensTables; }
+
+private:
+
+	/** The subject filter to use for the packet being decoded, nullptr when it would let every section through. */
+	const FIsSubjectEnabled* GetSubjectFilter() const;
+
+	FIsSubjectEnabled IsSubjectEnabled;
+
+	FHasDisabledSubjects HasDisabledSubjects;
+
+	TArray<FLONET2DecodedSection, TInlineAllocator<4>> Sections;
+
+	TArray<FLONET2DecodedLensTable> LensTables;
+};
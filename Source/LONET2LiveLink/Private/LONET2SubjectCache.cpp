@@ -0,0 +1,219 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2SubjectCache.h"
+
+#include "Hash/CityHash.h"
+#include "LONET2StreamDecoder.h"
+#include "Misc/ScopeLock.h"
+
+uint64 FLONET2SubjectCache::HashName(ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender)
+{
+	return CityHash64WithSeeds(RawName.GetData(), RawName.Len(), static_cast<uint64>(Section) + 1, Sender.Value);
+}
+
+const TCHAR* FLONET2SubjectCache::GetSubjectSuffix(ELONET2Section Section)
+{
+	switch (Section)
+	{
+	case ELONET2Section::Encoder:
+		return TEXT(" Encoders");
+	case ELONET2Section::Lens:
+		return TEXT(" Lens");
+	case ELONET2Section::Controller:
+		return TEXT(" Controller");
+	default:
+		return TEXT("");
+	}
+}
+
+FName FLONET2SubjectCache::MakeSubjectName(ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender)
+{
+	TStringBuilder<128> NameBuilder;
+	if (Sender != FIPv4Address::Any)
+	{
+		NameBuilder << Sender.ToString() << TEXT('/');
+	}
+	FUTF8ToTCHAR NameConverter(RawName.GetData(), RawName.Len());
+	NameBuilder.Append(NameConverter.Get(), NameConverter.Length());
+	NameBuilder.Append(GetSubjectSuffix(Section));
+	return FName(NameBuilder.Len(), NameBuilder.GetData());
+}
+
+bool FLONET2SubjectCache::FindOrAdd(ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender, const FGuid& SourceGuid, double Now, FLiveLinkSubjectKey& OutSubjectKey)
+{
+	const uint64 Hash = HashName(Section, RawName, Sender);
+
+	FScopeLock Lock(&CriticalSection);
+
+	if (FEntry* Entry = Find(Hash, Section, RawName, Sender))
+	{
+		OutSubjectKey = Entry->SubjectKey;
+		Entry->LastSeen = Now;
+		if (!Entry->bStaticDataSent)
+		{
+			Entry->bStaticDataSent = true;
+			return true;
+		}
+		return false;
+	}
+
+	const FLiveLinkSubjectKey SubjectKey(SourceGuid, MakeSubjectName(Section, RawName, Sender));
+	OutSubjectKey = SubjectKey;
+	const bool bHashTaken = EntriesByHash.Contains(Hash);
+
+	// Another spelling of a known subject (different case) becomes an alias, a true 64 bit hash collision is served uncached
+	for (const TUniquePtr<FEntry>& Existing : Entries)
+	{
+		if (Existing->SubjectKey == SubjectKey)
+		{
+			if (!bHashTaken)
+			{
+				EntriesByHash.Add(Hash, Existing.Get());
+			}
+			Existing->LastSeen = Now;
+
+			const bool bSendStaticData = !Existing->bStaticDataSent;
+			Existing->bStaticDataSent = true;
+			return bSendStaticData;
+		}
+	}
+
+	TUniquePtr<FEntry>& NewEntry = Entries.Add_GetRef(MakeUnique<FEntry>());
+	NewEntry->RawName.Append(RawName.GetData(), RawName.Len());
+	NewEntry->Section = Section;
+	NewEntry->Sender = Sender;
+	NewEntry->SubjectKey = SubjectKey;
+	NewEntry->bStaticDataSent = true;
+	NewEntry->LastSeen = Now;
+
+	if (!bHashTaken)
+	{
+		EntriesByHash.Add(Hash, NewEntry.Get());
+	}
+	return true;
+}
+
+FLONET2SubjectCache::FEntry* FLONET2SubjectCache::Find(uint64 Hash, ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender) const
+{
+	FEntry* Entry = EntriesByHash.FindRef(Hash);
+	// FNames compare case insensitively, so names differing only in case share one subject
+	if (Entry != nullptr && Entry->Section == Section && Entry->Sender == Sender && FAnsiStringView(Entry->RawName.GetData(), Entry->RawName.Num()).Equals(RawName, ESearchCase::IgnoreCase))
+	{
+		return Entry;
+	}
+	return nullptr;
+}
+
+bool FLONET2SubjectCache::IsEnabled(ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender, double Now)
+{
+	if (!HasDisabledSubjects())
+	{
+		return true;
+	}
+
+	const uint64 Hash = HashName(Section, RawName, Sender);
+
+	FScopeLock Lock(&CriticalSection);
+
+	FEntry* Entry = Find(Hash, Section, RawName, Sender);
+	if (Entry == nullptr || Entry->bEnabled)
+	{
+		return true;
+	}
+
+	// A disabled subject that keeps sending is not idle
+	Entry->LastSeen = Now;
+	return false;
+}
+
+void FLONET2SubjectCache::RefreshEnabled(TFunctionRef<bool(const FLiveLinkSubjectKey&)> IsSubjectEnabled)
+{
+	TArray<FLiveLinkSubjectKey> SubjectKeys;
+	{
+		FScopeLock Lock(&CriticalSection);
+		SubjectKeys.Reserve(Entries.Num());
+		for (const TUniquePtr<FEntry>& Entry : Entries)
+		{
+			SubjectKeys.Add(Entry->SubjectKey);
+		}
+	}
+
+	TBitArray<> Enabled;
+	Enabled.Reserve(SubjectKeys.Num());
+	for (const FLiveLinkSubjectKey& SubjectKey : SubjectKeys)
+	{
+		Enabled.Add(IsSubjectEnabled(SubjectKey));
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
+	// Entries may have come and gone meanwhile, new ones stay enabled until the next refresh
+	for (const TUniquePtr<FEntry>& Entry : Entries)
+	{
+		const int32 Index = SubjectKeys.IndexOfByKey(Entry->SubjectKey);
+		if (Index != INDEX_NONE && Entry->bEnabled != Enabled[Index])
+		{
+			Entry->bEnabled = Enabled[Index];
+			Entry->bEnabled ? NumDisabled.Decrement() : NumDisabled.Increment();
+		}
+	}
+}
+
+void FLONET2SubjectCache::RemoveIdle(double Now, double IdleSeconds, TArray<FLiveLinkSubjectKey>& OutSubjectKeys)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	OutSubjectKeys.Reset();
+	for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+	{
+		FEntry* Entry = Entries[Index].Get();
+		if (Now - Entry->LastSeen < IdleSeconds)
+		{
+			continue;
+		}
+
+		OutSubjectKeys.Add(Entry->SubjectKey);
+		if (!Entry->bEnabled)
+		{
+			NumDisabled.Decrement();
+		}
+
+		// Aliases (other spellings) of the subject point at the same entry
+		for (auto It = EntriesByHash.CreateIterator(); It; ++It)
+		{
+			if (It.Value() == Entry)
+			{
+				It.RemoveCurrent();
+			}
+		}
+		Entries.RemoveAtSwap(Index);
+	}
+}
+
+void FLONET2SubjectCache::ResendStaticData(TConstArrayView<FLiveLinkSubjectKey> SubjectKeys)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	for (const TUniquePtr<FEntry>& Entry : Entries)
+	{
+		if (SubjectKeys.Contains(Entry->SubjectKey))
+		{
+			Entry->bStaticDataSent = false;
+		}
+	}
+}
+
+void FLONET2SubjectCache::Empty(TArray<FLiveLinkSubjectKey>& OutSubjectKeys)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	OutSubjectKeys.Reset(Entries.Num());
+	for (const TUniquePtr<FEntry>& Entry : Entries)
+	{
+		OutSubjectKeys.Add(Entry->SubjectKey);
+	}
+
+	EntriesByHash.Empty();
+	Entries.Empty();
+	NumDisabled.Reset();
+}
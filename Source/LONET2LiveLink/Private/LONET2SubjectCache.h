@@ -0,0 +1,82 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+#include "LiveLinkTypes.h"
+
+enum class ELONET2Section : uint8;
+
+/**
+ * Maps the raw UTF-8 subject name of a section to its prebuilt LiveLink subject key.
+ * Steady state lookups hash the packet bytes once, no FString or FName is built after the first packet of a subject.
+ */
+class FLONET2SubjectCache
+{
+public:
+
+	/**
+	 * Finds or creates the subject for RawName in Section, noting it as seen at Now.
+	 * A Sender other than FIPv4Address::Any namespaces the subject by sender, its name gets the address as a prefix ("10.0.0.21/Camera1").
+	 * Returns true exactly once per subject, when the caller has to push its static data.
+	 */
+	bool FindOrAdd(ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender, const FGuid& SourceGuid, double Now, FLiveLinkSubjectKey& OutSubjectKey);
+
+	/**
+	 * False if the subject is known and disabled in LiveLink, the section is then skipped but still counts as seen at Now.
+	 * Returns true at once, without hashing the name, while no subject is disabled.
+	 */
+	bool IsEnabled(ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender, double Now);
+
+	/** Lock free, lets decoders skip IsEnabled for a whole packet while every subject is enabled. */
+	bool HasDisabledSubjects() const { return NumDisabled.GetValue() > 0; }
+
+	/** Asks IsSubjectEnabled for every subject and keeps the answers for IsEnabled. IsSubjectEnabled is called without the lock held. */
+	void RefreshEnabled(TFunctionRef<bool(const FLiveLinkSubjectKey&)> IsSubjectEnabled);
+
+	/** Forgets every subject not seen for IdleSeconds, returning their keys. A forgotten subject is created anew when it comes back. */
+	void RemoveIdle(double Now, double IdleSeconds, TArray<FLiveLinkSubjectKey>& OutSubjectKeys);
+
+	/**
+	 * Has the static data of these subjects pushed again with their next section, for subjects that came back while
+	 * RemoveIdle's caller was still removing them from LiveLink.
+	 */
+	void ResendStaticData(TConstArrayView<FLiveLinkSubjectKey> SubjectKeys);
+
+	/** Empties the cache, returning the keys of every subject that was registered. */
+	void Empty(TArray<FLiveLinkSubjectKey>& OutSubjectKeys);
+
+	static const TCHAR* GetSubjectSuffix(ELONET2Section Section);
+
+private:
+
+	struct FEntry
+	{
+		TArray<ANSICHAR> RawName;
+		ELONET2Section Section;
+		FIPv4Address Sender;
+		FLiveLinkSubjectKey SubjectKey;
+		bool bStaticDataSent = false;
+		bool bEnabled = true;
+		double LastSeen = 0.0;
+	};
+
+	/** The entry for the name, nullptr if unknown. Call with the lock held. */
+	FEntry* Find(uint64 Hash, ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender) const;
+
+	static uint64 HashName(ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender);
+
+	static FName MakeSubjectName(ELONET2Section Section, FAnsiStringView RawName, const FIPv4Address& Sender);
+
+	FCriticalSection CriticalSection;
+
+	TMap<uint64, FEntry*> EntriesByHash;
+
+	TArray<TUniquePtr<FEntry>> Entries;
+
+	/** Entries with bEnabled false. */
+	FThreadSafeCounter NumDisabled;
+};
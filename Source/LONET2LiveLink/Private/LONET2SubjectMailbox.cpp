@@ -0,0 +1,113 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2SubjectMailbox.h"
+
+#include "Misc/ScopeLock.h"
+
+void FLONET2SubjectMailbox::SetDefaultDepth(int32 InDepth)
+{
+	FScopeLock Lock(&CriticalSection);
+	DefaultDepth = FMath::Max(InDepth, 1);
+
+	for (TPair<FName, FSlot>& Pair : Slots)
+	{
+		Pair.Value.Depth = GetDepth(Pair.Key);
+	}
+}
+
+void FLONET2SubjectMailbox::SetSubjectDepth(FName SubjectName, int32 InDepth)
+{
+	FScopeLock Lock(&CriticalSection);
+	SubjectDepths.Add(SubjectName, FMath::Max(InDepth, 1));
+
+	if (FSlot* Slot = Slots.Find(SubjectName))
+	{
+		Slot->Depth = GetDepth(SubjectName);
+	}
+}
+
+void FLONET2SubjectMailbox::ResetSubjectDepths()
+{
+	FScopeLock Lock(&CriticalSection);
+	SubjectDepths.Reset();
+
+	for (TPair<FName, FSlot>& Pair : Slots)
+	{
+		Pair.Value.Depth = DefaultDepth;
+	}
+}
+
+int32 FLONET2SubjectMailbox::GetDepth(FName SubjectName) const
+{
+	const int32* Depth = SubjectDepths.Find(SubjectName);
+	return Depth ? *Depth : DefaultDepth;
+}
+
+void FLONET2SubjectMailbox::Post(FName SubjectName, FLiveLinkFrameDataStruct&& FrameData)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	FSlot* Slot = Slots.Find(SubjectName);
+	if (Slot == nullptr)
+	{
+		Slot = &Slots.Add(SubjectName);
+		Slot->Depth = GetDepth(SubjectName);
+	}
+
+	if (Slot->Frames.Num() == 0)
+	{
+		PendingSubjects.Add(SubjectName);
+	}
+	else if (Slot->Frames.Num() >= Slot->Depth)
+	{
+		const int32 NumSuperseded = Slot->Frames.Num() - Slot->Depth + 1;
+		Slot->Frames.RemoveAt(0, NumSuperseded, false);
+		SupersededCount += NumSuperseded;
+	}
+
+	Slot->Frames.Add(MoveTemp(FrameData));
+}
+
+void FLONET2SubjectMailbox::Flush(TFunctionRef<void(FName, FLiveLinkFrameDataStruct&&)> Push)
+{
+	{
+		// Move frames out so LiveLink is never called with the mailbox locked
+		FScopeLock Lock(&CriticalSection);
+		for (const FName& SubjectName : PendingSubjects)
+		{
+			FSlot& Slot = Slots.FindChecked(SubjectName);
+			for (FLiveLinkFrameDataStruct& FrameData : Slot.Frames)
+			{
+				FlushScratch.Emplace(SubjectName, MoveTemp(FrameData));
+			}
+			Slot.Frames.Reset();
+		}
+		PendingSubjects.Reset();
+	}
+
+	for (TPair<FName, FLiveLinkFrameDataStruct>& Pending : FlushScratch)
+	{
+		Push(Pending.Key, MoveTemp(Pending.Value));
+	}
+	FlushScratch.Reset();
+}
+
+void FLONET2SubjectMailbox::Remove(FName SubjectName)
+{
+	FScopeLock Lock(&CriticalSection);
+	Slots.Remove(SubjectName);
+	PendingSubjects.Remove(SubjectName);
+}
+
+void FLONET2SubjectMailbox::Empty()
+{
+	FScopeLock Lock(&CriticalSection);
+	Slots.Empty();
+	PendingSubjects.Empty();
+}
+
+uint64 FLONET2SubjectMailbox::GetSupersededCount() const
+{
+	FScopeLock Lock(&CriticalSection);
+	return SupersededCount;
+}
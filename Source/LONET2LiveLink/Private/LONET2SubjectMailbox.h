@@ -0,0 +1,62 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "LiveLinkTypes.h"
+
+/**
+ * Per subject mailbox between decoding and pushing to LiveLink.
+ * Each subject keeps only its newest frames (one by default), frames replaced before they were pushed are counted as superseded.
+ */
+class FLONET2SubjectMailbox
+{
+public:
+
+	/** Number of frames kept per subject unless overridden, 1 means latest wins. */
+	void SetDefaultDepth(int32 InDepth);
+
+	/** Keep up to InDepth frames for subjects that need every sample. */
+	void SetSubjectDepth(FName SubjectName, int32 InDepth);
+
+	/** Drops every SetSubjectDepth override, the subjects go back to the default depth. */
+	void ResetSubjectDepths();
+
+	void Post(FName SubjectName, FLiveLinkFrameDataStruct&& FrameData);
+
+	/** Hands every pending frame to Push, oldest first per subject. Called from the decode stage only. */
+	void Flush(TFunctionRef<void(FName, FLiveLinkFrameDataStruct&&)> Push);
+
+	void Remove(FName SubjectName);
+
+	void Empty();
+
+	uint64 GetSupersededCount() const;
+
+private:
+
+	struct FSlot
+	{
+		TArray<FLiveLinkFrameDataStruct, TInlineAllocator<1>> Frames;
+		int32 Depth = 1;
+	};
+
+	int32 GetDepth(FName SubjectName) const;
+
+	mutable FCriticalSection CriticalSection;
+
+	TMap<FName, FSlot> Slots;
+
+	/** Subjects with frames waiting, in the order they were first posted. */
+	TArray<FName> PendingSubjects;
+
+	/** Frames handed to Push in the current flush, reused between flushes. */
+	TArray<TPair<FName, FLiveLinkFrameDataStruct>> FlushScratch;
+
+	int32 DefaultDepth = 1;
+
+	TMap<FName, int32> SubjectDepths;
+
+	uint64 SupersededCount = 0;
+};
@@ -0,0 +1,106 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2SyntheticTraffic.h"
+
+#include "LONET2BinaryProtocol.h"
+#include "LONET2StreamDecoder.h"
+
+namespace LONET2SyntheticTraffic
+{
+	FString MakeTimecode(int32 Frame)
+	{
+		return FString::Printf(TEXT("%02d:%02d:%02d:%02d"), 10 + Frame / (24 * 3600), (Frame / (24 * 60)) % 60, (Frame / 24) % 60, Frame % 24);
+	}
+
+	FTimecode MakeFTimecode(int32 Frame)
+	{
+		return FTimecode(10 + Frame / (24 * 3600), (Frame / (24 * 60)) % 60, (Frame / 24) % 60, Frame % 24, false);
+	}
+
+	const TCHAR* GetJsonKey(ELONET2Section Section)
+	{
+		switch (Section)
+		{
+		case ELONET2Section::Encoder:
+			return TEXT("encoder_data");
+		case ELONET2Section::Lens:
+			return TEXT("distortion_data");
+		case ELONET2Section::Camera:
+			return TEXT("camera_transform_data");
+		case ELONET2Section::Controller:
+		default:
+			return TEXT("controller_data");
+		}
+	}
+
+	FString MakeJsonSection(ELONET2Section Section, const FString& SubjectName, int32 Frame)
+	{
+		const FString Timecode = MakeTimecode(Frame);
+		const float Wobble = (Frame % 100) * 0.001f;
+
+		switch (Section)
+		{
+		case ELONET2Section::Encoder:
+			return FString::Printf(TEXT("{\"cameraName\":\"%s\",\"timecode\":\"%s\",\"frameRate\":24,\"focalLengthMapped\":%f,\"irisMapped\":2.8,\"focusMapped\":%f}"),
+				*SubjectName, *Timecode, 35.0f + Wobble, 3.2f + Wobble);
+		case ELONET2Section::Lens:
+			return FString::Printf(TEXT("{\"cameraName\":\"%s\",\"timecode\":\"%s\",\"frameRate\":24,\"focalLengthMapped\":%f,\"irisMapped\":2.8,\"focusMapped\":3.2,")
+				TEXT("\"fXfY\":[1.21,2.15],\"principalPoint\":[0.501,0.498],\"distortionParameters\":[0.012,-0.021,0.0004,0.0,0.001]}"),
+				*SubjectName, *Timecode, 35.0f + Wobble);
+		case ELONET2Section::Camera:
+			return FString::Printf(TEXT("{\"cameraName\":\"%s\",\"timecode\":\"%s\",\"frameRate\":24,\"position\":[%f,152.4,-33.1],\"orientation\":[0.01,0.02,%f,0.999],")
+				TEXT("\"focalLengthRaw\":35.0,\"irisRaw\":2.8,\"focusRaw\":3.2,\"whiteBalance\":5600,\"tint\":0,\"ISO\":800,\"shutter\":180,\"sensorSize\":[36.0,24.0]}"),
+				*SubjectName, *Timecode, 12.5f + Wobble, Wobble);
+		case ELONET2Section::Controller:
+		default:
+			return FString::Printf(TEXT("{\"controllerName\":\"%s\",\"timecode\":\"%s\",\"frameRate\":24,\"button1\":0,\"button2\":1,\"button3\":0,\"trigger\":%f,")
+				TEXT("\"touchpadPressed\":0,\"touchpadX\":%f,\"touchpadY\":0.5}"),
+				*SubjectName, *Timecode, Wobble, Wobble);
+		}
+	}
+
+	void AddBinarySection(FLONET2BinaryWriter& Writer, ELONET2Section Section, const FString& SubjectName, int32 Frame)
+	{
+		const float Wobble = (Frame % 100) * 0.001f;
+
+		FLONET2BinarySectionHeader Header;
+		Header.SubjectName = SubjectName;
+		Header.Timecode = MakeFTimecode(Frame);
+
+		switch (Section)
+		{
+		case ELONET2Section::Encoder:
+		{
+			FLONET2BinaryEncoderData Data;
+			Data.FocalLength = 35.0f + Wobble;
+			Data.Iris = 2.8f;
+			Data.Focus = 3.2f + Wobble;
+			Writer.AddEncoder(Header, Data);
+			break;
+		}
+		case ELONET2Section::Lens:
+		{
+			FLONET2BinaryDistortionData Data;
+			Data.FocalLength = 35.0f + Wobble;
+			Data.DistortionParameters = { 0.012f, -0.021f, 0.0004f, 0.0f, 0.001f };
+			Writer.AddDistortion(Header, Data);
+			break;
+		}
+		case ELONET2Section::Camera:
+		{
+			FLONET2BinaryCameraData Data;
+			Data.Position[0] = 12.5f + Wobble;
+			Data.FocalLength = 35.0f;
+			Writer.AddCamera(Header, Data);
+			break;
+		}
+		case ELONET2Section::Controller:
+		{
+			FLONET2BinaryControllerData Data;
+			Data.Trigger = Wobble;
+			Writer.AddController(Header, Data);
+			break;
+		}
+		}
+	}
+}
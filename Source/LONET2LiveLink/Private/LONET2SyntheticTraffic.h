@@ -0,0 +1,28 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Timecode.h"
+
+enum class ELONET2Section : uint8;
+class FLONET2BinaryWriter;
+
+/**
+ * Synthetic LONET 2 sections, shared by the benchmark and the load generator.
+ * Values wobble with the frame number so consecutive packets differ like a live feed.
+ */
+namespace LONET2SyntheticTraffic
+{
+	/** 24 fps timecode of the frame, counted from 10:00:00:00. */
+	FString MakeTimecode(int32 Frame);
+	FTimecode MakeFTimecode(int32 Frame);
+
+	/** Key of the section in a JSON datagram, e.g. encoder_data. */
+	const TCHAR* GetJsonKey(ELONET2Section Section);
+
+	/** JSON object of one section for one subject and frame. */
+	FString MakeJsonSection(ELONET2Section Section, const FString& SubjectName, int32 Frame);
+
+	void AddBinarySection(FLONET2BinaryWriter& Writer, ELONET2Section Section, const FString& SubjectName, int32 Frame);
+}
@@ -0,0 +1,102 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "LONET2UdpReceiver.h"
+
+#include "HAL/PlatformProcess.h"
+#include "LONET2PacketPool.h"
+#include "LONET2Socket.h"
+#include "LONET2Stats.h"
+
+FLONET2UdpReceiver::FLONET2UdpReceiver(TArray<FLONET2Socket*> InSockets, FLONET2PacketPool& InPool, FTimespan InWaitTime, int32 InBatchSize, FOnPacketsReceived InOnPacketsReceived,
+	const TCHAR* ThreadName, EThreadPriority Priority, uint64 AffinityMask)
+	: Sockets(MoveTemp(InSockets))
+	, WaitTimeTicks(InWaitTime.GetTicks())
+	, OnPacketsReceived(InOnPacketsReceived)
+	, Batch(InPool, InBatchSize)
+{
+	StartThread(ThreadName, Priority, AffinityMask);
+}
+
+FLONET2UdpReceiver::~FLONET2UdpReceiver()
+{
+	StopThread();
+}
+
+void FLONET2UdpReceiver::SetWaitTime(FTimespan InWaitTime)
+{
+	WaitTimeTicks.Set(InWaitTime.GetTicks());
+}
+
+uint32 FLONET2UdpReceiver::Run()
+{
+	while (!bStopping)
+	{
+		ApplyThreadAffinity();
+
+		if (!FLONET2Socket::WaitForRead(Sockets, FTimespan(WaitTimeTicks.GetValue()), ReadableSockets, &Waker))
+		{
+			continue;
+		}
+
+		// Keep reading until every socket is drained, one batch per socket in turn so a busy feed cannot starve the others
+		bool bAnyPending = true;
+		while (bAnyPending && !bStopping)
+		{
+			bAnyPending = false;
+			for (TConstSetBitIterator<> It(ReadableSockets); It && !bStopping; ++It)
+			{
+				bool bPoolExhausted = false;
+				if (ReceiveBatch(*Sockets[It.GetIndex()], bPoolExhausted))
+				{
+					bAnyPending = true;
+				}
+				else
+				{
+					ReadableSockets[It.GetIndex()] = false;
+				}
+
+				if (bPoolExhausted)
+				{
+					// Every packet is still queued for decoding, leave the rest in the socket buffers
+					FPlatformProcess::SleepNoStats(0.001f);
+					bAnyPending = false;
+					break;
+				}
+			}
+		}
+	}
+
+	Batch.Release();
+
+	return 0;
+}
+
+bool FLONET2UdpReceiver::ReceiveBatch(FLONET2Socket& Socket, bool& bOutPoolExhausted)
+{
+	const TArrayView<FLONET2Packet*> Packets = Batch.Refill();
+	if (Packets.Num() == 0)
+	{
+		bOutPoolExhausted = true;
+		return false;
+	}
+
+	// One syscall per batch where the platform allows it
+	int32 NumReceived = 0;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LONET2_Receive);
+		NumReceived = Socket.ReceiveBatch(Packets);
+	}
+	if (NumReceived > 0)
+	{
+		OnPacketsReceived.Execute(Packets.Left(NumReceived));
+		Batch.HandOver(NumReceived);
+	}
+
+	return NumReceived == Packets.Num();
+}
+
+void FLONET2UdpReceiver::Stop()
+{
+	bStopping = true;
+	Waker.Wake();
+}
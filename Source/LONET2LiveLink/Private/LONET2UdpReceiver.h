@@ -0,0 +1,56 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "LONET2PacketPool.h"
+#include "LONET2Runnable.h"
+#include "LONET2Socket.h"
+
+/**
+ * Receive thread for one or more LONET 2 sockets.
+ * The thread waits on all of its sockets at once, and every wakeup drains all pending datagrams into pooled packets,
+ * handing them over one batch per socket read.
+ */
+class FLONET2UdpReceiver : public FLONET2Runnable
+{
+public:
+
+	/** The handler takes ownership of every packet in the batch and releases them to the pool once decoded. */
+	DECLARE_DELEGATE_OneParam(FOnPacketsReceived, TArrayView<FLONET2Packet*>);
+
+	FLONET2UdpReceiver(TArray<FLONET2Socket*> InSockets, FLONET2PacketPool& InPool, FTimespan InWaitTime, int32 InBatchSize, FOnPacketsReceived InOnPacketsReceived,
+		const TCHAR* ThreadName, EThreadPriority Priority = TPri_AboveNormal, uint64 AffinityMask = 0);
+	virtual ~FLONET2UdpReceiver();
+
+	/** Longest wait between wakeups without data, used from the next wait on. Stop() wakes the thread at once. */
+	void SetWaitTime(FTimespan InWaitTime);
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable Interface
+
+private:
+
+	/** Reads one batch from a socket and hands it over, false once the socket is drained or the pool is empty. */
+	bool ReceiveBatch(FLONET2Socket& Socket, bool& bOutPoolExhausted);
+
+	TArray<FLONET2Socket*> Sockets;
+
+	TBitArray<> ReadableSockets;
+
+	/** FTimespan ticks, set from the game thread. */
+	FThreadSafeCounter64 WaitTimeTicks;
+
+	FOnPacketsReceived OnPacketsReceived;
+
+	FLONET2PacketBatch Batch;
+
+	FThreadSafeBool bStopping;
+
+	/** Cuts the socket wait short when the thread is stopped. */
+	FLONET2SocketWaker Waker;
+};
@@ -3,6 +3,59 @@
 
 #include "LoledUtilities.h"
 
+#include "LONET2LiveLinkSource.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+
+namespace LoledTimecode
+{
+	struct FNominalFrameRate
+	{
+		double Nominal;
+		int32 Numerator;
+		int32 Denominator;
+		bool bDropFrame;
+	};
+
+	/** Rates LONET senders report, with the rational they stand for. */
+	static const FNominalFrameRate NominalFrameRates[] =
+	{
+		{ 23.976, 24000, 1001, false },
+		{ 24.0, 24, 1, false },
+		{ 25.0, 25, 1, false },
+		{ 29.97, 30000, 1001, true },
+		{ 30.0, 30, 1, false },
+		{ 47.952, 48000, 1001, false },
+		{ 48.0, 48, 1, false },
+		{ 50.0, 50, 1, false },
+		{ 59.94, 60000, 1001, true },
+		{ 60.0, 60, 1, false },
+		{ 119.88, 120000, 1001, false },
+		{ 120.0, 120, 1, false },
+	};
+
+	/** Senders round NTSC rates differently (23.976 or 23.98), this still keeps 29.97 apart from 30. */
+	static constexpr double NominalTolerance = 0.01;
+
+	static constexpr double MalformedLogInterval = 5.0;
+
+	static bool IsSeparator(ANSICHAR Char)
+	{
+		return Char == ':' || Char == ';' || Char == '.';
+	}
+
+	static int32 WriteTwoDigits(ANSICHAR* Out, int32 Value)
+	{
+		if (Value < 0 || Value > 99)
+		{
+			return 0;
+		}
+		Out[0] = '0' + Value / 10;
+		Out[1] = '0' + Value % 10;
+		return 2;
+	}
+}
+
 LoledUtilities::LoledUtilities()
 {
 }
@@ -11,40 +64,202 @@ LoledUtilities::~LoledUtilities()
 {
 }
 
+FFrameRate LoledUtilities::frameRateFromNumber(double frameRate, bool& outDropFrame)
+{
+	for (const LoledTimecode::FNominalFrameRate& Nominal : LoledTimecode::NominalFrameRates)
+	{
+		if (FMath::Abs(frameRate - Nominal.Nominal) < LoledTimecode::NominalTolerance)
+		{
+			outDropFrame = Nominal.bDropFrame;
+			return FFrameRate(Nominal.Numerator, Nominal.Denominator);
+		}
+	}
+
+	outDropFrame = false;
+	if (FMath::IsNearlyEqual(frameRate, FMath::RoundToDouble(frameRate), LoledTimecode::NominalTolerance))
+	{
+		return FFrameRate(FMath::Max(1, FMath::RoundToInt(frameRate)), 1);
+	}
+	return FFrameRate(FMath::Max(1, FMath::RoundToInt(frameRate * 1000.0)), 1000);
+}
+
+bool LoledUtilities::parseTimecode(FAnsiStringView timecode, FTimecode& outTimecode)
+{
+	int32 Fields[4] = { 0, 0, 0, 0 };
+	int32 FieldIndex = 0;
+	int32 FieldDigits = 0;
+
+	for (const ANSICHAR Char : timecode)
+	{
+		if (Char >= '0' && Char <= '9')
+		{
+			// Three digits leave room for high frame numbers, anything longer is garbage
+			if (++FieldDigits > 3)
+			{
+				return false;
+			}
+			Fields[FieldIndex] = Fields[FieldIndex] * 10 + (Char - '0');
+		}
+		else if (LoledTimecode::IsSeparator(Char))
+		{
+			if (FieldDigits == 0 || ++FieldIndex == 4)
+			{
+				return false;
+			}
+			FieldDigits = 0;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	if (FieldIndex != 3 || FieldDigits == 0)
+	{
+		return false;
+	}
+
+	outTimecode.Hours = Fields[0];
+	outTimecode.Minutes = Fields[1];
+	outTimecode.Seconds = Fields[2];
+	outTimecode.Frames = Fields[3];
+	return true;
+}
+
+void LoledUtilities::logMalformedTimecode(FAnsiStringView timecode)
+{
+	static FCriticalSection LogLock;
+	static double LastLogTime = -LoledTimecode::MalformedLogInterval;
+	static int32 SuppressedCount = 0;
+
+	FScopeLock Lock(&LogLock);
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - LastLogTime < LoledTimecode::MalformedLogInterval)
+	{
+		++SuppressedCount;
+		return;
+	}
+
+	UE_LOG(ModuleLog, Warning, TEXT("LOLED|Timecode Malformed: '%s' (%d more since last report)"), *FString(timecode), SuppressedCount);
+	LastLogTime = Now;
+	SuppressedCount = 0;
+}
+
+FQualifiedFrameTime LoledUtilities::timeFromTimecode(FTimecode timecode, float frameRate)
+{
+	bool dropFrame = false;
+	const FFrameRate rate = frameRateFromNumber(frameRate, dropFrame);
+
+	timecode.bDropFrameFormat = dropFrame;
+	return FQualifiedFrameTime(timecode, rate);
+}
+
 FQualifiedFrameTime LoledUtilities::timeFromTimecodeString(FString timecode, float frameRate)
+{
+	FQualifiedFrameTime time;
+	timeFromTimecodeString(MoveTemp(timecode), frameRate, time);
+	return time;
+}
+
+bool LoledUtilities::timeFromTimecodeString(FString timecode, float frameRate, FQualifiedFrameTime& outTime)
 {
 	bool dropFrame = false;
-	FTimecode TimeCode;
-	TArray<FString> splitDataTC;
+	const FFrameRate rate = frameRateFromNumber(frameRate, dropFrame);
 
+	const FTCHARToUTF8 timecodeUtf8(*timecode);
+	const FAnsiStringView timecodeView(timecodeUtf8.Get(), timecodeUtf8.Length());
 
-	int num = 0;
-	int dem = 0;
-	
-	if (frameRate == 29.97) {
-		dem = 1001;
-		num = (int)FMath::RoundHalfFromZero(frameRate) * 1000;
-		dropFrame = true;
+	FTimecode TimeCode;
+	if (!parseTimecode(timecodeView, TimeCode))
+	{
+		logMalformedTimecode(timecodeView);
+		outTime = FQualifiedFrameTime(FTimecode(), rate);
+		return false;
 	}
-	else {
-		dem = 1;
-		num = (int)frameRate;
+
+	TimeCode.bDropFrameFormat = dropFrame;
+	outTime = FQualifiedFrameTime(TimeCode, rate);
+	return true;
+}
+
+bool FLONET2TimecodeParser::Parse(FAnsiStringView Timecode, double FrameRate, FQualifiedFrameTime& OutTime)
+{
+	for (FRecentTimecode& Entry : Recent)
+	{
+		if (Entry.TextLength == 0 || Entry.FrameRate != FrameRate)
+		{
+			continue;
+		}
+
+		// Sections of one packet share a timecode, consecutive packets are usually one frame apart
+		if (Timecode.Equals(FAnsiStringView(Entry.Text, Entry.TextLength)))
+		{
+			OutTime = FQualifiedFrameTime(Entry.Timecode, Entry.Rate);
+			return true;
+		}
+		if (Entry.NextTextLength > 0 && Timecode.Equals(FAnsiStringView(Entry.NextText, Entry.NextTextLength)))
+		{
+			const FTimecode NextTimecode = Entry.NextTimecode;
+			const FFrameRate Rate = Entry.Rate;
+			Remember(Entry, Timecode, NextTimecode, FrameRate, Rate, Entry.bDropFrame);
+			OutTime = FQualifiedFrameTime(NextTimecode, Rate);
+			return true;
+		}
 	}
 
-	timecode.ParseIntoArray(splitDataTC, TEXT(":"), true);
+	bool bDropFrame = false;
+	const FFrameRate Rate = LoledUtilities::frameRateFromNumber(FrameRate, bDropFrame);
 
-	if (splitDataTC.Num() != 4) {
-		UE_LOG(LogTemp, Warning, TEXT("TC Packet %s \n"), *timecode);
-		UE_LOG(LogTemp, Warning, TEXT("LOLED|Timecode Malformed"));
-		UE_LOG(LogTemp, Warning, TEXT("LOLED|Got %i"), splitDataTC.Num());
+	FTimecode Parsed;
+	if (!LoledUtilities::parseTimecode(Timecode, Parsed))
+	{
+		LoledUtilities::logMalformedTimecode(Timecode);
+		OutTime = FQualifiedFrameTime(FTimecode(), Rate);
+		return false;
 	}
-	else {
-		TimeCode.Hours = FCString::Atoi(*splitDataTC[0]);
-		TimeCode.Minutes = FCString::Atoi(*splitDataTC[1]);
-		TimeCode.Seconds = FCString::Atoi(*splitDataTC[2]);
-		TimeCode.Frames = FCString::Atoi(*splitDataTC[3]);
-		TimeCode.bDropFrameFormat = dropFrame;
+	Parsed.bDropFrameFormat = bDropFrame;
+
+	if (Timecode.Len() <= MaxTimecodeLength)
+	{
+		Remember(Recent[NextSlot], Timecode, Parsed, FrameRate, Rate, bDropFrame);
+		NextSlot = (NextSlot + 1) % NumRecent;
 	}
 
-    return FQualifiedFrameTime(TimeCode, FFrameRate(num, dem));
+	OutTime = FQualifiedFrameTime(Parsed, Rate);
+	return true;
+}
+
+void FLONET2TimecodeParser::Remember(FRecentTimecode& Entry, FAnsiStringView Text, const FTimecode& Timecode, double FrameRate, const FFrameRate& Rate, bool bDropFrame)
+{
+	Entry.FrameRate = FrameRate;
+	Entry.Rate = Rate;
+	Entry.bDropFrame = bDropFrame;
+	Entry.Timecode = Timecode;
+
+	FMemory::Memcpy(Entry.Text, Text.GetData(), Text.Len());
+	Entry.TextLength = Text.Len();
+
+	// Predict the text of the following frame, FTimecode handles the rollover and drop frame numbering
+	Entry.NextTimecode = FTimecode::FromFrameNumber(Timecode.ToFrameNumber(Rate) + 1, Rate, bDropFrame);
+
+	const ANSICHAR FrameSeparator = Text.Len() > 3 ? Text[Text.Len() - 3] : ':';
+	const int32 Values[4] = { Entry.NextTimecode.Hours, Entry.NextTimecode.Minutes, Entry.NextTimecode.Seconds, Entry.NextTimecode.Frames };
+
+	int32 Length = 0;
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		const int32 Written = LoledTimecode::WriteTwoDigits(Entry.NextText + Length, Values[Index]);
+		if (Written == 0)
+		{
+			Length = 0;
+			break;
+		}
+		Length += Written;
+		if (Index < 3)
+		{
+			Entry.NextText[Length++] = Index == 2 ? FrameSeparator : ':';
+		}
+	}
+	Entry.NextTextLength = Length;
 }
@@ -4,6 +4,7 @@
 #include "Interfaces/IPv4/IPv4Endpoint.h"
 #include "Widgets/SBoxPanel.h"
 #include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
 #include "Widgets/Input/SEditableTextBox.h"
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Text/STextBlock.h"
@@ -33,7 +34,8 @@ void SLONET2LiveLinkSourceFactory::Construct(const FArguments& Args)
 				.FillWidth(0.5f)
 				[
 					SNew(STextBlock)
-					.Text(LOCTEXT("JSONPortNumber", "Port Number"))
+					.Text(LOCTEXT("JSONPortNumber", "Endpoints"))
+					.ToolTipText(LOCTEXT("EndpointsTooltip", "One endpoint, a comma separated list received by a single thread, or shm://name for senders on this host (Linux only)"))
 				]
 				+ SHorizontalBox::Slot()
 				.HAlign(HAlign_Fill)
@@ -45,6 +47,63 @@ void SLONET2LiveLinkSourceFactory::Construct(const FArguments& Args)
 				]
 			]
 			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ReplayFile", "Replay File"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(ReplayFileText, SEditableTextBox)
+					.HintText(LOCTEXT("ReplayFileHint", "Capture file (optional)"))
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ReplayRealTime", "Replay In Real Time"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(ReplayRealTimeCheckBox, SCheckBox)
+					.IsChecked(ECheckBoxState::Checked)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ReplayLoop", "Loop Replay"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(ReplayLoopCheckBox, SCheckBox)
+					.IsChecked(ECheckBoxState::Unchecked)
+				]
+			]
+			+ SVerticalBox::Slot()
 			.HAlign(HAlign_Right)
 			.AutoHeight()
 			[
@@ -64,9 +123,11 @@ void SLONET2LiveLinkSourceFactory::OnEndpointChanged(const FText& NewValue, ETex
 	TSharedPtr<SEditableTextBox> EditabledTextPin = EditabledText.Pin();
 	if (EditabledTextPin.IsValid())
 	{
-		FIPv4Endpoint Endpoint;
-		if (!FIPv4Endpoint::Parse(NewValue.ToString(), Endpoint))
+		TArray<FIPv4Endpoint> Endpoints;
+		FString SharedMemoryName;
+		if (!FLONET2LiveLinkSource::ParseEndpoints(NewValue.ToString(), Endpoints) && !FLONET2LiveLinkSource::ParseSharedMemoryName(NewValue.ToString(), SharedMemoryName))
 		{
+			FIPv4Endpoint Endpoint;
 			Endpoint.Address = FIPv4Address::Any;
 			Endpoint.Port = 60608;
 			EditabledTextPin->SetText(FText::FromString(Endpoint.ToString()));
@@ -76,13 +137,32 @@ void SLONET2LiveLinkSourceFactory::OnEndpointChanged(const FText& NewValue, ETex
 
 FReply SLONET2LiveLinkSourceFactory::OnOkClicked()
 {
+	FLONET2LiveLinkSourceOptions Options;
+
+	TSharedPtr<SEditableTextBox> ReplayFileTextPin = ReplayFileText.Pin();
+	if (ReplayFileTextPin.IsValid())
+	{
+		Options.ReplayFile = ReplayFileTextPin->GetText().ToString().TrimStartAndEnd().TrimQuotes();
+	}
+
+	if (!Options.ReplayFile.IsEmpty())
+	{
+		TSharedPtr<SCheckBox> RealTimePin = ReplayRealTimeCheckBox.Pin();
+		TSharedPtr<SCheckBox> LoopPin = ReplayLoopCheckBox.Pin();
+		Options.bReplayRealTime = !RealTimePin.IsValid() || RealTimePin->IsChecked();
+		Options.bReplayLoop = LoopPin.IsValid() && LoopPin->IsChecked();
+		OkClicked.ExecuteIfBound(TArray<FIPv4Endpoint>(), Options);
+		return FReply::Handled();
+	}
+
 	TSharedPtr<SEditableTextBox> EditabledTextPin = EditabledText.Pin();
 	if (EditabledTextPin.IsValid())
 	{
-		FIPv4Endpoint Endpoint;
-		if (FIPv4Endpoint::Parse(EditabledTextPin->GetText().ToString(), Endpoint))
+		TArray<FIPv4Endpoint> Endpoints;
+		if (FLONET2LiveLinkSource::ParseSharedMemoryName(EditabledTextPin->GetText().ToString(), Options.SharedMemoryName)
+			|| FLONET2LiveLinkSource::ParseEndpoints(EditabledTextPin->GetText().ToString(), Endpoints))
 		{
-			OkClicked.ExecuteIfBound(Endpoint);
+			OkClicked.ExecuteIfBound(MoveTemp(Endpoints), Options);
 		}
 	}
 	return FReply::Handled();
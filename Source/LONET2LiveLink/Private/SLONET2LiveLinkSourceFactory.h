@@ -7,13 +7,15 @@
 #include "Types/SlateEnums.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "LONET2LiveLinkSource.h"
 
+class SCheckBox;
 class SEditableTextBox;
 
 class SLONET2LiveLinkSourceFactory : public SCompoundWidget
 {
 public:
-	DECLARE_DELEGATE_OneParam(FOnOkClicked, FIPv4Endpoint);
+	DECLARE_DELEGATE_TwoParams(FOnOkClicked, TArray<FIPv4Endpoint>, const FLONET2LiveLinkSourceOptions&);
 
 	SLATE_BEGIN_ARGS(SLONET2LiveLinkSourceFactory){}
 		SLATE_EVENT(FOnOkClicked, OnOkClicked)
@@ -28,5 +30,10 @@ private:
 	FReply OnOkClicked();
 
 	TWeakPtr<SEditableTextBox> EditabledText;
+
+	/** Capture file to replay, the endpoint is ignored while it is set. */
+	TWeakPtr<SEditableTextBox> ReplayFileText;
+	TWeakPtr<SCheckBox> ReplayRealTimeCheckBox;
+	TWeakPtr<SCheckBox> ReplayLoopCheckBox;
 	FOnOkClicked OkClicked;
 };
\ No newline at end of file
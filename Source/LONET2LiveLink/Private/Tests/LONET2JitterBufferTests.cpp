@@ -0,0 +1,68 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "CoreMinimal.h"
+#include "LONET2JitterBuffer.h"
+#include "Misc/AutomationTest.h"
+#include "Roles/LiveLinkBasicTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace LONET2JitterBufferTests
+{
+	static FLiveLinkFrameDataStruct MakeFrame(const FTimecode& Timecode, double WorldTime)
+	{
+		FLiveLinkFrameDataStruct FrameData(FLiveLinkBaseFrameData::StaticStruct());
+		FLiveLinkBaseFrameData& BaseData = *FrameData.GetBaseData();
+		BaseData.MetaData.SceneTime = FQualifiedFrameTime(Timecode, FFrameRate(24, 1));
+		BaseData.WorldTime = FLiveLinkWorldTime(WorldTime, 0.0);
+		return FrameData;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLONET2JitterBufferTimecodeWrapTest, "LONET2LiveLink.JitterBuffer.TimecodeWrap",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLONET2JitterBufferTimecodeWrapTest::RunTest(const FString& Parameters)
+{
+	using namespace LONET2JitterBufferTests;
+
+	FLONET2JitterBuffer JitterBuffer(2, 0.0);
+	const FName Subject(TEXT("Camera"));
+
+	TArray<double> Released;
+	auto Push = [&Released](FName, FLiveLinkFrameDataStruct&& FrameData)
+	{
+		Released.Add(FrameData.GetBaseData()->MetaData.SceneTime.AsSeconds());
+	};
+
+	// The last frames before midnight, then the first ones after it
+	double WorldTime = 1000.0;
+	for (int32 Frame = 20; Frame < 24; ++Frame)
+	{
+		JitterBuffer.Insert(Subject, MakeFrame(FTimecode(23, 59, 59, Frame, false), WorldTime));
+		WorldTime += 1.0 / 24.0;
+	}
+	JitterBuffer.Release(WorldTime + 1.0, Push);
+	TestEqual(TEXT("Frames released before the wrap"), Released.Num(), 4);
+
+	for (int32 Frame = 1; Frame < 4; ++Frame)
+	{
+		JitterBuffer.Insert(Subject, MakeFrame(FTimecode(0, 0, 0, Frame, false), WorldTime));
+		WorldTime += 1.0 / 24.0;
+	}
+	JitterBuffer.Release(WorldTime + 1.0, Push);
+
+	TestEqual(TEXT("Frames released after the wrap"), Released.Num(), 7);
+	TestEqual(TEXT("Late frames"), JitterBuffer.GetLateCount(), uint64(0));
+	TestEqual(TEXT("Resyncs"), JitterBuffer.GetResyncCount(), uint64(1));
+	TestTrue(TEXT("Released in order after the wrap"), Released.Num() == 7 && Released[4] < Released[5] && Released[5] < Released[6]);
+
+	// A slightly late frame is still dropped rather than treated as a new timeline
+	JitterBuffer.Insert(Subject, MakeFrame(FTimecode(0, 0, 0, 2, false), WorldTime));
+	TestEqual(TEXT("Late frames after a small step back"), JitterBuffer.GetLateCount(), uint64(1));
+	TestEqual(TEXT("Resyncs after a small step back"), JitterBuffer.GetResyncCount(), uint64(1));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,173 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#include "CoreMinimal.h"
+#include "LONET2BenchmarkCases.h"
+#include "LONET2BenchmarkCommandlet.h"
+#include "LONET2StreamDecoder.h"
+#include "LONET2SubjectCache.h"
+#include "LONET2SyntheticTraffic.h"
+#include "LiveLinkLensTypes.h"
+#include "Misc/AutomationTest.h"
+#include "Roles/LiveLinkCameraTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace LONET2PipelineTests
+{
+	using namespace LONET2Benchmark;
+
+	/** Any free port, Direct cases never receive on the socket. */
+	static const FIPv4Endpoint Endpoint(FIPv4Address(127, 0, 0, 1), 0);
+
+	static constexpr float Tolerance = 1.0e-4f;
+
+	/** Checks the last frame pushed for every section of the case against what the synthetic traffic sent for Frame. */
+	static void TestLastFrames(FAutomationTestBase& Test, const FCase& Case, const FCountingSource& Source, int32 Frame)
+	{
+		const float Wobble = (Frame % 100) * 0.001f;
+		const FFrameRate Rate(24, 1);
+		const FFrameNumber ExpectedFrameNumber = LONET2SyntheticTraffic::MakeFTimecode(Frame).ToFrameNumber(Rate);
+
+		for (const TPair<ESectionMask, ELONET2Section>& MaskSection : MaskSections)
+		{
+			if ((Case.Sections & MaskSection.Key) == 0)
+			{
+				continue;
+			}
+
+			const ELONET2Section Section = MaskSection.Value;
+			const FName SubjectName(FString(SubjectFor(Section)) + FLONET2SubjectCache::GetSubjectSuffix(Section));
+			const FString What = FString::Printf(TEXT("%s %s"), *Case.Name, *SubjectName.ToString());
+
+			FLiveLinkFrameDataStruct FrameData;
+			if (!Source.GetLastFrame(SubjectName, FrameData))
+			{
+				Test.AddError(FString::Printf(TEXT("%s: no frame was pushed"), *What));
+				continue;
+			}
+
+			const FLiveLinkBaseFrameData& BaseData = *FrameData.GetBaseData();
+			Test.TestTrue(What + TEXT(" frame rate"), BaseData.MetaData.SceneTime.Rate == Rate);
+			Test.TestEqual(What + TEXT(" scene time"), BaseData.MetaData.SceneTime.Time.GetFrame().Value, ExpectedFrameNumber.Value);
+
+			switch (Section)
+			{
+			case ELONET2Section::Encoder:
+			{
+				const FLiveLinkCameraFrameData* Encoder = FrameData.Cast<FLiveLinkCameraFrameData>();
+				if (Test.TestNotNull(What + TEXT(" camera frame"), Encoder))
+				{
+					Test.TestEqual(What + TEXT(" focal length"), Encoder->FocalLength, 35.0f + Wobble, Tolerance);
+					Test.TestEqual(What + TEXT(" focus distance"), Encoder->FocusDistance, 3.2f + Wobble, Tolerance);
+				}
+				break;
+			}
+			case ELONET2Section::Lens:
+			{
+				const FLiveLinkLensFrameData* Lens = FrameData.Cast<FLiveLinkLensFrameData>();
+				if (Test.TestNotNull(What + TEXT(" lens frame"), Lens))
+				{
+					Test.TestEqual(What + TEXT(" focal length"), Lens->FocalLength, 35.0f + Wobble, Tolerance);
+				}
+				break;
+			}
+			case ELONET2Section::Camera:
+			{
+				const FLiveLinkCameraFrameData* Camera = FrameData.Cast<FLiveLinkCameraFrameData>();
+				if (Test.TestNotNull(What + TEXT(" camera frame"), Camera))
+				{
+					Test.TestEqual(What + TEXT(" location X"), Camera->Transform.GetLocation().X, double(12.5f + Wobble), double(Tolerance));
+				}
+				break;
+			}
+			case ELONET2Section::Controller:
+			default:
+			{
+				// The trigger is the controller's fourth property
+				if (Test.TestTrue(What + TEXT(" has the trigger property"), BaseData.PropertyValues.Num() > 3))
+				{
+					Test.TestEqual(What + TEXT(" trigger"), BaseData.PropertyValues[3], Wobble, Tolerance);
+				}
+				break;
+			}
+			}
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLONET2PipelineFramesTest, "LONET2LiveLink.Pipeline.Frames",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLONET2PipelineFramesTest::RunTest(const FString& Parameters)
+{
+	using namespace LONET2PipelineTests;
+
+	TArray<FCase> Cases;
+	AddSyntheticCases(Cases);
+
+	for (const FCase& Case : Cases)
+	{
+		// Decoding on the calling thread, every HandleReceivedData call decodes and pushes its packet before returning
+		FLONET2LiveLinkSourceOptions Options;
+		Options.DecodeThread = ELONET2DecodeThread::ReceiverThread;
+
+		TSharedRef<FCountingSource> Source = MakeShared<FCountingSource>(Endpoint, Options, true);
+		Source->ReceiveClient(nullptr, FGuid::NewGuid());
+
+		for (const FPacketData& Packet : Case.Packets)
+		{
+			Source->HandleReceivedData(Packet, Endpoint);
+		}
+
+		const int64 ExpectedFrames = int64(Case.Packets.Num()) * Case.SectionsPerPacket;
+		TestEqual(Case.Name + TEXT(" frames pushed or superseded"), Source->FramesPushed.GetValue() + int64(Source->GetSupersededFrameCount()), ExpectedFrames);
+		TestEqual(Case.Name + TEXT(" static data pushed once per subject"), Source->StaticDataPushed.GetValue(), int64(Case.SectionsPerPacket));
+
+		TestLastFrames(*this, Case, *Source, Case.Packets.Num() - 1);
+
+		Source->RequestSourceShutdown();
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLONET2PipelineThresholdsTest, "LONET2LiveLink.Pipeline.Thresholds",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FLONET2PipelineThresholdsTest::RunTest(const FString& Parameters)
+{
+	using namespace LONET2PipelineTests;
+
+	// The benchmark commandlet's configured thresholds, 0 disables a check
+	const ULONET2BenchmarkCommandlet* Thresholds = GetDefault<ULONET2BenchmarkCommandlet>();
+	const int32 NumPackets = 20000;
+	const int32 NumWarmup = 2000;
+
+	TArray<FCase> Cases;
+	AddSyntheticCases(Cases);
+
+	for (const FCase& Case : Cases)
+	{
+		const FCaseResult Result = RunDirect(Case, FLONET2LiveLinkSourceOptions(), Endpoint, NumPackets, NumWarmup);
+
+		AddInfo(FString::Printf(TEXT("%s: %.0f packets/s, p50 %.2f us, p99 %.2f us, %.2f allocations/packet"), *Result.Name,
+			Result.PacketsPerSecond, Result.P50Microseconds, Result.P99Microseconds, Result.AllocationsPerPacket));
+
+		if (Thresholds->MinPacketsPerSecond > 0.0f && Result.PacketsPerSecond < Thresholds->MinPacketsPerSecond)
+		{
+			AddError(FString::Printf(TEXT("%s: %.0f packets/s is below the minimum of %.0f"), *Result.Name, Result.PacketsPerSecond, Thresholds->MinPacketsPerSecond));
+		}
+		if (Thresholds->MaxP99Microseconds > 0.0f && Result.P99Microseconds > Thresholds->MaxP99Microseconds)
+		{
+			AddError(FString::Printf(TEXT("%s: p99 of %.2f us is above the maximum of %.2f us"), *Result.Name, Result.P99Microseconds, Thresholds->MaxP99Microseconds));
+		}
+		if (Thresholds->MaxAllocationsPerPacket > 0.0f && Result.AllocationsPerPacket > Thresholds->MaxAllocationsPerPacket)
+		{
+			AddError(FString::Printf(TEXT("%s: %.2f allocations per packet is above the maximum of %.2f"), *Result.Name, Result.AllocationsPerPacket, Thresholds->MaxAllocationsPerPacket));
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,148 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Timecode.h"
+
+/**
+ * Compact binary encoding of the LONET 2 sections, sent on the same port as JSON.
+ * Receivers tell the two apart by the first byte: JSON starts with '{' (or whitespace), binary packets with LONET2_BINARY_MAGIC.
+ *
+ * All values are little endian.
+ *
+ * Packet header (4 bytes)
+ *   uint8   Magic          LONET2_BINARY_MAGIC
+ *   uint8   Version        LONET2_BINARY_VERSION
+ *   uint8   SectionCount
+ *   uint8   Reserved       0
+ *
+ * Section header (4 bytes), followed by BodySize bytes
+ *   uint8   SectionType    ELONET2BinarySection
+ *   uint8   Flags          ELONET2BinarySectionFlags
+ *   uint16  BodySize
+ *
+ * Section body, common part
+ *   Name    uint32 subject id when NameIsId is set (the subject is named after its decimal value),
+ *           otherwise uint8 length followed by that many UTF-8 bytes
+ *   float   FrameRate
+ *   uint8   Hours, Minutes, Seconds, Frames
+ *
+ * Section body, per type (all float)
+ *   Encoder     FocalLength, Iris, Focus
+ *   Distortion  FocalLength, Iris, Focus, Fx, Fy, PrincipalPointX, PrincipalPointY, then uint8 count and count distortion parameters
+ *   Camera      Position[3], Orientation[4] (x, y, z, w), FocalLength, Iris, Focus, WhiteBalance, Tint, ISO, Shutter, SensorSize[2]
+ *   Controller  Button1, Button2, Button3, Trigger, TouchpadPressed, TouchpadX, TouchpadY
+ *
+ * Fields appended to a body by a later version are skipped by older receivers using BodySize, unknown section types are skipped entirely.
+ * A portable C encoder for non Unreal senders ships in Extras/LONET2Binary.
+ */
+
+#define LONET2_BINARY_MAGIC 0xB2
+#define LONET2_BINARY_VERSION 1
+
+enum class ELONET2BinarySection : uint8
+{
+	Encoder = 0,
+	Distortion = 1,
+	Camera = 2,
+	Controller = 3,
+};
+
+enum class ELONET2BinarySectionFlags : uint8
+{
+	None = 0,
+	NameIsId = 1 << 0,
+	HasTimecode = 1 << 1,
+};
+ENUM_CLASS_FLAGS(ELONET2BinarySectionFlags);
+
+/** Subject and timing shared by every section. */
+struct FLONET2BinarySectionHeader
+{
+	/** Camera or controller name, ignored when bUseSubjectId is set. */
+	FString SubjectName;
+
+	uint32 SubjectId = 0;
+	bool bUseSubjectId = false;
+
+	float FrameRate = 24.0f;
+
+	FTimecode Timecode;
+	bool bHasTimecode = true;
+};
+
+struct FLONET2BinaryEncoderData
+{
+	float FocalLength = 0.0f;
+	float Iris = 0.0f;
+	float Focus = 0.0f;
+};
+
+struct FLONET2BinaryDistortionData
+{
+	float FocalLength = 0.0f;
+	float Iris = 0.0f;
+	float Focus = 0.0f;
+	float FxFy[2] = { 0.0f, 0.0f };
+	float PrincipalPoint[2] = { 0.0f, 0.0f };
+	TArray<float> DistortionParameters;
+};
+
+struct FLONET2BinaryCameraData
+{
+	float Position[3] = { 0.0f, 0.0f, 0.0f };
+	float Orientation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float FocalLength = 0.0f;
+	float Iris = 0.0f;
+	float Focus = 0.0f;
+	float WhiteBalance = 0.0f;
+	float Tint = 0.0f;
+	float ISO = 0.0f;
+	float Shutter = 0.0f;
+	float SensorSize[2] = { 0.0f, 0.0f };
+};
+
+struct FLONET2BinaryControllerData
+{
+	float Button1 = 0.0f;
+	float Button2 = 0.0f;
+	float Button3 = 0.0f;
+	float Trigger = 0.0f;
+	float TouchpadPressed = 0.0f;
+	float TouchpadX = 0.0f;
+	float TouchpadY = 0.0f;
+};
+
+/**
+ * Builds binary LONET 2 datagrams for senders.
+ * Reset() starts a packet in the caller's buffer, each Add call appends one section.
+ */
+class LONET2LIVELINK_API FLONET2BinaryWriter
+{
+public:
+
+	explicit FLONET2BinaryWriter(TArray<uint8>& InBuffer);
+
+	/** Clears the buffer and writes a new packet header. */
+	void Reset();
+
+	void AddEncoder(const FLONET2BinarySectionHeader& Header, const FLONET2BinaryEncoderData& Data);
+	void AddDistortion(const FLONET2BinarySectionHeader& Header, const FLONET2BinaryDistortionData& Data);
+	void AddCamera(const FLONET2BinarySectionHeader& Header, const FLONET2BinaryCameraData& Data);
+	void AddController(const FLONET2BinarySectionHeader& Header, const FLONET2BinaryControllerData& Data);
+
+	int32 GetSectionCount() const;
+
+private:
+
+	int32 BeginSection(ELONET2BinarySection Section, const FLONET2BinarySectionHeader& Header);
+	void EndSection(int32 SectionStart);
+
+	void WriteUInt8(uint8 Value);
+	void WriteUInt16(uint16 Value);
+	void WriteUInt32(uint32 Value);
+	void WriteFloat(float Value);
+
+	TArray<uint8>& Buffer;
+};
@@ -3,25 +3,134 @@
 #pragma once
 
 #include "ILiveLinkSource.h"
+#include "HAL/CriticalSection.h"
 #include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
 #include "IMessageContext.h"
 #include "Interfaces/IPv4/IPv4Endpoint.h"
 #include "LoledUtilities.h"
 #include "Delegates/IDelegateInstance.h"
-#include "Common/UdpSocketReceiver.h"
+#include "Serialization/ArrayReader.h"
+#include "LiveLinkTypes.h"
+#include "Templates/SubclassOf.h"
+#include "LONET2LiveLinkSourceSettings.h"
 
 //enable logging step 1
 DECLARE_LOG_CATEGORY_EXTERN(ModuleLog, Log, All)
 
-class FSocket;
+class FLONET2Socket;
+class FLONET2UdpReceiver;
+class FLONET2SharedMemoryRing;
+class FLONET2SharedMemoryReceiver;
+class FLONET2PacketPool;
+struct FLONET2Packet;
 class ILiveLinkClient;
 class ISocketSubsystem;
+class FLONET2StreamDecoder;
+class FLONET2DecodeWorker;
+class FLONET2PacketQueue;
+class FLONET2SubjectMailbox;
+class FLONET2SubjectCache;
+class FLONET2CaptureWriter;
+class FLONET2CaptureReader;
+class FLONET2ReplayPlayer;
+class FLONET2ClockEstimator;
+class FLONET2JitterBuffer;
+class FLONET2SourceStats;
+class FLONET2LensTableCache;
+class FLONET2DeltaState;
+class FLONET2PosePredictor;
+class FLONET2SenderFilter;
+struct FLiveLinkCameraFrameData;
+enum class ELONET2Section : uint8;
+class ULiveLinkRole;
+
+struct FLONET2LiveLinkSourceOptions
+{
+	ELONET2DecodeThread DecodeThread = ELONET2DecodeThread::ReceiverThread;
+
+	/** Datagrams waiting for the game or decode thread, the oldest are dropped beyond this. */
+	int32 MaxPendingPackets = 256;
+
+	/** Datagrams read per receive call, recvmmsg on Linux. */
+	int32 ReceiveBatchSize = 32;
+
+	/** Size of each pooled packet buffer, larger datagrams are dropped. */
+	int32 MaxDatagramSize = 65507;
+
+	/** Kernel receive buffer of each socket. */
+	int32 ReceiveBufferSize = 1024 * 1024;
+
+	/** Longest the receiver thread blocks without data, shutdown wakes it at once. */
+	float ReceiverWaitMilliseconds = 100.0f;
+
+	/** Only these senders are decoded when not empty, multicast groups are joined for them only where the OS supports it. */
+	TArray<FIPv4Address> AllowedSenders;
+
+	/** Senders dropped before decoding. */
+	TArray<FIPv4Address> DeniedSenders;
+
+	/** Prefixes subject names with the sender's address. */
+	bool bSubjectsPerSender = false;
+
+	/** Priority and CPU affinity of the receive, decode and replay threads, an affinity mask of 0 means any core. */
+	EThreadPriority ThreadPriority = TPri_AboveNormal;
+	uint64 ThreadAffinityMask = 0;
+
+	/** Frames kept per subject between decode and push, 1 means only the newest frame is pushed. */
+	int32 FramesPerSubject = 1;
+
+	/** Subjects that need more (or fewer) frames than FramesPerSubject, for example to keep every controller sample. */
+	TMap<FName, int32> FramesPerSubjectOverrides;
+
+	/** Subjects idle for this many seconds are removed, 0 keeps them until shutdown. */
+	float SubjectIdleTimeout = 0.0f;
+
+	/** Look-ahead of camera pose prediction, 0 disables it. */
+	float PredictionMilliseconds = 0.0f;
+
+	/** Camera subjects with their own look-ahead. */
+	TMap<FName, float> PredictionMillisecondsOverrides;
+
+	/** Capture file to play back instead of opening a socket. */
+	FString ReplayFile;
+
+	/** Shared memory ring written by senders on this host (FLONET2SharedMemoryWriter) to read instead of opening a socket, Linux only. */
+	FString SharedMemoryName;
+
+	/** Replay at the recorded arrival times, otherwise as fast as the decode stage takes packets. */
+	bool bReplayRealTime = true;
+
+	/** Start over at the end of the replay file. */
+	bool bReplayLoop = false;
+
+	/** Records every datagram received from the start, StartCapture() does the same at any time. */
+	FString CaptureFile;
+
+	/**
+	 * Stamps WorldTime from the frame's timecode mapped onto the local clock by a running estimate of each sender's clock offset and drift.
+	 * Otherwise, and for frames without a timecode, WorldTime is the datagram's arrival time.
+	 */
+	bool bEstimateSenderClock = true;
+
+	/**
+	 * Holds timecoded frames back by this many frames at their own rate, then releases them in timecode order.
+	 * Reordered and bunched packets come out evenly spaced at a known latency cost. 0 uses JitterBufferMilliseconds.
+	 */
+	int32 JitterBufferFrames = 0;
+
+	/** Jitter buffer delay when JitterBufferFrames is 0, 0 for both disables the jitter buffer. */
+	float JitterBufferMilliseconds = 0.0f;
+};
 
 class LONET2LIVELINK_API FLONET2LiveLinkSource : public ILiveLinkSource
 {
 public:
 
-	FLONET2LiveLinkSource(FIPv4Endpoint Endpoint);
+	FLONET2LiveLinkSource(FIPv4Endpoint Endpoint, const FLONET2LiveLinkSourceOptions& InOptions = FLONET2LiveLinkSourceOptions());
+
+	/** Receives every endpoint on one thread. Multicast groups sharing a port share one socket. */
+	FLONET2LiveLinkSource(TArray<FIPv4Endpoint> Endpoints, const FLONET2LiveLinkSourceOptions& InOptions = FLONET2LiveLinkSourceOptions());
 
 	virtual ~FLONET2LiveLinkSource();
 
@@ -39,15 +148,69 @@ public:
 	virtual FText GetSourceMachineName() const override { return SourceMachineName; }
 	virtual FText GetSourceStatus() const override { return SourceStatus; }
 	virtual void InitializeSettings(ULiveLinkSourceSettings* Settings) override;
+	virtual TSubclassOf<ULiveLinkSourceSettings> GetSettingsClass() const override { return ULONET2LiveLinkSourceSettings::StaticClass(); }
 	virtual void Update() override;
 
 	// End ILiveLinkSource Interface
 
+	/** Parses a comma or semicolon separated list such as "236.12.12.12:60608, 236.12.12.13:60608". False if any entry is invalid. */
+	static bool ParseEndpoints(const FString& String, TArray<FIPv4Endpoint>& OutEndpoints);
+
+	static FString EndpointsToString(TConstArrayView<FIPv4Endpoint> Endpoints);
+
+	/** Parses a shared memory connection string such as "shm://tracker". False for anything else, or an invalid ring name. */
+	static bool ParseSharedMemoryName(const FString& String, FString& OutName);
+
+	/**
+	 * Moves the source to other endpoints: the sockets are closed and opened on the new endpoints with the threads restarted,
+	 * while subjects, their caches and the LiveLink registration stay. False if no new socket could be opened, or when replaying
+	 * or reading shared memory.
+	 */
+	bool SetEndpoints(TArray<FIPv4Endpoint> Endpoints);
+
 	void HandleReceivedData(const TSharedPtr<FArrayReader, ESPMode::ThreadSafe>& Data, const FIPv4Endpoint& Sender);
 
+	/** Frames replaced in the mailbox by a newer frame before they were pushed. */
+	uint64 GetSupersededFrameCount() const;
+
+	/** Datagrams dropped because the decode stage fell behind, or lost in the shared memory ring. */
+	uint64 GetDroppedPacketCount() const;
+
+	/** Frames the jitter buffer put back into timecode order. */
+	uint64 GetReorderedFrameCount() const;
+
+	/** Frames the jitter buffer dropped because they arrived after a later frame was released, or twice. */
+	uint64 GetLateFrameCount() const;
+
+	/** Keyframe and delta sections dropped as reordered, or because their subject lost a section and waits for a keyframe. */
+	uint64 GetDroppedDeltaCount() const;
+
+	/** Datagrams dropped because their sender is not allowed. */
+	uint64 GetRejectedSenderCount() const;
+
+	/** Starts recording raw datagrams with their arrival times and senders, replacing any capture in progress. */
+	bool StartCapture(const FString& Filename);
+
+	void StopCapture();
+
+	bool IsCapturing() const { return bCapturing; }
+
 	FTimecode TimeCode;
 	FFrameRate FrameRate;
 
+protected:
+
+	/** LiveLink client calls. The benchmark commandlet overrides these to measure the pipeline without a LiveLink client. */
+	virtual bool HasClient() const { return Client != nullptr; }
+
+	virtual void PushSubjectStaticData(const FLiveLinkSubjectKey& SubjectKey, TSubclassOf<ULiveLinkRole> Role, FLiveLinkStaticDataStruct&& StaticData);
+
+	virtual void PushSubjectFrameData(const FLiveLinkSubjectKey& SubjectKey, FLiveLinkFrameDataStruct&& FrameData);
+
+	virtual void RemoveSubject(const FLiveLinkSubjectKey& SubjectKey);
+
+	virtual bool IsSubjectEnabled(const FLiveLinkSubjectKey& SubjectKey) const;
+
 private:
 
 
@@ -56,10 +219,91 @@ private:
 
 	bool OpenSocket();
 
+	bool OpenReplay();
+
+	bool OpenSharedMemory();
+
+	/** False when replaying or reading shared memory, the endpoint settings do not apply then. */
+	bool UsesSockets() const;
+
+	/** Starts the receiver (socket or shared memory, or replay player) and decode threads for the current options. */
+	void StartThreads();
+
+	/** Joins every thread, the sockets and shared memory ring stay open. */
+	void StopThreads();
+
+	/** Applies the settings to the running source, restarting the threads only when the decode thread changes. */
+	void ApplySettings(const ULONET2LiveLinkSourceSettings& Settings);
 
 	void CloseSockets();
 
-	void ProcessJsonData(const TArray<uint8>& RawData);
+	/** Removes every subject from LiveLink and every per subject cache. The threads must be stopped. */
+	void RemoveAllSubjects();
+
+	/** Switches between plain and sender prefixed subject names, removing every subject. */
+	void SetSubjectsPerSender(bool bSubjectsPerSender);
+
+	/** Waits for HandleReceivedData calls from outside threads that started before the shutdown flag was set. */
+	void WaitForActiveHandlers();
+
+	/** Receiver thread entry point, takes ownership of the pooled packets. */
+	void HandlePacketBatch(TArrayView<FLONET2Packet*> Packets);
+
+	/** Decodes one datagram, binary or JSON, into the mailbox. */
+	void ProcessPacket(const FLONET2Packet& Packet);
+
+	/** Returns false for packets that could not be decoded. */
+	bool ProcessJsonData(const TArray<uint8>& RawData);
+
+	void QueueDecodedSections();
+
+	/** Queues a lens frame evaluated from the camera's calibration table at the encoder values, if a table was received. */
+	void QueueEvaluatedLens(FAnsiStringView RawCameraName, const FLiveLinkCameraFrameData& EncoderFrame, bool bHasSceneTime, bool bMalformedTimecode);
+
+	/** Decodes every queued datagram, then pushes what is left in the mailbox. */
+	void DrainPendingPackets();
+
+	void FlushMailbox();
+
+	/** Pushes every jitter buffered frame that is due. */
+	void ReleaseJitterBuffer();
+
+	/** Creates, resizes or drops the jitter buffer for the options, a dropped buffer hands what it holds to the mailbox. Game thread. */
+	void ApplyJitterBufferOptions();
+
+	/** Removes subjects idle for longer than the timeout from LiveLink and every per subject cache. Game thread. */
+	void RemoveIdleSubjects();
+
+	/** Frees the decoding thread's state of subjects RemoveIdleSubjects removed, and the clocks of senders idle as long. */
+	void ForgetIdleSubjects();
+
+	/** Picks up subjects enabled or disabled in LiveLink, a few times a second. Game thread. */
+	void RefreshEnabledSubjects();
+
+	/** False for sections of subjects disabled in LiveLink, the decoders skip those. */
+	bool IsSectionEnabled(ELONET2Section Section, FAnsiStringView RawName);
+
+	/** Appends the latest rates to the connection status, once a second. */
+	void UpdateSourceStatus();
+
+	/** Replaces a camera pose with its prediction when the subject has a look-ahead. Frames without scene time are sampled at arrival. */
+	void PredictPose(FName SubjectName, FLiveLinkCameraFrameData& FrameData, bool bHasSceneTime);
+
+	/** Sets the look-ahead of every subject from the options. */
+	void ApplyPredictionOptions();
+
+	/** bHasSceneTime when the frame's timecode parsed, the frame's scene time alone cannot tell as 00:00:00:00 is valid. */
+	void QueueFrame(FName SubjectName, FLiveLinkFrameDataStruct&& FrameData, bool bHasSceneTime, bool bMalformedTimecode);
+
+	void StampWorldTime(FLiveLinkBaseFrameData& FrameData, bool bHasSceneTime);
+
+	/** FJsonObject based decode, used for packets the stream decoder hands back. */
+	bool ProcessJsonDataDom(const TArray<uint8>& RawData);
+
+	/** Looks the section's subject up in the subject cache, pushing its static data the first time it is seen. */
+	FName ResolveSubject(ELONET2Section Section, FAnsiStringView RawName);
+
+	void PushStaticData(ELONET2Section Section, FName SubjectName);
 
 	ILiveLinkClient* Client = nullptr;
 
@@ -69,14 +313,101 @@ private:
 	FText SourceMachineName;
 	FText SourceStatus;
 
-	FIPv4Endpoint DeviceEndpoint;
+	/** Connection state shown ahead of the rates in SourceStatus. */
+	FText ConnectionStatus;
+
+	TArray<FIPv4Endpoint> DeviceEndpoints;
+
+	FLONET2LiveLinkSourceOptions Options;
+
+	TUniquePtr<FLONET2PacketPool> PacketPool;
+
+	TArray<TUniquePtr<FLONET2Socket>> Sockets;
+
+	TUniquePtr<FLONET2UdpReceiver> UdpReceiver;
 
-	FSocket* Socket = nullptr;
+	TUniquePtr<FLONET2SharedMemoryRing> SharedMemoryRing;
 
-	TUniquePtr<FUdpSocketReceiver> UdpReceiver;
+	TUniquePtr<FLONET2SharedMemoryReceiver> SharedMemoryReceiver;
+
+	TUniquePtr<FLONET2CaptureReader> ReplayReader;
+
+	TUniquePtr<FLONET2ReplayPlayer> ReplayPlayer;
+
+	TUniquePtr<FLONET2DecodeWorker> DecodeWorker;
 
 	FThreadSafeBool bShutdownRequested;
 
+	/** HandlePacketBatch calls in progress, on any thread. */
+	FThreadSafeCounter ActiveHandlers;
+
+	/**
+	 * Held while a thread decodes, around ProcessPacket and the flush that follows. HandleReceivedData decodes on its caller's thread
+	 * in ReceiverThread mode, alongside the receiver thread, and the decoding state below is not thread safe. Uncontended otherwise.
+	 */
+	FCriticalSection DecodeLock;
+
+	TUniquePtr<FLONET2StreamDecoder> StreamDecoder;
+
+	/** Used by whichever thread decodes, like StreamDecoder. */
+	FLONET2TimecodeParser TimecodeParser;
+
+	struct FSenderClock
+	{
+		TUniquePtr<FLONET2ClockEstimator> Estimator;
+
+		/** Arrival time of the sender's latest datagram. */
+		double LastSeen = 0.0;
+	};
+
+	/**
+	 * Clock estimate per sender address, used by the decoding thread only. Keyed without the port, so a restarted tracker sending
+	 * from a new ephemeral port reuses its estimate, which resyncs on the timecode jump. Senders idle for SubjectIdleTimeout are forgotten.
+	 */
+	TMap<FIPv4Address, FSenderClock> SenderClocks;
+
+	/** Arrival time and sender clock of the datagram being decoded. */
+	double PacketReceiveTime = 0.0;
+	FLONET2ClockEstimator* PacketSenderClock = nullptr;
+
+	/** Sender the datagram's subjects are namespaced by, FIPv4Address::Any unless bSubjectsPerSender. */
+	FIPv4Address PacketSubjectSender;
+
+	TUniquePtr<FLONET2PacketQueue> PendingPackets;
+
+	TUniquePtr<FLONET2SubjectMailbox> Mailbox;
+
+	TUniquePtr<FLONET2SourceStats> Stats;
+
+	/** Replaces the mailbox for timecoded frames when a jitter buffer delay is set. */
+	TUniquePtr<FLONET2JitterBuffer> JitterBuffer;
+
+	TUniquePtr<FLONET2SubjectCache> SubjectCache;
+
+	/** Lens calibration tables sent by the device, used by the decoding thread only. */
+	TUniquePtr<FLONET2LensTableCache> LensTables;
+
+	/** Last frame of every subject sent in keyframe and delta mode, used by the decoding thread only. */
+	TUniquePtr<FLONET2DeltaState> DeltaState;
+
+	TUniquePtr<FLONET2PosePredictor> PosePredictor;
+
+	/** Checked by the receive thread before anything else touches a datagram. */
+	TUniquePtr<FLONET2SenderFilter> SenderFilter;
+
+	double LastIdleCheckTime = 0.0;
+
+	double LastEnabledCheckTime = 0.0;
+
+	/** Subjects removed as idle whose decoding thread state is still to be freed. */
+	FCriticalSection IdleSubjectsLock;
+	TArray<FName> IdleSubjects;
+	FThreadSafeBool bHasIdleSubjects;
+
+	FCriticalSection CaptureLock;
+
+	TUniquePtr<FLONET2CaptureWriter> CaptureWriter;
 
-	TSet<FName> EncounteredSubjects;
+	/** Lets the receive path skip CaptureLock while nothing is recorded. */
+	FThreadSafeBool bCapturing;
 };
\ No newline at end of file
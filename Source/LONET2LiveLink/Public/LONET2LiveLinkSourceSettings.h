@@ -0,0 +1,129 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "LiveLinkSourceSettings.h"
+#include "LONET2LiveLinkSourceSettings.generated.h"
+
+/** Thread that decodes LONET 2 datagrams and pushes them to LiveLink. */
+UENUM()
+enum class ELONET2DecodeThread : uint8
+{
+	/** Queue every datagram to the game thread. */
+	GameThread,
+	/** Decode and push on the UDP receiver thread, the lowest latency option. */
+	ReceiverThread,
+	/** Hand datagrams to a dedicated decode thread so the receiver keeps draining the socket. */
+	DecodeThread,
+};
+
+/** Priority of the receive, decode and replay threads. */
+UENUM()
+enum class ELONET2ThreadPriority : uint8
+{
+	Normal,
+	AboveNormal,
+	Highest,
+	TimeCritical,
+};
+
+/**
+ * Receive and threading settings of a LONET 2 source, saved with LiveLink presets.
+ * Changes apply to the running source without removing its subjects. Only a decode thread change restarts the threads, the sockets stay open.
+ */
+UCLASS()
+class LONET2LIVELINK_API ULONET2LiveLinkSourceSettings : public ULiveLinkSourceSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Endpoints received, as in the connection string ("236.12.12.12:60608, 127.0.0.1:60609").
+	 * Changing them reopens the sockets on the new endpoints in place, the subjects and their state stay. Not used when replaying a capture.
+	 */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Receive")
+	FString Endpoints;
+
+	/** Kernel receive buffer (SO_RCVBUF) of each socket, resized in place. Bursts larger than this are lost before the receiver thread sees them. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Receive", meta = (ClampMin = "65536", Units = "Bytes"))
+	int32 ReceiveBufferSize = 1024 * 1024;
+
+	/** Longest the receiver thread blocks waiting for data before it wakes to apply setting changes. Data and shutdown wake it immediately. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Receive", meta = (ClampMin = "1", Units = "Milliseconds"))
+	float ReceiverWaitMilliseconds = 100.0f;
+
+	/**
+	 * Only datagrams from these sender addresses are decoded ("10.0.0.21, 10.0.0.22"), empty allows every sender.
+	 * On Linux multicast groups are then joined for these senders only (source specific multicast), so other traffic on the group never reaches the socket.
+	 * Not used for shared memory (shm://) sources, they have no network senders.
+	 */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Senders")
+	FString AllowedSenders;
+
+	/** Datagrams from these sender addresses are dropped before they are decoded. Not used for shared memory (shm://) sources. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Senders")
+	FString DeniedSenders;
+
+	/**
+	 * Prefixes every subject name with its sender's address ("10.0.0.21/Camera1"), so devices sending the same subject names stay apart.
+	 * Changing this removes every subject, they come back under their new names with their next packet. Shared memory (shm://) subjects keep their plain names.
+	 */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Senders")
+	bool bSubjectsPerSender = false;
+
+	/**
+	 * Records every datagram received to this file (.ln2cap) while set, with arrival times and senders, for replaying a glitch later
+	 * with ReplayFile="...". Setting it starts a new recording, replacing the file, and clearing it stops the recording.
+	 */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Capture", meta = (FilePathFilter = "ln2cap"))
+	FString CaptureFile;
+
+	/** Changing this restarts the receive and decode threads, and a replay from its start. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Threading")
+	ELONET2DecodeThread DecodeThread = ELONET2DecodeThread::ReceiverThread;
+
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Threading")
+	ELONET2ThreadPriority ThreadPriority = ELONET2ThreadPriority::AboveNormal;
+
+	/** CPU cores the receive, decode and replay threads may run on, one bit per core. 0 lets them run on any core. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Threading")
+	int64 ThreadAffinityMask = 0;
+
+	/** Frames kept per subject between decode and push, 1 means only the newest frame is pushed. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Subjects", meta = (ClampMin = "1"))
+	int32 FramesPerSubject = 1;
+
+	/** Subjects that need more (or fewer) frames than FramesPerSubject, for example to keep every controller sample. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Subjects")
+	TMap<FName, int32> FramesPerSubjectOverrides;
+
+	/**
+	 * Holds timecoded frames back by this many frames at their own rate and releases them in timecode order,
+	 * so reordered and bunched packets come out evenly spaced at a known latency cost. 0 uses JitterBufferMilliseconds.
+	 */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Jitter Buffer", meta = (ClampMin = "0"))
+	int32 JitterBufferFrames = 0;
+
+	/** Jitter buffer delay when JitterBufferFrames is 0. 0 for both turns the jitter buffer off, pushing the frames it holds right away. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Jitter Buffer", meta = (ClampMin = "0", Units = "Milliseconds"))
+	float JitterBufferMilliseconds = 0.0f;
+
+	/**
+	 * Subjects that send nothing for this long are removed from LiveLink and forgotten, so unplugged controllers and renamed cameras
+	 * do not pile up over a long session. They come back with their static data on their next packet. 0 keeps every subject until the source is removed.
+	 */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Subjects", meta = (ClampMin = "0", Units = "Seconds"))
+	float SubjectIdleTimeout = 0.0f;
+
+	/**
+	 * Pushes camera_transform_data poses extrapolated this far ahead along their recent velocity, to make up for the tracking latency.
+	 * 0 pushes poses as received. The mean error against the real poses shows in the source status and the LONET2 CSV category.
+	 */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Prediction", meta = (ClampMin = "0", Units = "Milliseconds"))
+	float PredictionMilliseconds = 0.0f;
+
+	/** Camera subjects that need a different look-ahead than PredictionMilliseconds, 0 turns prediction off for the subject. */
+	UPROPERTY(EditAnywhere, Category = "LONET 2|Prediction")
+	TMap<FName, float> PredictionMillisecondsOverrides;
+};
@@ -0,0 +1,36 @@
+///COPYRIGHT 2021 (C) LOLED VIRTUAL LLC
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FLONET2SharedMemoryRing;
+
+/**
+ * Sends LONET 2 datagrams (JSON or binary) to sources on the same host through a shared memory ring, Linux only.
+ * A source listens on it with the connection string shm://Name. Either side can start first, the ring outlives both.
+ * A portable C writer for non Unreal senders ships in Extras/LONET2SharedMemory.
+ */
+class LONET2LIVELINK_API FLONET2SharedMemoryWriter
+{
+public:
+
+	/** Opens or creates the ring, nullptr on failure or when another writer holds it. An existing ring keeps its capacity. */
+	static TUniquePtr<FLONET2SharedMemoryWriter> Create(const FString& Name, int32 Capacity = 4 * 1024 * 1024);
+
+	~FLONET2SharedMemoryWriter();
+
+	/** Appends one datagram and wakes the readers, never blocks. Readers too far behind lose the oldest datagrams. */
+	bool Write(const uint8* Data, int32 Num);
+
+	bool Write(TConstArrayView<uint8> Datagram) { return Write(Datagram.GetData(), Datagram.Num()); }
+
+	/** Largest datagram Write accepts. */
+	int32 GetMaxDatagramSize() const;
+
+private:
+
+	explicit FLONET2SharedMemoryWriter(TUniquePtr<FLONET2SharedMemoryRing> InRing);
+
+	TUniquePtr<FLONET2SharedMemoryRing> Ring;
+};
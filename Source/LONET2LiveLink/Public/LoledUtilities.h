@@ -9,9 +9,9 @@
 #include "Containers/UnrealString.h"
 
 /**
- * 
+ *
  */
-class LoledUtilities
+class LONET2LIVELINK_API LoledUtilities
 {
 public:
 	LoledUtilities();
@@ -19,4 +19,56 @@ public:
 
 	static FQualifiedFrameTime timeFromTimecodeString(FString timecode, float frameRate);
 
+	/** As above, returns false if the timecode is malformed. outTime is then frame zero at the rate. */
+	static bool timeFromTimecodeString(FString timecode, float frameRate, FQualifiedFrameTime& outTime);
+
+	static FQualifiedFrameTime timeFromTimecode(FTimecode timecode, float frameRate);
+
+	/** Parses "HH:MM:SS:FF" (';' or '.' also accepted as separators) without allocating. Returns false if malformed. */
+	static bool parseTimecode(FAnsiStringView timecode, FTimecode& outTimecode);
+
+	/** Exact rate for a nominal LONET frame rate, e.g. 23.976 is 24000/1001 and 29.97 and 59.94 are drop frame. */
+	static FFrameRate frameRateFromNumber(double frameRate, bool& outDropFrame);
+
+	/** Logs a malformed timecode at most every few seconds, with the number of packets suppressed in between. */
+	static void logMalformedTimecode(FAnsiStringView timecode);
+};
+
+/**
+ * Timecode parser for one decode thread.
+ * Remembers the last few timecodes it returned and the text of the frame that follows each of them,
+ * so same-frame and next-frame timecodes, the common case at a steady rate, are matched with one compare instead of parsed.
+ */
+class LONET2LIVELINK_API FLONET2TimecodeParser
+{
+public:
+
+	/** Returns false if the timecode is malformed, OutTime is then frame zero at the rate. 00:00:00:00 is a valid time. */
+	bool Parse(FAnsiStringView Timecode, double FrameRate, FQualifiedFrameTime& OutTime);
+
+private:
+
+	static constexpr int32 MaxTimecodeLength = 15;
+	static constexpr int32 NumRecent = 4;
+
+	struct FRecentTimecode
+	{
+		double FrameRate = 0.0;
+		FFrameRate Rate;
+		bool bDropFrame = false;
+
+		ANSICHAR Text[MaxTimecodeLength + 1];
+		int32 TextLength = 0;
+		FTimecode Timecode;
+
+		ANSICHAR NextText[MaxTimecodeLength + 1];
+		int32 NextTextLength = 0;
+		FTimecode NextTimecode;
+	};
+
+	void Remember(FRecentTimecode& Recent, FAnsiStringView Text, const FTimecode& Timecode, double FrameRate, const FFrameRate& Rate, bool bDropFrame);
+
+	FRecentTimecode Recent[NumRecent];
+
+	int32 NextSlot = 0;
 };